@@ -0,0 +1,136 @@
+/*
+
+   ArenaConversionPolicy.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>       // std::unique_ptr
+#include <type_traits>
+
+#include "unimock/StringView.hh"
+#include "unimock/ArrayView.hh"
+#include "Internal/Arena.hh"
+
+
+namespace unimock
+{
+
+/// Trait selecting the view type an argument type is stored as.
+///
+/// The ArenaConversionPolicy stores strings as StringView, and vectors and
+/// arrays of trivially copyable elements as ArrayView. For all other types the
+/// view type is void and they are stored as copies.
+///
+template<typename T>
+struct ArenaView
+{
+   using type = void;
+};
+
+template<class Traits, class Allocator>
+struct ArenaView<std::basic_string<char, Traits, Allocator>>
+{
+   using type = StringView;
+};
+
+template<typename T, class Allocator>
+struct ArenaView<std::vector<T, Allocator>>
+{
+   using type = std::conditional_t<
+      std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value,
+      ArrayView<T>,
+      void>;
+};
+
+template<typename T, std::size_t N>
+struct ArenaView<std::array<T, N>>
+{
+   using type = std::conditional_t<
+      std::is_trivially_copyable<T>::value,
+      ArrayView<T>,
+      void>;
+};
+
+/// ArenaConversionPolicy to convert from one type to another.
+///
+/// This conversion policy lies between the MinimalConversionPolicy, that keeps
+/// pointers that may dangle, and the DefaultConversionPolicy, that makes deep
+/// copies. Strings, string literals, const char*, and vectors and arrays of
+/// trivially copyable elements are copied with a single memcpy into an arena
+/// owned by the policy, i.e. the call recorder, and stored as views into the
+/// arena. Pointers and std::unique_ptr to these are handled the same way. All
+/// other types are converted like in the DefaultConversionPolicy.
+///
+/// The views are valid as long as the call recorder is alive. Result sets
+/// holding views must not outlive the recorder.
+///
+class ArenaConversionPolicy
+{
+public:
+
+   /// Constructor.
+   ///
+   /// \exception Exception neutral.
+   ///
+   ArenaConversionPolicy();
+
+   template<typename T>
+   auto convert( T&& object );
+
+   template<typename T>
+   auto convert( T* objectPtr );
+
+   StringView convert( const char* stringPtr );
+
+   template<typename T>
+   auto convert( const std::unique_ptr<T>& objectUPtr );
+
+   template<typename T>
+   auto convert( std::unique_ptr<T>&& objectUPtr );
+
+   /// Returns the number of bytes copied into the arena.
+   ///
+   /// \returns
+   ///   The number of bytes.
+   ///
+   /// \exception No-throw.
+   ///
+   std::size_t arenaSize() const noexcept;
+
+
+private:
+
+   Arena arena_;
+
+   template<typename T>
+   using IsViewed_ =
+      std::integral_constant<bool,
+         !std::is_void<typename ArenaView<T>::type>::value>;
+
+   template<typename T>
+   auto view_( T&& object, std::false_type );
+
+   template<typename T>
+   auto view_( const T& object, std::true_type );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "ArenaConversionPolicy.tcc"
@@ -0,0 +1,95 @@
+/*
+
+   ArenaConversionPolicy.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <utility>      // std::forward
+#include <cstring>      // std::strlen
+
+
+namespace unimock
+{
+
+inline ArenaConversionPolicy::ArenaConversionPolicy()
+:
+   arena_()
+{
+}
+
+// Plain auto never deduces to a reference, so the types that aren't viewed
+// are stored as copies, just like in the DefaultConversionPolicy.
+template<typename T>
+auto ArenaConversionPolicy::view_( T&& object, std::false_type )
+{
+   return std::forward<T>( object );
+}
+
+template<typename T>
+auto ArenaConversionPolicy::view_( const T& object, std::true_type )
+{
+   using ViewT = typename ArenaView<T>::type;
+   using ElementT = typename ViewT::value_type;
+
+   auto data = static_cast<const ElementT*>( arena_.copy(
+      object.data(),
+      object.size() * sizeof( ElementT ),
+      alignof( ElementT ) ) );
+
+   return ViewT( data, object.size() );
+}
+
+template<typename T>
+auto ArenaConversionPolicy::convert( T&& object )
+{
+   return view_( std::forward<T>( object ), IsViewed_<std::decay_t<T>>() );
+}
+
+template<typename T>
+auto ArenaConversionPolicy::convert( T* objectPtr )
+{
+   return view_(
+      static_cast<const T&>( *objectPtr ),
+      IsViewed_<std::remove_cv_t<T>>() );
+}
+
+inline StringView ArenaConversionPolicy::convert( const char* stringPtr )
+{
+   const std::size_t size = std::strlen( stringPtr );
+
+   return StringView(
+      static_cast<const char*>( arena_.copy( stringPtr, size, 1 ) ), size );
+}
+
+template<typename T>
+auto ArenaConversionPolicy::convert( const std::unique_ptr<T>& objectUPtr )
+{
+   return view_(
+      static_cast<const T&>( *objectUPtr ),
+      IsViewed_<std::remove_cv_t<T>>() );
+}
+
+template<typename T>
+auto ArenaConversionPolicy::convert( std::unique_ptr<T>&& objectUPtr )
+{
+   return view_(
+      static_cast<const T&>( *objectUPtr ),
+      IsViewed_<std::remove_cv_t<T>>() );
+}
+
+inline std::size_t ArenaConversionPolicy::arenaSize() const noexcept
+{
+   return arena_.size();
+}
+
+
+} // namespace
@@ -0,0 +1,130 @@
+/*
+
+   ArrayView.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <vector>
+
+
+namespace unimock
+{
+
+/// View of an array owned by someone else.
+///
+/// The view refers to a contiguous sequence of elements without owning them.
+/// The ArenaConversionPolicy stores vectors and arrays of trivially copyable
+/// elements as views into an arena owned by the call recorder. A view is
+/// compared by the elements it refers to, also directly with a std::vector.
+///
+template<typename T>
+class ArrayView
+{
+public:
+
+   using value_type = T;
+
+   using const_iterator = const T*;
+
+   /// Constructor.
+   ///
+   /// This constructor constructs an empty view.
+   ///
+   /// \exception No-throw.
+   ///
+   ArrayView() noexcept;
+
+   /// Constructor.
+   ///
+   /// \param[in] data
+   ///   The first element to refer to.
+   ///
+   /// \param[in] size
+   ///   The number of elements to refer to.
+   ///
+   /// \exception No-throw.
+   ///
+   ArrayView( const T* data, std::size_t size ) noexcept;
+
+   /// Constructor.
+   ///
+   /// \param[in] vector
+   ///   The vector to refer to. It must outlive the view.
+   ///
+   /// \exception No-throw.
+   ///
+   template<class Allocator>
+   ArrayView( const std::vector<T, Allocator>& vector ) noexcept;
+
+   const T* data() const noexcept;
+
+   std::size_t size() const noexcept;
+
+   bool empty() const noexcept;
+
+   const_iterator begin() const noexcept;
+
+   const_iterator end() const noexcept;
+
+   const T& operator[]( std::size_t index ) const noexcept;
+
+   /// Returns a copy of the elements as a vector.
+   ///
+   /// \returns
+   ///   The vector.
+   ///
+   /// \exception Exception neutral.
+   ///
+   std::vector<T> toVector() const;
+
+
+private:
+
+   const T* data_;
+
+   std::size_t size_;
+
+};
+
+template<typename T>
+bool operator==( const ArrayView<T>& lhs, const ArrayView<T>& rhs );
+
+template<typename T>
+bool operator!=( const ArrayView<T>& lhs, const ArrayView<T>& rhs );
+
+template<typename T, class Allocator>
+bool operator==(
+   const ArrayView<T>& lhs,
+   const std::vector<T, Allocator>& rhs );
+
+template<typename T, class Allocator>
+bool operator==(
+   const std::vector<T, Allocator>& lhs,
+   const ArrayView<T>& rhs );
+
+template<typename T, class Allocator>
+bool operator!=(
+   const ArrayView<T>& lhs,
+   const std::vector<T, Allocator>& rhs );
+
+template<typename T, class Allocator>
+bool operator!=(
+   const std::vector<T, Allocator>& lhs,
+   const ArrayView<T>& rhs );
+
+
+} // namespace
+
+
+// Implementation.
+#include "ArrayView.tcc"
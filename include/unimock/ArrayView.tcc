@@ -0,0 +1,135 @@
+/*
+
+   ArrayView.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <algorithm>    // std::equal
+
+
+namespace unimock
+{
+
+template<typename T>
+ArrayView<T>::ArrayView() noexcept
+:
+   data_( nullptr ),
+   size_( 0 )
+{
+}
+
+template<typename T>
+ArrayView<T>::ArrayView( const T* data, std::size_t size ) noexcept
+:
+   data_( data ),
+   size_( size )
+{
+}
+
+template<typename T>
+template<class Allocator>
+ArrayView<T>::ArrayView( const std::vector<T, Allocator>& vector ) noexcept
+:
+   data_( vector.data() ),
+   size_( vector.size() )
+{
+}
+
+template<typename T>
+const T* ArrayView<T>::data() const noexcept
+{
+   return data_;
+}
+
+template<typename T>
+std::size_t ArrayView<T>::size() const noexcept
+{
+   return size_;
+}
+
+template<typename T>
+bool ArrayView<T>::empty() const noexcept
+{
+   return size_ == 0;
+}
+
+template<typename T>
+typename ArrayView<T>::const_iterator ArrayView<T>::begin() const noexcept
+{
+   return data_;
+}
+
+template<typename T>
+typename ArrayView<T>::const_iterator ArrayView<T>::end() const noexcept
+{
+   return data_ + size_;
+}
+
+template<typename T>
+const T& ArrayView<T>::operator[]( std::size_t index ) const noexcept
+{
+   return data_[ index ];
+}
+
+template<typename T>
+std::vector<T> ArrayView<T>::toVector() const
+{
+   return std::vector<T>( data_, data_ + size_ );
+}
+
+template<typename T>
+bool operator==( const ArrayView<T>& lhs, const ArrayView<T>& rhs )
+{
+   return lhs.size() == rhs.size() &&
+      std::equal( lhs.begin(), lhs.end(), rhs.begin() );
+}
+
+template<typename T>
+bool operator!=( const ArrayView<T>& lhs, const ArrayView<T>& rhs )
+{
+   return !( lhs == rhs );
+}
+
+template<typename T, class Allocator>
+bool operator==(
+   const ArrayView<T>& lhs,
+   const std::vector<T, Allocator>& rhs )
+{
+   return lhs == ArrayView<T>( rhs );
+}
+
+template<typename T, class Allocator>
+bool operator==(
+   const std::vector<T, Allocator>& lhs,
+   const ArrayView<T>& rhs )
+{
+   return ArrayView<T>( lhs ) == rhs;
+}
+
+template<typename T, class Allocator>
+bool operator!=(
+   const ArrayView<T>& lhs,
+   const std::vector<T, Allocator>& rhs )
+{
+   return !( lhs == rhs );
+}
+
+template<typename T, class Allocator>
+bool operator!=(
+   const std::vector<T, Allocator>& lhs,
+   const ArrayView<T>& rhs )
+{
+   return !( lhs == rhs );
+}
+
+
+} // namespace
@@ -15,11 +15,28 @@ ________________________________________________________________________________
 
 #include <vector>
 #include <tuple>
+#include <cstdint>
 #include <typeindex>
-#include <memory>       // std::unique_ptr
+#include <memory>       // std::unique_ptr, std::shared_ptr
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <type_traits>
+#include <utility>      // std::index_sequence
+#include <string>
+#include <exception>   // std::exception_ptr
 
 #include "unimock/DefaultConversionPolicy.hh"
 #include "unimock/FiniteID.hh"
+#include "unimock/ThreadPool.hh"
+#include "unimock/HyperLogLog.hh"
+#include "unimock/QuantileSketch.hh"
+#include "unimock/RunningAggregates.hh"
+#include "Internal/MethodKey.hh"
+#include "Internal/CompressedHistory.hh"
+#include "Internal/ArgumentFilter.hh"
+#include "Internal/CallQueue.hh"
+#include "Internal/Expectations.hh"
 
 
 namespace unimock
@@ -27,6 +44,14 @@ namespace unimock
 
 class ArgumentTupleI;
 
+/// How recorded calls are delivered to an observer.
+///
+/// INLINE observers are called by the recording thread right after the call is
+/// stored. QUEUED observers are called by a background thread of the recorder,
+/// with a copy of the converted arguments.
+///
+enum class ObserverDelivery { INLINE, QUEUED };
+
 
 /// CallRecorder to record call activity.
 ///
@@ -133,7 +158,8 @@ public:
    ///
    /// This find method looks up all recorded occasions of calls to the
    /// non-member or static member function provided and returns the result as
-   /// an iterable container of tuples.
+   /// an iterable container of tuples. Calls recorded after the function was
+   /// projected are only found by the find methods taking the columns.
    ///
    /// \param[in] functionPtr
    ///   The function who's recorded calls shall be looked up.
@@ -156,7 +182,8 @@ public:
    /// stored object identifier into account. Note that this may not be what you
    /// usually want. Take a look at the find method taking also the object
    /// identifier as a search criteria before you decide which functionality
-   /// suits you best.
+   /// suits you best. Calls recorded after the method was projected are only
+   /// found by the find methods taking the columns.
    ///
    /// \param[in] methodPtr
    ///   The method who's recorded calls shall be looked up.
@@ -236,6 +263,931 @@ public:
    auto find(
       const FiniteID& objectID, R(T::*methodPtr)(Parameters...) const ) const;
 
+   /// Keeps only some of the arguments in calls to a function.
+   ///
+   /// From now on, the calls to the function provided are recorded with only
+   /// the arguments in the columns given, in the order given. The other
+   /// arguments are never converted or copied. The projected calls are looked
+   /// up with the find methods taking the same columns as template arguments,
+   /// while the calls recorded before are still found as usual. The find
+   /// methods without columns don't find the projected calls, but the count
+   /// methods count them along with the other calls.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// recorder.project<2>( write );
+   /// write( fd, buffer, 4096, 0 );
+   /// auto resultSet = makeResultSet( recorder.find<2>( write ) );
+   /// assert( resultSet.get<0>( 0 ) == 4096 );
+   /// ~~~
+   ///
+   /// \param[in] functionPtr
+   ///   The function who's calls shall be projected.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      typename... Parameters>
+   void project( R(*functionPtr)(Parameters...) );
+
+   /// Keeps only some of the arguments in calls to a method.
+   ///
+   /// This method works the same as the project method for functions. The
+   /// projection applies to all objects.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be projected.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      class T,
+      typename... Parameters>
+   void project( R(T::*methodPtr)(Parameters...) );
+
+   /// Keeps only some of the arguments in calls to a method.
+   ///
+   /// This method works the same as the other project method for methods. The
+   /// difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be projected.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      class T,
+      typename... Parameters>
+   void project( R(T::*methodPtr)(Parameters...) const );
+
+   /// Finds all projected calls for the function provided.
+   ///
+   /// This find method looks up the calls recorded after the function was
+   /// projected with the same columns.
+   ///
+   /// \param[in] functionPtr
+   ///   The function who's projected calls shall be looked up.
+   ///
+   /// \returns
+   ///   The projected calls for the provided function, returned as an
+   ///   iterable container of tuples where each tuple contains the converted
+   ///   arguments in the projected columns.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      typename... Parameters>
+   auto find( R(*functionPtr)(Parameters...) ) const;
+
+   /// Finds all projected calls for the method provided.
+   ///
+   /// This find method looks up the calls recorded after the method was
+   /// projected with the same columns, for all objects.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's projected calls shall be looked up.
+   ///
+   /// \returns
+   ///   The projected calls for the provided method, returned as an iterable
+   ///   container of tuples where each tuple contains the converted arguments
+   ///   in the projected columns.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      class T,
+      typename... Parameters>
+   auto find( R(T::*methodPtr)(Parameters...) ) const;
+
+   /// Finds all projected calls for the method provided.
+   ///
+   /// This find method works the same as the other find method for projected
+   /// calls to methods. The difference is that it takes a const method
+   /// pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's projected calls shall be looked up.
+   ///
+   /// \returns
+   ///   The projected calls for the provided method.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      class T,
+      typename... Parameters>
+   auto find( R(T::*methodPtr)(Parameters...) const ) const;
+
+   /// Finds all projected calls for the object identifier and method provided.
+   ///
+   /// This find method looks up the calls recorded after the method was
+   /// projected with the same columns, for the object provided.
+   ///
+   /// \param[in] objectID
+   ///   The object identifier who's projected calls shall be looked up.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's projected calls shall be looked up.
+   ///
+   /// \returns
+   ///   The projected calls for the provided object identifier and method.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      class T,
+      typename... Parameters>
+   auto find(
+      const FiniteID& objectID, R(T::*methodPtr)(Parameters...) ) const;
+
+   /// Finds all projected calls for the object identifier and method provided.
+   ///
+   /// This find method works the same as the other find method for projected
+   /// calls to an object. The difference is that it takes a const method
+   /// pointer.
+   ///
+   /// \param[in] objectID
+   ///   The object identifier who's projected calls shall be looked up.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's projected calls shall be looked up.
+   ///
+   /// \returns
+   ///   The projected calls for the provided object identifier and method.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      class T,
+      typename... Parameters>
+   auto find(
+      const FiniteID& objectID, R(T::*methodPtr)(Parameters...) const ) const;
+
+   /// Sets a thread pool to use when searching the call history.
+   ///
+   /// When a thread pool is set, the find methods split a large call history
+   /// into chunks that are searched in parallel. The results from the chunks
+   /// are merged in the order they were recorded, so the result is the same as
+   /// without a thread pool. Small call histories are still searched by the
+   /// calling thread only.
+   ///
+   /// Note! The call history must not be recorded to while it's searched,
+   /// unless the recorder is asynchronous.
+   ///
+   /// \param[in] threadPool
+   ///   The thread pool to use, or nullptr to search with the calling thread
+   ///   only.
+   ///
+   /// \exception No-throw.
+   ///
+   void setThreadPool( std::shared_ptr<ThreadPool> threadPool ) noexcept;
+
+   /// Tracks the number of distinct values of an argument to a function.
+   ///
+   /// This method attaches a HyperLogLog sketch to a column of the function
+   /// provided. Every call recorded from now on adds its converted argument in
+   /// the column to the sketch. The sketch uses constant memory, so the number
+   /// of distinct values can be estimated even when the call history isn't
+   /// kept. The converted argument type must be hashable with std::hash.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// auto keys = recorder.trackDistinct<0>( getValue );
+   /// runSimulation();
+   /// assert( keys->estimate() < 1000 );
+   /// ~~~
+   ///
+   /// \param[in] functionPtr
+   ///   The function who's calls shall be tracked.
+   ///
+   /// \returns
+   ///   The sketch, updated as calls are recorded.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column, typename R, typename... Parameters>
+   std::shared_ptr<const HyperLogLog> trackDistinct(
+      R(*functionPtr)(Parameters...) );
+
+   /// Tracks the number of distinct values of an argument to a method.
+   ///
+   /// This method works the same as the trackDistinct method for functions.
+   /// The calls to the method are tracked for all objects.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be tracked.
+   ///
+   /// \returns
+   ///   The sketch, updated as calls are recorded.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column, typename R, class T, typename... Parameters>
+   std::shared_ptr<const HyperLogLog> trackDistinct(
+      R(T::*methodPtr)(Parameters...) );
+
+   /// Tracks the number of distinct values of an argument to a method.
+   ///
+   /// This method works the same as the other trackDistinct method for
+   /// methods. The difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be tracked.
+   ///
+   /// \returns
+   ///   The sketch, updated as calls are recorded.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column, typename R, class T, typename... Parameters>
+   std::shared_ptr<const HyperLogLog> trackDistinct(
+      R(T::*methodPtr)(Parameters...) const );
+
+   /// Tracks the quantiles of an argument to a function.
+   ///
+   /// This method attaches a t-digest quantile sketch to a column of the
+   /// function provided. Every call recorded from now on adds its converted
+   /// argument in the column to the sketch. The sketch uses constant memory,
+   /// so percentiles can be estimated even when the call history isn't kept.
+   /// The converted argument type must be arithmetic.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// auto sizes = recorder.trackQuantiles<1>( writeData );
+   /// runSimulation();
+   /// assert( sizes->quantile( 0.99 ) < 65536 );
+   /// ~~~
+   ///
+   /// \param[in] functionPtr
+   ///   The function who's calls shall be tracked.
+   ///
+   /// \returns
+   ///   The sketch, updated as calls are recorded.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column, typename R, typename... Parameters>
+   std::shared_ptr<const QuantileSketch> trackQuantiles(
+      R(*functionPtr)(Parameters...) );
+
+   /// Tracks the quantiles of an argument to a method.
+   ///
+   /// This method works the same as the trackQuantiles method for functions.
+   /// The calls to the method are tracked for all objects.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be tracked.
+   ///
+   /// \returns
+   ///   The sketch, updated as calls are recorded.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column, typename R, class T, typename... Parameters>
+   std::shared_ptr<const QuantileSketch> trackQuantiles(
+      R(T::*methodPtr)(Parameters...) );
+
+   /// Tracks the quantiles of an argument to a method.
+   ///
+   /// This method works the same as the other trackQuantiles method for
+   /// methods. The difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be tracked.
+   ///
+   /// \returns
+   ///   The sketch, updated as calls are recorded.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column, typename R, class T, typename... Parameters>
+   std::shared_ptr<const QuantileSketch> trackQuantiles(
+      R(T::*methodPtr)(Parameters...) const );
+
+   /// Tracks the count, min, max and sum of an argument to a function.
+   ///
+   /// This method attaches running aggregates to a column of the function
+   /// provided. Every call recorded from now on folds its converted argument
+   /// in the column into the aggregates. The converted argument type must be
+   /// arithmetic. Together with the aggregate only mode, the calls can be
+   /// checked in constant memory regardless of how many there are.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// auto levels = recorder.trackAggregates<0>( &IStove::turnOnBurner );
+   /// recorder.setAggregateOnly( true );
+   /// runSimulation();
+   /// assert( levels->max() <= SAFETY_LIMIT );
+   /// ~~~
+   ///
+   /// \param[in] functionPtr
+   ///   The function who's calls shall be tracked.
+   ///
+   /// \returns
+   ///   The aggregates, updated as calls are recorded.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column, typename R, typename... Parameters>
+   auto trackAggregates( R(*functionPtr)(Parameters...) );
+
+   /// Tracks the count, min, max and sum of an argument to a method.
+   ///
+   /// This method works the same as the trackAggregates method for functions.
+   /// The calls to the method are tracked for all objects.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be tracked.
+   ///
+   /// \returns
+   ///   The aggregates, updated as calls are recorded.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column, typename R, class T, typename... Parameters>
+   auto trackAggregates( R(T::*methodPtr)(Parameters...) );
+
+   /// Tracks the count, min, max and sum of an argument to a method.
+   ///
+   /// This method works the same as the other trackAggregates method for
+   /// methods. The difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be tracked.
+   ///
+   /// \returns
+   ///   The aggregates, updated as calls are recorded.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column, typename R, class T, typename... Parameters>
+   auto trackAggregates( R(T::*methodPtr)(Parameters...) const );
+
+   /// Keeps the calls to a function in a compressed call history.
+   ///
+   /// The calls to the function provided are from now on kept in a history of
+   /// their own, encoded in chunks with delta, run length and varint encoding
+   /// per argument, and decoded again when they are looked up. Calls with
+   /// monotonic offsets, small enums or repeated arguments then take a fraction
+   /// of the memory, while the find methods work as before. The interleave
+   /// with the calls to other functions and methods isn't kept. The converted
+   /// arguments must be integers or enums, and no calls to the function may
+   /// have been recorded before.
+   ///
+   /// \param[in] functionPtr
+   ///   The function who's calls shall be compressed.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void compressHistory( R(*functionPtr)(Parameters...) );
+
+   /// Keeps the calls to a method in a compressed call history.
+   ///
+   /// This method works the same as the compressHistory method for functions.
+   /// The calls to the method are compressed for all objects.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be compressed.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, class T, typename... Parameters>
+   void compressHistory( R(T::*methodPtr)(Parameters...) );
+
+   /// Keeps the calls to a method in a compressed call history.
+   ///
+   /// This method works the same as the other compressHistory method for
+   /// methods. The difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be compressed.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, class T, typename... Parameters>
+   void compressHistory( R(T::*methodPtr)(Parameters...) const );
+
+   /// Sets whether calls are recorded by default.
+   ///
+   /// Calls that aren't recorded are dropped before their arguments are
+   /// converted, so they cost next to nothing. With the default turned off,
+   /// only the functions and methods explicitly turned on with setRecorded
+   /// are recorded. The default is on.
+   ///
+   /// \param[in] recorded
+   ///   True to record calls by default, false to drop them.
+   ///
+   /// \exception No-throw.
+   ///
+   void setRecordedByDefault( bool recorded ) noexcept;
+
+   /// Sets whether calls to a function are recorded.
+   ///
+   /// The setting overrides the default set by setRecordedByDefault.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// recorder.setRecordedByDefault( false );
+   /// recorder.setRecorded( &IStove::turnOnBurner, true );
+   /// ~~~
+   ///
+   /// \param[in] functionPtr
+   ///   The function who's calls shall be recorded or dropped.
+   ///
+   /// \param[in] recorded
+   ///   True to record the calls, false to drop them.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setRecorded( R(*functionPtr)(Parameters...), bool recorded );
+
+   /// Sets whether calls to a method are recorded.
+   ///
+   /// This method works the same as the setRecorded method for functions. The
+   /// setting applies to all objects.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be recorded or dropped.
+   ///
+   /// \param[in] recorded
+   ///   True to record the calls, false to drop them.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, class T, typename... Parameters>
+   void setRecorded( R(T::*methodPtr)(Parameters...), bool recorded );
+
+   /// Sets whether calls to a method are recorded.
+   ///
+   /// This method works the same as the other setRecorded method for methods.
+   /// The difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be recorded or dropped.
+   ///
+   /// \param[in] recorded
+   ///   True to record the calls, false to drop them.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, class T, typename... Parameters>
+   void setRecorded( R(T::*methodPtr)(Parameters...) const, bool recorded );
+
+   /// Sets a filter selecting which calls to a function are recorded.
+   ///
+   /// The filter is a predicate called with the arguments as they are passed,
+   /// as const references, before any conversion. Calls for which it returns
+   /// false are dropped. Setting a new filter replaces the previous one.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// recorder.setFilter( &IStove::turnOnBurner, []( int level )
+   /// {
+   ///    return level > 5;
+   /// } );
+   /// ~~~
+   ///
+   /// \param[in] functionPtr
+   ///   The function who's calls shall be filtered.
+   ///
+   /// \param[in] predicate
+   ///   The predicate selecting the calls to record.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters, class F>
+   void setFilter( R(*functionPtr)(Parameters...), F predicate );
+
+   /// Sets a filter selecting which calls to a method are recorded.
+   ///
+   /// This method works the same as the setFilter method for functions. The
+   /// filter applies to all objects.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be filtered.
+   ///
+   /// \param[in] predicate
+   ///   The predicate selecting the calls to record.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, class T, typename... Parameters, class F>
+   void setFilter( R(T::*methodPtr)(Parameters...), F predicate );
+
+   /// Sets a filter selecting which calls to a method are recorded.
+   ///
+   /// This method works the same as the other setFilter method for methods.
+   /// The difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be filtered.
+   ///
+   /// \param[in] predicate
+   ///   The predicate selecting the calls to record.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, class T, typename... Parameters, class F>
+   void setFilter( R(T::*methodPtr)(Parameters...) const, F predicate );
+
+   /// Sets whether calls are only folded into aggregates.
+   ///
+   /// In aggregate only mode, a recorded call only updates the sketches and
+   /// aggregates attached to its function or method, and the call count. The
+   /// call history isn't grown, so the memory used is proportional to the
+   /// number of functions and methods called, not to the number of calls. The
+   /// arguments are only converted if something is attached to the function
+   /// or method, and then without allocating. The find methods will only see
+   /// calls recorded while the mode was off.
+   ///
+   /// \param[in] aggregateOnly
+   ///   True to only keep aggregates, false to also keep the call history.
+   ///
+   /// \exception No-throw.
+   ///
+   void setAggregateOnly( bool aggregateOnly ) noexcept;
+
+   /// Sets whether calls are stored by a background thread.
+   ///
+   /// In asynchronous mode, a recorded call is converted by the calling thread
+   /// as usual, and then pushed into a lock free queue of the calling thread.
+   /// A background thread collects the calls from the queues. The find and
+   /// count methods move the collected calls into the call history before
+   /// they look, so they see the same calls as in synchronous mode. Recording
+   /// then costs little and varies little, which matters when the response
+   /// time of the code under test is measured.
+   ///
+   /// Calls can be recorded from several threads at the same time in either
+   /// mode, as long as the recorder isn't changed meanwhile. In synchronous
+   /// mode the calls are recorded one at a time. In asynchronous mode, plain
+   /// calls are converted and queued without a lock, provided the conversion
+   /// policy keeps no state, like the DefaultConversionPolicy. Calls to
+   /// functions and methods with something attached, like filters, sketches,
+   /// aggregates, expectations, observers or a compressed history, and all
+   /// calls converted by a policy with state, like the interning policy, are
+   /// still recorded one at a time by the calling thread. The calls recorded
+   /// by each thread are kept in order, while the interleave between threads
+   /// may not be.
+   ///
+   /// Turning the mode off hands over the remaining calls and stops the
+   /// background thread. No calls may be recorded while the mode is set.
+   ///
+   /// \param[in] asynchronous
+   ///   True to store the calls in a background thread, false to store them
+   ///   in the calling thread.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void setAsynchronous( bool asynchronous );
+
+   /// Counts the recorded calls for the function provided.
+   ///
+   /// The count includes calls recorded in aggregate only mode and projected
+   /// calls, which the find methods without columns don't find.
+   ///
+   /// \param[in] functionPtr
+   ///   The function who's recorded calls shall be counted.
+   ///
+   /// \returns
+   ///   The number of recorded calls.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   std::size_t count( R(*functionPtr)(Parameters...) ) const;
+
+   /// Counts the recorded calls for the method provided.
+   ///
+   /// The calls are counted for all objects and the count includes calls
+   /// recorded in aggregate only mode and projected calls.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's recorded calls shall be counted.
+   ///
+   /// \returns
+   ///   The number of recorded calls.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, class T, typename... Parameters>
+   std::size_t count( R(T::*methodPtr)(Parameters...) ) const;
+
+   /// Counts the recorded calls for the method provided.
+   ///
+   /// This method works the same as the other count method for methods. The
+   /// difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's recorded calls shall be counted.
+   ///
+   /// \returns
+   ///   The number of recorded calls.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, class T, typename... Parameters>
+   std::size_t count( R(T::*methodPtr)(Parameters...) const ) const;
+
+   /// Observes the recorded calls to a function.
+   ///
+   /// The observer is called with the converted arguments of each call to the
+   /// function recorded from now on, as const references. Calls dropped by
+   /// setRecorded or a filter aren't observed, while calls recorded in
+   /// aggregate only mode, to a compressed history or projected are. An
+   /// inline observer may throw to abort the code under test, and the call is
+   /// stored nonetheless. An exception thrown by a queued observer goes
+   /// to the observer error handler, and the converted arguments must be
+   /// copyable.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// recorder.observe( &IStove::turnOnBurner, []( int level )
+   /// {
+   ///    if( level > SAFETY_LIMIT )
+   ///       throw std::runtime_error( "Burner overheated" );
+   /// } );
+   /// ~~~
+   ///
+   /// \param[in] functionPtr
+   ///   The function who's calls shall be observed.
+   ///
+   /// \param[in] observer
+   ///   The observer to call.
+   ///
+   /// \param[in] delivery
+   ///   Whether the observer is called inline or queued.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class F, typename R, typename... Parameters>
+   void observe(
+      R(*functionPtr)(Parameters...),
+      F observer,
+      ObserverDelivery delivery = ObserverDelivery::INLINE );
+
+   /// Observes the recorded calls to a method.
+   ///
+   /// This method works the same as the observe method for functions. The
+   /// calls to the method are observed for all objects.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be observed.
+   ///
+   /// \param[in] observer
+   ///   The observer to call.
+   ///
+   /// \param[in] delivery
+   ///   Whether the observer is called inline or queued.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class F, typename R, class T, typename... Parameters>
+   void observe(
+      R(T::*methodPtr)(Parameters...),
+      F observer,
+      ObserverDelivery delivery = ObserverDelivery::INLINE );
+
+   /// Observes the recorded calls to a method.
+   ///
+   /// This method works the same as the other observe method for methods. The
+   /// difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls shall be observed.
+   ///
+   /// \param[in] observer
+   ///   The observer to call.
+   ///
+   /// \param[in] delivery
+   ///   Whether the observer is called inline or queued.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class F, typename R, class T, typename... Parameters>
+   void observe(
+      R(T::*methodPtr)(Parameters...) const,
+      F observer,
+      ObserverDelivery delivery = ObserverDelivery::INLINE );
+
+   /// Observes all recorded calls, without their arguments.
+   ///
+   /// The observer is called for each call recorded from now on, regardless
+   /// of function or method, with the type of the function or method pointer
+   /// and the object identifier, which is uninitialized for functions. The
+   /// arguments aren't passed, since their types differ between the calls.
+   /// Use the observe methods to see the arguments of a function or method.
+   ///
+   /// \param[in] observer
+   ///   The observer to call.
+   ///
+   /// \param[in] delivery
+   ///   Whether the observer is called inline or queued.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void observeAllWithoutArguments(
+      std::function<void(const std::type_index&, const FiniteID&)> observer,
+      ObserverDelivery delivery = ObserverDelivery::INLINE );
+
+   /// Waits for the queued observers.
+   ///
+   /// When this method returns, the queued observers have been called for all
+   /// calls recorded before. It must not be called by a queued observer.
+   ///
+   /// \exception std::exception
+   ///   The first exception thrown by a queued observer since the last flush
+   ///   is rethrown, unless an observer error handler is set.
+   ///
+   void flushObservers();
+
+   /// Sets the handler of exceptions thrown by queued observers.
+   ///
+   /// A queued observer is called by a background thread, where an exception
+   /// can't reach the code under test. The handler is called by that thread
+   /// with the exception instead, and the next call is delivered as usual. The
+   /// handler itself must not throw. By default, the first exception is kept
+   /// and rethrown by flushObservers.
+   ///
+   /// \param[in] errorHandler
+   ///   The handler to call, or nullptr for the default.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void setObserverErrorHandler(
+      std::function<void(std::exception_ptr)> errorHandler );
+
+   /// Expects an exact number of calls to a function or method.
+   ///
+   /// The expectation is checked as the calls are recorded, and violated as
+   /// soon as there is one call too many. Too few calls are reported by
+   /// verifyExpectations. The calls to a method are counted for all objects.
+   /// Like all expectations, it doesn't need the calls to be kept in the call
+   /// history, so it can be combined with the aggregate only mode.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// recorder.expectCalls( &IStove::turnOnBurner, 2 );
+   /// recorder.setAggregateOnly( true );
+   /// runSimulation();
+   /// recorder.verifyExpectations();
+   /// ~~~
+   ///
+   /// \param[in] callPtr
+   ///   The function or method pointer who's calls are expected.
+   ///
+   /// \param[in] count
+   ///   The number of calls expected.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class CallPtr>
+   void expectCalls( CallPtr callPtr, std::size_t count );
+
+   /// Expects the calls to a function or method to come after another.
+   ///
+   /// The expectation is violated as soon as the second function or method is
+   /// called before the first one has been called at least once.
+   ///
+   /// \param[in] firstPtr
+   ///   The function or method pointer that shall be called first.
+   ///
+   /// \param[in] secondPtr
+   ///   The function or method pointer that shall be called after.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class FirstPtr, class SecondPtr>
+   void expectOrder( FirstPtr firstPtr, SecondPtr secondPtr );
+
+   /// Expects a limited number of calls between markers.
+   ///
+   /// The expectation is violated as soon as a function or method is called
+   /// more than a number of times in a row, without a call to the marker in
+   /// between. The calls before the first marker count as well.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// // At most three retries per request.
+   /// recorder.expectAtMostBetween( &ISocket::retry, 3, &ISocket::send );
+   /// ~~~
+   ///
+   /// \param[in] callPtr
+   ///   The function or method pointer who's calls are limited.
+   ///
+   /// \param[in] count
+   ///   The number of calls allowed between the markers.
+   ///
+   /// \param[in] markerPtr
+   ///   The function or method pointer who's calls are the markers.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class CallPtr, class MarkerPtr>
+   void expectAtMostBetween(
+      CallPtr callPtr,
+      std::size_t count,
+      MarkerPtr markerPtr );
+
+   /// Expects a function never to be called with some arguments.
+   ///
+   /// The predicate is called with the converted arguments of each call, as
+   /// const references, and the expectation is violated as soon as it
+   /// returns true.
+   ///
+   /// \param[in] functionPtr
+   ///   The function who's calls are checked.
+   ///
+   /// \param[in] predicate
+   ///   The predicate telling the calls that must not happen.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class F, typename R, typename... Parameters>
+   void expectNever( R(*functionPtr)(Parameters...), F predicate );
+
+   /// Expects a method never to be called with some arguments.
+   ///
+   /// This method works the same as the expectNever method for functions. The
+   /// calls to the method are checked for all objects.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls are checked.
+   ///
+   /// \param[in] predicate
+   ///   The predicate telling the calls that must not happen.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class F, typename R, class T, typename... Parameters>
+   void expectNever( R(T::*methodPtr)(Parameters...), F predicate );
+
+   /// Expects a method never to be called with some arguments.
+   ///
+   /// This method works the same as the other expectNever method for methods.
+   /// The difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's calls are checked.
+   ///
+   /// \param[in] predicate
+   ///   The predicate telling the calls that must not happen.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class F, typename R, class T, typename... Parameters>
+   void expectNever( R(T::*methodPtr)(Parameters...) const, F predicate );
+
+   /// Sets the handler of expectation violations.
+   ///
+   /// The handler is called with a description of each violated expectation.
+   /// It's called from the record method once the violating call is stored,
+   /// or from verifyExpectations. Each expectation is reported once. The
+   /// default handler throws ExpectationViolation, and the violating call is
+   /// still found in the call history.
+   ///
+   /// \param[in] violationHandler
+   ///   The handler to call.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void setViolationHandler(
+      std::function<void(const std::string&)> violationHandler );
+
+   /// Verifies the expectations that need more calls to be met.
+   ///
+   /// The violations found as the calls were recorded are already reported,
+   /// so this method reports the expected calls that never came.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void verifyExpectations() const;
+
 
 private:
 
@@ -246,12 +1198,140 @@ private:
    // call this way of doing it a "Massively Unified Code-Key". In essence we
    // use either the function pointer or a combination of the object ID / method
    // pointer to store and retrieve the data.
-   std::vector<std::tuple<
-      std::type_index,
-      void(*)(),
-      FiniteID,
-      void(VoidType_::*)(),
-      std::unique_ptr<ArgumentTupleI>>> callHistory_;
+   struct CallKey_
+   {
+      CallKey_( const MethodKey& methodKey, const FiniteID& objectID )
+      :
+         methodKey( methodKey ),
+         objectID( objectID )
+      {
+      }
+
+      bool operator==( const CallKey_& other ) const noexcept;
+
+      MethodKey methodKey;
+
+      FiniteID objectID;
+   };
+
+   struct CallKeyHash_
+   {
+      std::size_t operator()( const CallKey_& callKey ) const noexcept;
+   };
+
+   // Each distinct call key is stored once and the calls in the history refer
+   // to it by index, which keeps the history entries small and lets the find
+   // methods match a call with a single lookup.
+   using Call_ = std::pair<std::uint32_t, std::unique_ptr<ArgumentTupleI>>;
+
+   // Serializes recording and querying, except for the plain calls recorded
+   // lock free in asynchronous mode. Recursive since a hook, like an inline
+   // observer, may record into or query the recorder that calls it.
+   mutable std::recursive_mutex recordMutex_;
+
+   // Mutable since the queries drain the calls recorded asynchronously into
+   // the call history, and intern their keys.
+   mutable std::vector<Call_> callHistory_;
+
+   mutable std::vector<CallKey_> callKeys_;
+
+   mutable std::unordered_map<CallKey_, std::uint32_t, CallKeyHash_>
+      callKeyIndices_;
+
+   // The calls recorded asynchronously on their way to the call history, with
+   // keys that aren't interned yet.
+   using PendingCall_ = std::pair<CallKey_, std::unique_ptr<ArgumentTupleI>>;
+
+   std::unique_ptr<CallQueue<PendingCall_>> callQueue_;
+
+   std::shared_ptr<ThreadPool> threadPool_;
+
+   enum class Recorded_ { BY_DEFAULT, YES, NO };
+
+   // Settings and state kept per function or method, regardless of object.
+   struct MethodState_
+   {
+      MethodState_()
+      :
+         recorded( Recorded_::BY_DEFAULT ),
+         filter(),
+         hooks(),
+         aggregatedCalls( 0 ),
+         compressedHistory(),
+         compress(),
+         project(),
+         projectedColumns( 0 ),
+         projectedCalls( 0 )
+      {
+      }
+
+      Recorded_ recorded;
+
+      // Predicate on the arguments before conversion, selecting what to record.
+      std::unique_ptr<ArgumentFilterI> filter;
+
+      // Functors called with the converted arguments of each recorded call.
+      std::vector<std::function<void(const ArgumentTupleI&)>> hooks;
+
+      // Calls recorded in aggregate only mode, not kept in the call history.
+      std::size_t aggregatedCalls;
+
+      // The calls kept in a compressed history instead of the call history,
+      // and the function that appends a call to it.
+      std::unique_ptr<CompressedHistory> compressedHistory;
+
+      std::function<void(
+         CompressedHistory&, const FiniteID&, const ArgumentTupleI&)> compress;
+
+      // The function that records the projected columns of a call, given
+      // pointers to the raw arguments, the columns it needs, one bit per
+      // column, and the number of calls it recorded. The pointers to the
+      // other columns may be null.
+      std::function<void(
+         CallRecorder&, const FiniteID&, const void* const*)> project;
+
+      std::uint64_t projectedColumns;
+
+      std::size_t projectedCalls;
+   };
+
+   // The type identifying the calls projected to some columns in the history.
+   template<class Signature, std::size_t... columns>
+   struct Projection_ {};
+
+   std::unordered_map<MethodKey, MethodState_, MethodKeyHash> methods_;
+
+   // Observers of all calls, called with the type of the function or method
+   // pointer and the object identifier.
+   std::vector<std::function<void(const std::type_index&, const FiniteID&)>>
+      observers_;
+
+   // The expectations, kept apart so the hooks can refer to them regardless of
+   // where the recorder is.
+   std::unique_ptr<Expectations> expectations_;
+
+   // The exceptions thrown by the queued observers, and the handler to report
+   // them to, shared with the background thread delivering the calls.
+   struct ObserverErrors_
+   {
+      ObserverErrors_() : mutex(), handler(), first() {}
+
+      std::mutex mutex;
+
+      std::function<void(std::exception_ptr)> handler;
+
+      std::exception_ptr first;
+   };
+
+   std::unique_ptr<ObserverErrors_> observerErrors_;
+
+   // The calls to the queued observers, on their way to the background thread
+   // calling them.
+   std::unique_ptr<CallQueue<std::function<void()>>> observerQueue_;
+
+   bool aggregateOnly_;
+
+   bool recordedByDefault_;
 
    template<
       typename... TupleParameters,
@@ -266,6 +1346,79 @@ private:
       MethodPtr methodPtr,
       Parameters&&... arguments );
 
+   void append_(
+      CallKey_&& callKey,
+      std::unique_ptr<ArgumentTupleI>&& argumentTuple );
+
+   std::uint32_t intern_( CallKey_&& callKey ) const;
+
+   std::vector<char> matchingKeys_(
+      const MethodKey& methodKey,
+      const FiniteID& objectID ) const;
+
+   std::unique_lock<std::mutex> drain_() const;
+
+   template<std::size_t column, typename... Parameters>
+   std::shared_ptr<const HyperLogLog> trackDistinct_(
+      const MethodKey& methodKey );
+
+   template<std::size_t column, typename... Parameters>
+   std::shared_ptr<const QuantileSketch> trackQuantiles_(
+      const MethodKey& methodKey );
+
+   template<std::size_t column, typename... Parameters>
+   auto trackAggregates_( const MethodKey& methodKey );
+
+   std::size_t count_( const MethodKey& methodKey ) const;
+
+   template<typename... Parameters, class F>
+   void observe_(
+      const MethodKey& methodKey,
+      F observer,
+      ObserverDelivery delivery );
+
+   CallQueue<std::function<void()>>& startObserverQueue_();
+
+   template<typename... Parameters, class F>
+   void expectNever_( const MethodKey& methodKey, F predicate );
+
+   template<typename... Parameters>
+   void compressHistory_( const MethodKey& methodKey );
+
+   template<
+      typename... Parameters,
+      class FunctionPtr,
+      class MethodPtr,
+      std::size_t... columns>
+   void project_(
+      const MethodKey& methodKey,
+      const std::type_index& typeIndex,
+      FunctionPtr functionPtr,
+      MethodPtr methodPtr,
+      std::index_sequence<columns...> );
+
+   template<
+      typename... FncParameters,
+      std::size_t... I,
+      typename... Parameters>
+   void projectCall_(
+      const MethodState_& method,
+      const FiniteID& objectID,
+      std::index_sequence<I...>,
+      Parameters&... arguments );
+
+   template<typename... Parameters>
+   auto findCompressed_(
+      const CompressedHistory& compressedHistory,
+      const FiniteID& objectID,
+      std::true_type ) const;
+
+   template<typename... Parameters>
+   auto findCompressed_(
+      const CompressedHistory& compressedHistory,
+      const FiniteID& objectID,
+      std::false_type ) const;
+
    template<typename... Parameters, class FunctionPtr, class MethodPtr>
    auto find_(
       const std::type_index& typeIndex,
@@ -273,6 +1426,12 @@ private:
       const FiniteID& objectID,
       MethodPtr methodPtr ) const;
 
+   template<typename... Parameters>
+   auto findChunk_(
+      const std::vector<char>& matches,
+      std::size_t first,
+      std::size_t last ) const;
+
 };
 
 
@@ -13,6 +13,12 @@ ________________________________________________________________________________
 
 #pragma once
 
+#include <iterator>     // std::back_inserter
+#include <algorithm>    // std::move, std::copy
+#include <utility>      // std::index_sequence
+#include <type_traits>
+#include <cstdint>
+#include <new>          // placement new
 #include <cassert>
 
 #include "Internal/ArgumentTuple.hh"
@@ -29,6 +35,136 @@ template<class ConversionPolicy, typename T>
 using StorageT =
    decltype( std::declval<ConversionPolicy>().convert( std::declval<T>() ) );
 
+// Check if all types are integers or enums, i.e. fit in a compressed row.
+template<typename... T>
+struct AreIntegers : std::true_type {};
+
+template<typename T, typename... Rest>
+struct AreIntegers<T, Rest...> : std::integral_constant<bool,
+   ( std::is_integral<T>::value || std::is_enum<T>::value ) &&
+      AreIntegers<Rest...>::value> {};
+
+// A raw argument handed over to a projection. An argument of exactly the
+// parameter type is referred to, while others, such as arrays passed to
+// pointer parameters, are converted to the parameter type. The conversion is
+// only done for the projected columns, the others are skipped.
+template<
+   typename FncParameter,
+   typename Parameter,
+   bool = std::is_same<
+      std::remove_cv_t<std::remove_reference_t<FncParameter>>,
+      std::remove_cv_t<std::remove_reference_t<Parameter>>>::value>
+class RawArgument
+{
+public:
+
+   RawArgument( Parameter& argument, bool ) noexcept
+   :
+      argument_( &argument )
+   {
+   }
+
+   RawArgument( const RawArgument& ) = delete;
+
+   RawArgument& operator=( const RawArgument& ) = delete;
+
+   const void* get() const noexcept
+   {
+      return argument_;
+   }
+
+private:
+
+   const Parameter* argument_;
+};
+
+template<typename FncParameter, typename Parameter>
+class RawArgument<FncParameter, Parameter, false>
+{
+public:
+
+   using ValueT = std::decay_t<FncParameter>;
+
+   RawArgument( Parameter& argument, bool projected )
+   :
+      storage_(),
+      projected_( projected )
+   {
+      if( projected_ )
+         new ( &storage_ ) ValueT( argument );
+   }
+
+   RawArgument( const RawArgument& ) = delete;
+
+   RawArgument& operator=( const RawArgument& ) = delete;
+
+   ~RawArgument()
+   {
+      if( projected_ )
+         reinterpret_cast<ValueT*>( &storage_ )->~ValueT();
+   }
+
+   const void* get() const noexcept
+   {
+      return projected_ ? &storage_ : nullptr;
+   }
+
+private:
+
+   typename std::aligned_storage<sizeof( ValueT ), alignof( ValueT )>::type
+      storage_;
+
+   bool projected_;
+};
+
+template<class Projection, class Recorder, typename... RawArguments>
+void handOver(
+   const Projection& project,
+   Recorder& recorder,
+   const FiniteID& objectID,
+   const RawArguments&... rawArguments )
+{
+   const void* const rawArgumentPtrs[] = { rawArguments.get()..., nullptr };
+
+   project( recorder, objectID, rawArgumentPtrs );
+}
+
+template<std::size_t column, typename Tuple>
+using RawArgumentRefT =
+   const std::remove_reference_t<std::tuple_element_t<column, Tuple>>&;
+
+template<std::size_t column, typename Tuple>
+using RawArgumentPtrT =
+   const std::remove_reference_t<std::tuple_element_t<column, Tuple>>*;
+
+// Widen the integer arguments in a tuple to the values of a compressed row.
+template<typename Tuple, std::size_t... I>
+void widenTuple(
+   const Tuple& tuple,
+   std::int64_t* values,
+   std::index_sequence<I...> ) noexcept
+{
+   const std::int64_t widened[] =
+      { static_cast<std::int64_t>( std::get<I>( tuple ) )..., 0 };
+
+   std::copy( widened, widened + sizeof...( I ), values );
+}
+
+// Narrow the values of a compressed row back to a tuple of arguments.
+template<typename Tuple, std::size_t... I>
+Tuple narrowTuple( const std::int64_t* values, std::index_sequence<I...> )
+{
+   return Tuple(
+      static_cast<std::tuple_element_t<I, Tuple>>( values[ I ] )... );
+}
+
+// Call a functor with the elements of a tuple as arguments.
+template<class F, typename Tuple, std::size_t... I>
+auto applyTuple( F& functor, const Tuple& tuple, std::index_sequence<I...> )
+{
+   return functor( std::get<I>( tuple )... );
+}
+
 } // unnamed namespace
 
 
@@ -36,7 +172,19 @@ template<class ConversionPolicy>
 CallRecorder<ConversionPolicy>::CallRecorder()
 :
    ConversionPolicy(),
-   callHistory_()
+   recordMutex_(),
+   callHistory_(),
+   callKeys_(),
+   callKeyIndices_(),
+   callQueue_(),
+   threadPool_(),
+   methods_(),
+   observers_(),
+   expectations_( new Expectations() ),
+   observerErrors_( new ObserverErrors_() ),
+   observerQueue_(),
+   aggregateOnly_( false ),
+   recordedByDefault_( true )
 {
 }
 
@@ -153,89 +301,1219 @@ auto CallRecorder<ConversionPolicy>::find(
       methodPtr );
 }
 
+template<class ConversionPolicy>
+void CallRecorder<ConversionPolicy>::setThreadPool(
+   std::shared_ptr<ThreadPool> threadPool ) noexcept
+{
+   threadPool_ = std::move( threadPool );
+}
+
 template<class ConversionPolicy>
 template<
-   typename... TupleParameters,
-   class TypeIndex,
-   class FunctionPtr,
-   class MethodPtr,
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
    typename... Parameters>
-void CallRecorder<ConversionPolicy>::record_(
-   TypeIndex&& typeIndex,
-   FunctionPtr functionPtr,
+void CallRecorder<ConversionPolicy>::project( R(*functionPtr)(Parameters...) )
+{
+   project_<Parameters...>(
+      functionPtr,
+      typeid( Projection_<decltype( functionPtr ), column, columns...> ),
+      functionPtr,
+      static_cast<void(VoidType_::*)()>( nullptr ),
+      std::index_sequence<column, columns...>() );
+}
+
+template<class ConversionPolicy>
+template<
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
+   class T,
+   typename... Parameters>
+void CallRecorder<ConversionPolicy>::project(
+   R(T::*methodPtr)(Parameters...) )
+{
+   project_<Parameters...>(
+      methodPtr,
+      typeid( Projection_<decltype( methodPtr ), column, columns...> ),
+      static_cast<void(*)()>( nullptr ),
+      methodPtr,
+      std::index_sequence<column, columns...>() );
+}
+
+template<class ConversionPolicy>
+template<
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
+   class T,
+   typename... Parameters>
+void CallRecorder<ConversionPolicy>::project(
+   R(T::*methodPtr)(Parameters...) const )
+{
+   project_<Parameters...>(
+      methodPtr,
+      typeid( Projection_<decltype( methodPtr ), column, columns...> ),
+      static_cast<void(*)()>( nullptr ),
+      methodPtr,
+      std::index_sequence<column, columns...>() );
+}
+
+template<class ConversionPolicy>
+template<
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
+   typename... Parameters>
+auto CallRecorder<ConversionPolicy>::find(
+   R(*functionPtr)(Parameters...) ) const
+{
+   using ParametersT = std::tuple<Parameters...>;
+
+   // The projected arguments are converted from const references.
+   return find_<
+      RawArgumentRefT<column, ParametersT>,
+      RawArgumentRefT<columns, ParametersT>...>(
+         typeid( Projection_<decltype( functionPtr ), column, columns...> ),
+         functionPtr,
+         FiniteID(),
+         static_cast<void(VoidType_::*)()>( nullptr ) );
+}
+
+template<class ConversionPolicy>
+template<
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
+   class T,
+   typename... Parameters>
+auto CallRecorder<ConversionPolicy>::find(
+   R(T::*methodPtr)(Parameters...) ) const
+{
+   return find<column, columns...>( FiniteID(), methodPtr );
+}
+
+template<class ConversionPolicy>
+template<
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
+   class T,
+   typename... Parameters>
+auto CallRecorder<ConversionPolicy>::find(
+   R(T::*methodPtr)(Parameters...) const ) const
+{
+   return find<column, columns...>( FiniteID(), methodPtr );
+}
+
+template<class ConversionPolicy>
+template<
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
+   class T,
+   typename... Parameters>
+auto CallRecorder<ConversionPolicy>::find(
    const FiniteID& objectID,
-   MethodPtr methodPtr,
-   Parameters&&... arguments )
+   R(T::*methodPtr)(Parameters...) ) const
 {
-   // (1) We can't use std::make_unique here since we're using an interface.
-   // (2) Deduce the tuple storage type by means of the conversion policy. The
-   //     deduction uses the parameter types in the function that is recorded,
-   //     not the actual arguments that could be temporaries passed in.
-   callHistory_.emplace_back(
-      std::forward<TypeIndex>( typeIndex ),
-      reinterpret_cast<void(*)()>( functionPtr ),
-      objectID,
-      reinterpret_cast<void(VoidType_::*)()>( methodPtr ),
-      std::unique_ptr<ArgumentTupleI>(    // (1)
-         new ArgumentTuple<
-            StorageT<ConversionPolicy, TupleParameters>...>(   // (2)
-               this->convert( std::forward<Parameters>( arguments ) )... ) ) );
+   using ParametersT = std::tuple<Parameters...>;
+
+   return find_<
+      RawArgumentRefT<column, ParametersT>,
+      RawArgumentRefT<columns, ParametersT>...>(
+         typeid( Projection_<decltype( methodPtr ), column, columns...> ),
+         static_cast<void(*)()>( nullptr ),
+         objectID,
+         methodPtr );
 }
 
 template<class ConversionPolicy>
-template<typename... Parameters, class FunctionPtr, class MethodPtr>
-auto CallRecorder<ConversionPolicy>::find_(
-   const std::type_index& typeIndex,
-   FunctionPtr functionPtr,
+template<
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
+   class T,
+   typename... Parameters>
+auto CallRecorder<ConversionPolicy>::find(
    const FiniteID& objectID,
-   MethodPtr methodPtr ) const
+   R(T::*methodPtr)(Parameters...) const ) const
 {
-   std::vector<std::tuple<StorageT<ConversionPolicy, Parameters>...>> resultSet;
+   using ParametersT = std::tuple<Parameters...>;
 
-   for( auto& call : callHistory_ )
+   return find_<
+      RawArgumentRefT<column, ParametersT>,
+      RawArgumentRefT<columns, ParametersT>...>(
+         typeid( Projection_<decltype( methodPtr ), column, columns...> ),
+         static_cast<void(*)()>( nullptr ),
+         objectID,
+         methodPtr );
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename R, typename... Parameters>
+std::shared_ptr<const HyperLogLog>
+CallRecorder<ConversionPolicy>::trackDistinct(
+   R(*functionPtr)(Parameters...) )
+{
+   return trackDistinct_<column, Parameters...>( functionPtr );
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename R, class T, typename... Parameters>
+std::shared_ptr<const HyperLogLog>
+CallRecorder<ConversionPolicy>::trackDistinct(
+   R(T::*methodPtr)(Parameters...) )
+{
+   return trackDistinct_<column, Parameters...>( methodPtr );
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename R, class T, typename... Parameters>
+std::shared_ptr<const HyperLogLog>
+CallRecorder<ConversionPolicy>::trackDistinct(
+   R(T::*methodPtr)(Parameters...) const )
+{
+   return trackDistinct_<column, Parameters...>( methodPtr );
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename R, typename... Parameters>
+std::shared_ptr<const QuantileSketch>
+CallRecorder<ConversionPolicy>::trackQuantiles(
+   R(*functionPtr)(Parameters...) )
+{
+   return trackQuantiles_<column, Parameters...>( functionPtr );
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename R, class T, typename... Parameters>
+std::shared_ptr<const QuantileSketch>
+CallRecorder<ConversionPolicy>::trackQuantiles(
+   R(T::*methodPtr)(Parameters...) )
+{
+   return trackQuantiles_<column, Parameters...>( methodPtr );
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename R, class T, typename... Parameters>
+std::shared_ptr<const QuantileSketch>
+CallRecorder<ConversionPolicy>::trackQuantiles(
+   R(T::*methodPtr)(Parameters...) const )
+{
+   return trackQuantiles_<column, Parameters...>( methodPtr );
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename R, typename... Parameters>
+auto CallRecorder<ConversionPolicy>::trackAggregates(
+   R(*functionPtr)(Parameters...) )
+{
+   return trackAggregates_<column, Parameters...>( functionPtr );
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename R, class T, typename... Parameters>
+auto CallRecorder<ConversionPolicy>::trackAggregates(
+   R(T::*methodPtr)(Parameters...) )
+{
+   return trackAggregates_<column, Parameters...>( methodPtr );
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename R, class T, typename... Parameters>
+auto CallRecorder<ConversionPolicy>::trackAggregates(
+   R(T::*methodPtr)(Parameters...) const )
+{
+   return trackAggregates_<column, Parameters...>( methodPtr );
+}
+
+template<class ConversionPolicy>
+template<typename R, typename... Parameters>
+void CallRecorder<ConversionPolicy>::compressHistory(
+   R(*functionPtr)(Parameters...) )
+{
+   compressHistory_<Parameters...>( functionPtr );
+}
+
+template<class ConversionPolicy>
+template<typename R, class T, typename... Parameters>
+void CallRecorder<ConversionPolicy>::compressHistory(
+   R(T::*methodPtr)(Parameters...) )
+{
+   compressHistory_<Parameters...>( methodPtr );
+}
+
+template<class ConversionPolicy>
+template<typename R, class T, typename... Parameters>
+void CallRecorder<ConversionPolicy>::compressHistory(
+   R(T::*methodPtr)(Parameters...) const )
+{
+   compressHistory_<Parameters...>( methodPtr );
+}
+
+template<class ConversionPolicy>
+void CallRecorder<ConversionPolicy>::setRecordedByDefault(
+   bool recorded ) noexcept
+{
+   recordedByDefault_ = recorded;
+}
+
+template<class ConversionPolicy>
+template<typename R, typename... Parameters>
+void CallRecorder<ConversionPolicy>::setRecorded(
+   R(*functionPtr)(Parameters...),
+   bool recorded )
+{
+   methods_[ functionPtr ].recorded = recorded ? Recorded_::YES : Recorded_::NO;
+}
+
+template<class ConversionPolicy>
+template<typename R, class T, typename... Parameters>
+void CallRecorder<ConversionPolicy>::setRecorded(
+   R(T::*methodPtr)(Parameters...),
+   bool recorded )
+{
+   methods_[ methodPtr ].recorded = recorded ? Recorded_::YES : Recorded_::NO;
+}
+
+template<class ConversionPolicy>
+template<typename R, class T, typename... Parameters>
+void CallRecorder<ConversionPolicy>::setRecorded(
+   R(T::*methodPtr)(Parameters...) const,
+   bool recorded )
+{
+   methods_[ methodPtr ].recorded = recorded ? Recorded_::YES : Recorded_::NO;
+}
+
+template<class ConversionPolicy>
+template<typename R, typename... Parameters, class F>
+void CallRecorder<ConversionPolicy>::setFilter(
+   R(*functionPtr)(Parameters...),
+   F predicate )
+{
+   methods_[ functionPtr ].filter.reset(
+      new ArgumentFilter<Parameters...>( std::move( predicate ) ) );
+}
+
+template<class ConversionPolicy>
+template<typename R, class T, typename... Parameters, class F>
+void CallRecorder<ConversionPolicy>::setFilter(
+   R(T::*methodPtr)(Parameters...),
+   F predicate )
+{
+   methods_[ methodPtr ].filter.reset(
+      new ArgumentFilter<Parameters...>( std::move( predicate ) ) );
+}
+
+template<class ConversionPolicy>
+template<typename R, class T, typename... Parameters, class F>
+void CallRecorder<ConversionPolicy>::setFilter(
+   R(T::*methodPtr)(Parameters...) const,
+   F predicate )
+{
+   methods_[ methodPtr ].filter.reset(
+      new ArgumentFilter<Parameters...>( std::move( predicate ) ) );
+}
+
+template<class ConversionPolicy>
+void CallRecorder<ConversionPolicy>::setAggregateOnly(
+   bool aggregateOnly ) noexcept
+{
+   aggregateOnly_ = aggregateOnly;
+}
+
+template<class ConversionPolicy>
+void CallRecorder<ConversionPolicy>::setAsynchronous( bool asynchronous )
+{
+   if( asynchronous == static_cast<bool>( callQueue_ ) )
+      return;
+
+   if( asynchronous )
    {
-      // We must first make sure the type is the same. We use reinterpret_cast
-      // below and [C++14, §5.2.10/10 Reinterpret cast] says that converting
-      // the void pointers back to the types they were once created from shall
-      // yield their original pointers.
-      if( std::get<std::type_index>( call ) != typeIndex )
-         continue;
+      callQueue_.reset( new CallQueue<PendingCall_>() );
+   }
+   else
+   {
+      const std::lock_guard<std::recursive_mutex> lock( recordMutex_ );
 
-      // Either we search for a function or an object/method combination.
-      if( functionPtr )
-      {
-         if( reinterpret_cast<FunctionPtr>( std::get<void(*)()>( call ) ) !=
-            functionPtr )
-               continue;
-      }
-      else
-      {
-         // Object ID as search criteria.
-         if( objectID && std::get<FiniteID>( call ) != objectID )
-            continue;
-
-         // Method pointer as search criteria.
-         // WARNING! The != comparison is unspecified by the standard, see
-         // [C++14, §5.10/3 Equality operators]. It works on many compilers
-         // though and hopefully it will be specified in the future.
-         if( methodPtr && reinterpret_cast<MethodPtr>(
-            std::get<void(VoidType_::*)()>( call ) ) != methodPtr )
-               continue;
-      }
+      drain_().unlock();
+      callQueue_.reset();
+   }
+}
+
+template<class ConversionPolicy>
+template<typename R, typename... Parameters>
+std::size_t CallRecorder<ConversionPolicy>::count(
+   R(*functionPtr)(Parameters...) ) const
+{
+   return count_( functionPtr );
+}
+
+template<class ConversionPolicy>
+template<typename R, class T, typename... Parameters>
+std::size_t CallRecorder<ConversionPolicy>::count(
+   R(T::*methodPtr)(Parameters...) ) const
+{
+   return count_( methodPtr );
+}
+
+template<class ConversionPolicy>
+template<typename R, class T, typename... Parameters>
+std::size_t CallRecorder<ConversionPolicy>::count(
+   R(T::*methodPtr)(Parameters...) const ) const
+{
+   return count_( methodPtr );
+}
+
+template<class ConversionPolicy>
+template<class F, typename R, typename... Parameters>
+void CallRecorder<ConversionPolicy>::observe(
+   R(*functionPtr)(Parameters...),
+   F observer,
+   ObserverDelivery delivery )
+{
+   observe_<Parameters...>( functionPtr, std::move( observer ), delivery );
+}
+
+template<class ConversionPolicy>
+template<class F, typename R, class T, typename... Parameters>
+void CallRecorder<ConversionPolicy>::observe(
+   R(T::*methodPtr)(Parameters...),
+   F observer,
+   ObserverDelivery delivery )
+{
+   observe_<Parameters...>( methodPtr, std::move( observer ), delivery );
+}
+
+template<class ConversionPolicy>
+template<class F, typename R, class T, typename... Parameters>
+void CallRecorder<ConversionPolicy>::observe(
+   R(T::*methodPtr)(Parameters...) const,
+   F observer,
+   ObserverDelivery delivery )
+{
+   observe_<Parameters...>( methodPtr, std::move( observer ), delivery );
+}
+
+template<class ConversionPolicy>
+void CallRecorder<ConversionPolicy>::observeAllWithoutArguments(
+   std::function<void(const std::type_index&, const FiniteID&)> observer,
+   ObserverDelivery delivery )
+{
+   if( delivery == ObserverDelivery::INLINE )
+   {
+      observers_.push_back( std::move( observer ) );
+      return;
+   }
+
+   auto& observerQueue = startObserverQueue_();
+   observers_.emplace_back( [&observerQueue, observer](
+      const std::type_index& typeIndex,
+      const FiniteID& objectID )
+   {
+      observerQueue.push( [observer, typeIndex, objectID]()
+      {
+         observer( typeIndex, objectID );
+      } );
+   } );
+}
+
+template<class ConversionPolicy>
+void CallRecorder<ConversionPolicy>::flushObservers()
+{
+   if( observerQueue_ )
+      observerQueue_->flush();
+
+   std::exception_ptr error;
+   {
+      std::lock_guard<std::mutex> lock( observerErrors_->mutex );
+
+      error = observerErrors_->first;
+      observerErrors_->first = nullptr;
+   }
+
+   if( error )
+      std::rethrow_exception( error );
+}
+
+template<class ConversionPolicy>
+void CallRecorder<ConversionPolicy>::setObserverErrorHandler(
+   std::function<void(std::exception_ptr)> errorHandler )
+{
+   std::lock_guard<std::mutex> lock( observerErrors_->mutex );
+
+   observerErrors_->handler = std::move( errorHandler );
+}
+
+template<class ConversionPolicy>
+template<class CallPtr>
+void CallRecorder<ConversionPolicy>::expectCalls(
+   CallPtr callPtr,
+   std::size_t count )
+{
+   Expectations* expectations = expectations_.get();
+   const std::size_t expectation = expectations->addCallCount( count );
+
+   methods_[ callPtr ].hooks.emplace_back(
+      [expectations, expectation]( const ArgumentTupleI& )
+      {
+         expectations->call( expectation );
+      } );
+}
+
+template<class ConversionPolicy>
+template<class FirstPtr, class SecondPtr>
+void CallRecorder<ConversionPolicy>::expectOrder(
+   FirstPtr firstPtr,
+   SecondPtr secondPtr )
+{
+   Expectations* expectations = expectations_.get();
+   const std::size_t expectation = expectations->addOrder();
+
+   methods_[ firstPtr ].hooks.emplace_back(
+      [expectations, expectation]( const ArgumentTupleI& )
+      {
+         expectations->first( expectation );
+      } );
+   methods_[ secondPtr ].hooks.emplace_back(
+      [expectations, expectation]( const ArgumentTupleI& )
+      {
+         expectations->second( expectation );
+      } );
+}
+
+template<class ConversionPolicy>
+template<class CallPtr, class MarkerPtr>
+void CallRecorder<ConversionPolicy>::expectAtMostBetween(
+   CallPtr callPtr,
+   std::size_t count,
+   MarkerPtr markerPtr )
+{
+   Expectations* expectations = expectations_.get();
+   const std::size_t expectation = expectations->addWindow( count );
+
+   methods_[ callPtr ].hooks.emplace_back(
+      [expectations, expectation]( const ArgumentTupleI& )
+      {
+         expectations->call( expectation );
+      } );
+   methods_[ markerPtr ].hooks.emplace_back(
+      [expectations, expectation]( const ArgumentTupleI& )
+      {
+         expectations->marker( expectation );
+      } );
+}
+
+template<class ConversionPolicy>
+template<class F, typename R, typename... Parameters>
+void CallRecorder<ConversionPolicy>::expectNever(
+   R(*functionPtr)(Parameters...),
+   F predicate )
+{
+   expectNever_<Parameters...>( functionPtr, std::move( predicate ) );
+}
+
+template<class ConversionPolicy>
+template<class F, typename R, class T, typename... Parameters>
+void CallRecorder<ConversionPolicy>::expectNever(
+   R(T::*methodPtr)(Parameters...),
+   F predicate )
+{
+   expectNever_<Parameters...>( methodPtr, std::move( predicate ) );
+}
+
+template<class ConversionPolicy>
+template<class F, typename R, class T, typename... Parameters>
+void CallRecorder<ConversionPolicy>::expectNever(
+   R(T::*methodPtr)(Parameters...) const,
+   F predicate )
+{
+   expectNever_<Parameters...>( methodPtr, std::move( predicate ) );
+}
+
+template<class ConversionPolicy>
+void CallRecorder<ConversionPolicy>::setViolationHandler(
+   std::function<void(const std::string&)> violationHandler )
+{
+   expectations_->setViolationHandler( std::move( violationHandler ) );
+}
+
+template<class ConversionPolicy>
+void CallRecorder<ConversionPolicy>::verifyExpectations() const
+{
+   expectations_->verify();
+}
+
+template<class ConversionPolicy>
+template<
+   typename... TupleParameters,
+   class TypeIndex,
+   class FunctionPtr,
+   class MethodPtr,
+   typename... Parameters>
+void CallRecorder<ConversionPolicy>::record_(
+   TypeIndex&& typeIndex,
+   FunctionPtr functionPtr,
+   const FiniteID& objectID,
+   MethodPtr methodPtr,
+   Parameters&&... arguments )
+{
+   using ArgumentTupleT =
+      ArgumentTuple<StorageT<ConversionPolicy, TupleParameters>...>;
+
+   const MethodKey methodKey( typeIndex, functionPtr, methodPtr );
+
+   // Calls are recorded one at a time, apart from plain calls in asynchronous
+   // mode converted by a policy without state. Those are queued lock free.
+   std::unique_lock<std::recursive_mutex> lock( recordMutex_, std::defer_lock );
+   if( !callQueue_ ||
+      aggregateOnly_ ||
+      !observers_.empty() ||
+      !std::is_empty<ConversionPolicy>::value )
+         lock.lock();
+
+   // We skip the lookup altogether as long as nothing is set for any function
+   // or method. The state of the functions and methods is only added to while
+   // recording in aggregate only mode, when the lock is always taken.
+   MethodState_* method = nullptr;
+   if( !methods_.empty() )
+   {
+      auto found = methods_.find( methodKey );
+      if( found != methods_.end() )
+         method = &found->second;
+   }
+
+   if( method && !lock.owns_lock() )
+      lock.lock();
+
+   // Calls that aren't selected are dropped before the arguments are converted.
+   const Recorded_ recorded = method ? method->recorded : Recorded_::BY_DEFAULT;
+   if( recorded == Recorded_::NO ||
+      ( recorded == Recorded_::BY_DEFAULT && !recordedByDefault_ ) )
+         return;
+
+   if( method && method->filter )
+   {
+      auto& filter =
+         static_cast<ArgumentFilter<TupleParameters...>&>( *method->filter );
+
+      if( !filter.predicate( arguments... ) )
+         return;
+   }
+
+   for( auto& observer : observers_ )
+      observer( typeIndex, objectID );
+
+   // The state of the function or method is always there in aggregate only
+   // mode, where it counts the calls.
+   if( aggregateOnly_ )
+   {
+      if( !method )
+         method = &methods_[ methodKey ];
+
+      method->aggregatedCalls++;
+   }
+
+   // Calls not kept in the call history are converted into a tuple on the
+   // stack, and only if there is something to see them. Like everywhere
+   // below, the call is stored before the hooks see it, so a hook reporting
+   // a violation by throwing doesn't keep the call out of the history.
+   if( aggregateOnly_ || ( method && method->compressedHistory ) )
+   {
+      if( !aggregateOnly_ || !method->hooks.empty() )
+      {
+         const ArgumentTupleT argumentTuple(
+            this->convert( std::forward<Parameters>( arguments ) )... );
+
+         if( !aggregateOnly_ )
+         {
+            method->compress(
+               *method->compressedHistory, objectID, argumentTuple );
+         }
+
+         for( auto& hook : method->hooks )
+            hook( argumentTuple );
+      }
+
+      return;
+   }
+
+   // Projected calls only convert and keep the arguments in the projected
+   // columns. The arguments are handed over as pointers to the parameter types
+   // of the function, so projected arguments of other types are constructed as
+   // such first. The hooks still get to see all arguments, converted
+   // afterwards.
+   if( method && method->project )
+   {
+      projectCall_<TupleParameters...>(
+         *method,
+         objectID,
+         std::index_sequence_for<Parameters...>(),
+         arguments... );
+      method->projectedCalls++;
+
+      if( !method->hooks.empty() )
+      {
+         const ArgumentTupleT argumentTuple(
+            this->convert( std::forward<Parameters>( arguments ) )... );
+
+         for( auto& hook : method->hooks )
+            hook( argumentTuple );
+      }
+
+      return;
+   }
+
+   // (1) We can't use std::make_unique here since we're using an interface.
+   // (2) Deduce the tuple storage type by means of the conversion policy. The
+   //     deduction uses the parameter types in the function that is recorded,
+   //     not the actual arguments that could be temporaries passed in.
+   std::unique_ptr<ArgumentTupleI> argumentTuple(   // (1)
+      new ArgumentTupleT(   // (2)
+         this->convert( std::forward<Parameters>( arguments ) )... ) );
+
+   // Let the hooks attached to the function or method see the call once it's
+   // appended. The tuple stays where it is when the history grows, or when
+   // an asynchronous call is moved on from the queue.
+   const ArgumentTupleI& appendedTuple = *argumentTuple;
+
+   append_( CallKey_( methodKey, objectID ), std::move( argumentTuple ) );
+
+   if( method )
+   {
+      for( auto& hook : method->hooks )
+         hook( appendedTuple );
+   }
+}
+
+template<class ConversionPolicy>
+void CallRecorder<ConversionPolicy>::append_(
+   CallKey_&& callKey,
+   std::unique_ptr<ArgumentTupleI>&& argumentTuple )
+{
+   // The keys of asynchronous calls are interned when they're drained, so that
+   // only one thread at a time touches the keys.
+   if( callQueue_ )
+   {
+      callQueue_->push(
+         PendingCall_( std::move( callKey ), std::move( argumentTuple ) ) );
+   }
+   else
+   {
+      callHistory_.emplace_back(
+         intern_( std::move( callKey ) ), std::move( argumentTuple ) );
+   }
+}
+
+template<class ConversionPolicy>
+std::uint32_t CallRecorder<ConversionPolicy>::intern_(
+   CallKey_&& callKey ) const
+{
+   auto found = callKeyIndices_.find( callKey );
+   if( found != callKeyIndices_.end() )
+      return found->second;
+
+   assert( callKeys_.size() < UINT32_MAX );
+
+   const auto index = static_cast<std::uint32_t>( callKeys_.size() );
+   callKeys_.push_back( callKey );
+   callKeyIndices_.emplace( std::move( callKey ), index );
+
+   return index;
+}
+
+template<class ConversionPolicy>
+std::unique_lock<std::mutex> CallRecorder<ConversionPolicy>::drain_() const
+{
+   if( !callQueue_ )
+      return std::unique_lock<std::mutex>();
+
+   std::vector<PendingCall_> pendingCalls;
+   auto lock = callQueue_->drain( pendingCalls );
+
+   callHistory_.reserve( callHistory_.size() + pendingCalls.size() );
+   for( auto& pendingCall : pendingCalls )
+   {
+      callHistory_.emplace_back(
+         intern_( std::move( pendingCall.first ) ),
+         std::move( pendingCall.second ) );
+   }
+
+   return lock;
+}
+
+template<class ConversionPolicy>
+std::vector<char> CallRecorder<ConversionPolicy>::matchingKeys_(
+   const MethodKey& methodKey,
+   const FiniteID& objectID ) const
+{
+   // An uninitialized object identifier matches all objects.
+   std::vector<char> matches( callKeys_.size() );
+   for( std::size_t i = 0; i < callKeys_.size(); i++ )
+   {
+      matches[ i ] = callKeys_[ i ].methodKey == methodKey &&
+         ( !objectID || callKeys_[ i ].objectID == objectID );
+   }
+
+   return matches;
+}
+
+template<class ConversionPolicy>
+bool CallRecorder<ConversionPolicy>::CallKey_::operator==(
+   const CallKey_& other ) const noexcept
+{
+   return methodKey == other.methodKey && objectID == other.objectID;
+}
+
+template<class ConversionPolicy>
+std::size_t CallRecorder<ConversionPolicy>::CallKeyHash_::operator()(
+   const CallKey_& callKey ) const noexcept
+{
+   return hashCombine(
+      callKey.methodKey.hash(), std::hash<FiniteID>()( callKey.objectID ) );
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename... Parameters>
+std::shared_ptr<const HyperLogLog>
+CallRecorder<ConversionPolicy>::trackDistinct_( const MethodKey& methodKey )
+{
+   using ArgumentTupleT =
+      ArgumentTuple<StorageT<ConversionPolicy, Parameters>...>;
+
+   auto sketch = std::make_shared<HyperLogLog>();
+
+   methods_[ methodKey ].hooks.emplace_back(
+      [sketch]( const ArgumentTupleI& argumentTuple )
+      {
+         sketch->add( std::get<column>(
+            static_cast<const ArgumentTupleT&>( argumentTuple ).tuple ) );
+      } );
+
+   return sketch;
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename... Parameters>
+std::shared_ptr<const QuantileSketch>
+CallRecorder<ConversionPolicy>::trackQuantiles_( const MethodKey& methodKey )
+{
+   using ArgumentTupleT =
+      ArgumentTuple<StorageT<ConversionPolicy, Parameters>...>;
+
+   using ColumnT =
+      std::tuple_element_t<column, decltype( ArgumentTupleT::tuple )>;
+
+   static_assert(
+      std::is_arithmetic<ColumnT>::value,
+      "Quantiles can only be tracked for arithmetic arguments" );
+
+   auto sketch = std::make_shared<QuantileSketch>();
+
+   methods_[ methodKey ].hooks.emplace_back(
+      [sketch]( const ArgumentTupleI& argumentTuple )
+      {
+         sketch->add( static_cast<double>( std::get<column>(
+            static_cast<const ArgumentTupleT&>( argumentTuple ).tuple ) ) );
+      } );
+
+   return sketch;
+}
+
+template<class ConversionPolicy>
+template<std::size_t column, typename... Parameters>
+auto CallRecorder<ConversionPolicy>::trackAggregates_(
+   const MethodKey& methodKey )
+{
+   using ArgumentTupleT =
+      ArgumentTuple<StorageT<ConversionPolicy, Parameters>...>;
+
+   using ColumnT =
+      std::tuple_element_t<column, decltype( ArgumentTupleT::tuple )>;
+
+   auto aggregates = std::make_shared<RunningAggregates<ColumnT>>();
+
+   methods_[ methodKey ].hooks.emplace_back(
+      [aggregates]( const ArgumentTupleI& argumentTuple )
+      {
+         aggregates->add( std::get<column>(
+            static_cast<const ArgumentTupleT&>( argumentTuple ).tuple ) );
+      } );
+
+   return std::shared_ptr<const RunningAggregates<ColumnT>>(
+      std::move( aggregates ) );
+}
+
+template<class ConversionPolicy>
+std::size_t CallRecorder<ConversionPolicy>::count_(
+   const MethodKey& methodKey ) const
+{
+   const std::lock_guard<std::recursive_mutex> recordLock( recordMutex_ );
+   const auto lock = drain_();
+
+   std::size_t callCount = 0;
+
+   auto method = methods_.find( methodKey );
+   if( method != methods_.end() )
+   {
+      callCount =
+         method->second.aggregatedCalls + method->second.projectedCalls;
+      if( method->second.compressedHistory )
+         callCount += method->second.compressedHistory->size();
+   }
+
+   const std::vector<char> matches = matchingKeys_( methodKey, FiniteID() );
+   for( auto& call : callHistory_ )
+   {
+      if( matches[ call.first ] )
+         callCount++;
+   }
+
+   return callCount;
+}
+
+template<class ConversionPolicy>
+template<typename... Parameters, class F>
+void CallRecorder<ConversionPolicy>::observe_(
+   const MethodKey& methodKey,
+   F observer,
+   ObserverDelivery delivery )
+{
+   using ArgumentTupleT =
+      ArgumentTuple<StorageT<ConversionPolicy, Parameters>...>;
+
+   using TupleT = decltype( ArgumentTupleT::tuple );
+
+   auto& method = methods_[ methodKey ];
+
+   if( delivery == ObserverDelivery::INLINE )
+   {
+      method.hooks.emplace_back(
+         [observer]( const ArgumentTupleI& argumentTuple ) mutable
+         {
+            applyTuple(
+               observer,
+               static_cast<const ArgumentTupleT&>( argumentTuple ).tuple,
+               std::index_sequence_for<Parameters...>() );
+         } );
+
+      return;
+   }
+
+   // The queued observers get a copy of the arguments, since the call may be
+   // gone from the history, or never kept there, by the time they are called.
+   auto& observerQueue = startObserverQueue_();
+   method.hooks.emplace_back(
+      [&observerQueue, observer]( const ArgumentTupleI& argumentTuple )
+      {
+         observerQueue.push(
+            [observer, tuple = TupleT(
+               static_cast<const ArgumentTupleT&>( argumentTuple ).tuple )]()
+               mutable
+            {
+               applyTuple(
+                  observer, tuple, std::index_sequence_for<Parameters...>() );
+            } );
+      } );
+}
+
+template<class ConversionPolicy>
+template<typename... Parameters, class F>
+void CallRecorder<ConversionPolicy>::expectNever_(
+   const MethodKey& methodKey,
+   F predicate )
+{
+   using ArgumentTupleT =
+      ArgumentTuple<StorageT<ConversionPolicy, Parameters>...>;
+
+   Expectations* expectations = expectations_.get();
+   const std::size_t expectation = expectations->addNever();
+
+   methods_[ methodKey ].hooks.emplace_back(
+      [expectations, expectation, predicate](
+         const ArgumentTupleI& argumentTuple ) mutable
+      {
+         if( applyTuple(
+               predicate,
+               static_cast<const ArgumentTupleT&>( argumentTuple ).tuple,
+               std::index_sequence_for<Parameters...>() ) )
+            expectations->violate( expectation );
+      } );
+}
+
+template<class ConversionPolicy>
+CallQueue<std::function<void()>>&
+CallRecorder<ConversionPolicy>::startObserverQueue_()
+{
+   if( !observerQueue_ )
+   {
+      // An exception can't leave the background thread, so it's reported to
+      // the handler, or kept for flushObservers.
+      ObserverErrors_* errors = observerErrors_.get();
+      observerQueue_.reset( new CallQueue<std::function<void()>>(
+         [errors]( std::function<void()>& delivery )
+         {
+            try
+            {
+               delivery();
+            }
+            catch( ... )
+            {
+               std::unique_lock<std::mutex> lock( errors->mutex );
+
+               if( !errors->handler )
+               {
+                  if( !errors->first )
+                     errors->first = std::current_exception();
+
+                  return;
+               }
+
+               const auto handler = errors->handler;
+               lock.unlock();
+               handler( std::current_exception() );
+            }
+         } ) );
+   }
+
+   return *observerQueue_;
+}
+
+template<class ConversionPolicy>
+template<typename... Parameters>
+void CallRecorder<ConversionPolicy>::compressHistory_(
+   const MethodKey& methodKey )
+{
+   using ArgumentTupleT =
+      ArgumentTuple<StorageT<ConversionPolicy, Parameters>...>;
+
+   static_assert(
+      AreIntegers<StorageT<ConversionPolicy, Parameters>...>::value,
+      "Only calls with integer arguments can be compressed" );
+
+   assert( count_( methodKey ) == 0 );
+
+   auto& method = methods_[ methodKey ];
+   if( method.compressedHistory )
+      return;
+
+   method.compressedHistory.reset(
+      new CompressedHistory( sizeof...( Parameters ) ) );
+   method.compress = [](
+      CompressedHistory& compressedHistory,
+      const FiniteID& objectID,
+      const ArgumentTupleI& argumentTuple )
+   {
+      std::int64_t values[ sizeof...( Parameters ) + 1 ];
+      widenTuple(
+         static_cast<const ArgumentTupleT&>( argumentTuple ).tuple,
+         values,
+         std::index_sequence_for<Parameters...>() );
+
+      compressedHistory.append( objectID, values );
+   };
+}
+
+template<class ConversionPolicy>
+template<
+   typename... Parameters,
+   class FunctionPtr,
+   class MethodPtr,
+   std::size_t... columns>
+void CallRecorder<ConversionPolicy>::project_(
+   const MethodKey& methodKey,
+   const std::type_index& typeIndex,
+   FunctionPtr functionPtr,
+   MethodPtr methodPtr,
+   std::index_sequence<columns...> )
+{
+   using ParametersT = std::tuple<Parameters...>;
+
+   using ArgumentTupleT = ArgumentTuple<StorageT<
+      ConversionPolicy, RawArgumentRefT<columns, ParametersT>>...>;
+
+   const MethodKey projectionKey( typeIndex, functionPtr, methodPtr );
+
+   static_assert(
+      sizeof...( Parameters ) <= 64,
+      "At most 64 parameters can be projected" );
+
+   auto& method = methods_[ methodKey ];
+
+   method.projectedColumns = 0;
+   for( std::size_t column : { columns... } )
+      method.projectedColumns |= std::uint64_t( 1 ) << column;
+
+   method.project = [projectionKey](
+      CallRecorder& recorder,
+      const FiniteID& objectID,
+      const void* const* rawArguments )
+   {
+      recorder.append_(
+         CallKey_( projectionKey, objectID ),
+         std::unique_ptr<ArgumentTupleI>( new ArgumentTupleT(
+            recorder.convert(
+               *static_cast<RawArgumentPtrT<columns, ParametersT>>(
+                  rawArguments[ columns ] ) )... ) ) );
+   };
+}
+
+template<class ConversionPolicy>
+template<
+   typename... FncParameters,
+   std::size_t... I,
+   typename... Parameters>
+void CallRecorder<ConversionPolicy>::projectCall_(
+   const MethodState_& method,
+   const FiniteID& objectID,
+   std::index_sequence<I...>,
+   Parameters&... arguments )
+{
+   handOver(
+      method.project,
+      *this,
+      objectID,
+      RawArgument<FncParameters, Parameters>(
+         arguments, ( ( method.projectedColumns >> I ) & 1 ) != 0 )... );
+}
+
+template<class ConversionPolicy>
+template<typename... Parameters>
+auto CallRecorder<ConversionPolicy>::findCompressed_(
+   const CompressedHistory& compressedHistory,
+   const FiniteID& objectID,
+   std::true_type ) const
+{
+   using TupleT = std::tuple<StorageT<ConversionPolicy, Parameters>...>;
+
+   std::vector<TupleT> resultSet;
+   compressedHistory.forEach(
+      objectID,
+      [&resultSet]( const std::int64_t* values )
+      {
+         resultSet.push_back( narrowTuple<TupleT>(
+            values, std::index_sequence_for<Parameters...>() ) );
+      } );
+
+   return resultSet;
+}
+
+template<class ConversionPolicy>
+template<typename... Parameters>
+auto CallRecorder<ConversionPolicy>::findCompressed_(
+   const CompressedHistory& compressedHistory,
+   const FiniteID& objectID,
+   std::false_type ) const
+{
+   // Only calls with integer arguments can be compressed, so we never get here.
+   assert( false );
+
+   return std::vector<std::tuple<StorageT<ConversionPolicy, Parameters>...>>();
+}
+
+template<class ConversionPolicy>
+template<typename... Parameters, class FunctionPtr, class MethodPtr>
+auto CallRecorder<ConversionPolicy>::find_(
+   const std::type_index& typeIndex,
+   FunctionPtr functionPtr,
+   const FiniteID& objectID,
+   MethodPtr methodPtr ) const
+{
+   const std::lock_guard<std::recursive_mutex> recordLock( recordMutex_ );
+
+   if( !methods_.empty() )
+   {
+      auto method =
+         methods_.find( MethodKey( typeIndex, functionPtr, methodPtr ) );
+
+      if( method != methods_.end() && method->second.compressedHistory )
+      {
+         return findCompressed_<Parameters...>(
+            *method->second.compressedHistory,
+            objectID,
+            AreIntegers<StorageT<ConversionPolicy, Parameters>...>() );
+      }
+   }
+
+   // The background thread is kept out while the call history is searched.
+   const auto lock = drain_();
+
+   // The keys are matched once, and then each call in the history by its key
+   // index only.
+   const std::vector<char> matches = matchingKeys_(
+      MethodKey( typeIndex, functionPtr, methodPtr ), objectID );
+
+   const std::size_t historySize = callHistory_.size();
+   const std::size_t chunkCount =
+      threadPool_ ? threadPool_->chunkCount( historySize ) : 1;
+
+   if( chunkCount == 1 )
+   {
+      return findChunk_<Parameters...>( matches, 0, historySize );
+   }
+
+   // Each chunk is searched separately and the partial results are then
+   // concatenated in chunk order to keep the order they were recorded in.
+   using ResultSetT =
+      std::vector<std::tuple<StorageT<ConversionPolicy, Parameters>...>>;
+
+   std::vector<ResultSetT> chunkResults( chunkCount );
+   threadPool_->parallelFor( chunkCount, [&]( std::size_t chunk )
+   {
+      chunkResults[ chunk ] = findChunk_<Parameters...>(
+         matches,
+         historySize * chunk / chunkCount,
+         historySize * ( chunk + 1 ) / chunkCount );
+   } );
+
+   std::size_t resultSize = 0;
+   for( auto& chunkResult : chunkResults )
+      resultSize += chunkResult.size();
+
+   ResultSetT resultSet;
+   resultSet.reserve( resultSize );
+   for( auto& chunkResult : chunkResults )
+   {
+      std::move(
+         chunkResult.begin(),
+         chunkResult.end(),
+         std::back_inserter( resultSet ) );
+   }
+
+   return resultSet;
+}
+
+template<class ConversionPolicy>
+template<typename... Parameters>
+auto CallRecorder<ConversionPolicy>::findChunk_(
+   const std::vector<char>& matches,
+   std::size_t first,
+   std::size_t last ) const
+{
+   std::vector<std::tuple<StorageT<ConversionPolicy, Parameters>...>> resultSet;
+
+   for( std::size_t i = first; i < last; i++ )
+   {
+      auto& call = callHistory_[ i ];
+
+      // The matching keys have the same type index as the one searched for,
+      // i.e. the same function or method signature.
+      if( !matches[ call.first ] )
+         continue;
 
       // We cast the stored pointer to the correct tuple of arguments, since
       // what went in with a certain function pointer key should come out using
       // the same key.
       auto tuplePtr = static_cast<ArgumentTuple<
-         StorageT<ConversionPolicy, Parameters>...>*>(
-            std::get<std::unique_ptr<ArgumentTupleI>>( call ).get() );
+         StorageT<ConversionPolicy, Parameters>...>*>( call.second.get() );
 
       // The cast should never fail but we check the invariant just in case.
       // Remove or replace with your favorite assert function.
 #ifndef NDEBUG
       auto dynamicTuplePtr = dynamic_cast<ArgumentTuple<
-         StorageT<ConversionPolicy, Parameters>...>*>(
-            std::get<std::unique_ptr<ArgumentTupleI>>( call ).get() );
+         StorageT<ConversionPolicy, Parameters>...>*>( call.second.get() );
       assert( dynamicTuplePtr == tuplePtr );
 #endif
 
@@ -0,0 +1,115 @@
+/*
+
+   Capacity.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "unimock/LatencyHistogram.hh"
+
+
+namespace unimock
+{
+
+/// Capacity of a mocked method emulating a bounded capacity server.
+///
+/// A call to a method with a capacity is served by one of a number of
+/// servers. When all servers are busy the call waits in a queue, unless the
+/// queue is full, in which case the call is rejected. A call that has waited
+/// for the timeout times out. Both throw CapacityExceeded to the caller. A
+/// served call occupies its server for a service time before it goes on to
+/// the override or stub, and until the override or stub has returned.
+///
+/// #### Example ####
+/// ~~~
+/// std::mt19937 engine;
+/// std::exponential_distribution<> distribution( 1.0 / 200 );
+///
+/// Capacity capacity;
+/// capacity.servers = 4;
+/// capacity.queueDepth = 16;
+/// capacity.timeout = std::chrono::milliseconds( 50 );
+/// capacity.serviceTime = [&]()
+/// {
+///    return std::chrono::microseconds(
+///       static_cast<long>( distribution( engine ) ) );
+/// };
+/// ~~~
+///
+struct Capacity
+{
+   /// Constructor.
+   ///
+   /// Constructs the capacity of a single server with an unbounded queue, no
+   /// timeout and no service time.
+   ///
+   /// \exception Exception neutral.
+   ///
+   Capacity();
+
+   /// The number of calls served at once, at least one.
+   std::size_t servers;
+
+   /// The number of calls that may wait for a server.
+   std::size_t queueDepth;
+
+   /// How long a call may wait for a server.
+   std::chrono::nanoseconds timeout;
+
+   /// Draws the service time of a call, empty for no service time. It's
+   /// called under a lock, one call at a time.
+   std::function<std::chrono::nanoseconds()> serviceTime;
+
+};
+
+/// Statistics of a mocked method with a capacity.
+///
+struct CapacityStatistics
+{
+   /// Constructor.
+   ///
+   /// Constructs empty statistics.
+   ///
+   /// \exception Exception neutral.
+   ///
+   CapacityStatistics();
+
+   /// The number of calls served.
+   std::size_t served;
+
+   /// The number of calls rejected due to a full queue.
+   std::size_t rejected;
+
+   /// The number of calls that timed out waiting for a server.
+   std::size_t timedOut;
+
+   /// The queueing delays of the served calls, in nanoseconds.
+   LatencyHistogram queueingDelay;
+
+   /// The queueing delays of the recorded calls, in the order they were
+   /// recorded, so they line up with the calls found by the mock. Recorded
+   /// calls that weren't served, since they were answered by a response,
+   /// rejected or timed out, have the delay std::chrono::nanoseconds::min().
+   std::vector<std::chrono::nanoseconds> queueingDelays;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "Capacity.icc"
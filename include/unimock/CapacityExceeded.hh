@@ -0,0 +1,66 @@
+/*
+
+   CapacityExceeded.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <stdexcept>    // std::runtime_error
+#include <string>
+
+
+namespace unimock
+{
+
+/// Exception thrown when a call exceeds the Capacity of a mocked method.
+///
+/// The call is either rejected since the queue of waiting calls is full, or
+/// it timed out waiting for a server. The exception is thrown to the code
+/// under test, like the error of a saturated dependency would be.
+///
+class CapacityExceeded : public std::runtime_error
+{
+public:
+
+   /// Why the capacity was exceeded.
+   enum class Reason { REJECTED, TIMED_OUT };
+
+   /// Constructor.
+   ///
+   /// \param[in] reason
+   ///   Why the capacity was exceeded.
+   ///
+   /// \exception Exception neutral.
+   ///
+   explicit CapacityExceeded( Reason reason );
+
+   /// Gets why the capacity was exceeded.
+   ///
+   /// \returns
+   ///   Why the capacity was exceeded.
+   ///
+   /// \exception No-throw.
+   ///
+   Reason getReason() const noexcept;
+
+
+private:
+
+   Reason reason_;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "CapacityExceeded.icc"
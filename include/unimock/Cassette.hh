@@ -0,0 +1,195 @@
+/*
+
+   Cassette.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+#include "StringView.hh"
+
+
+namespace unimock
+{
+
+/// Cassette of recorded stub responses.
+///
+/// A cassette lets a Mock forward to a slow real implementation once, and
+/// serve the recorded responses in later runs without constructing it. In
+/// record mode, the mock calls its stub as usual and writes the arguments of
+/// each call together with the return value and the values of the out
+/// parameters to the cassette file. In replay mode, the file is memory mapped
+/// and indexed when the cassette is constructed, and calls with recorded
+/// arguments are answered from it without calling the stub.
+///
+/// Only calls to methods taking and returning serializable types are put on
+/// a cassette. These are the arithmetic and enumeration types, std::string,
+/// and std::vector of those. String pointers are serialized as the string they
+/// point to but only as input. Non-const lvalue reference parameters are
+/// treated as out parameters; their values are taken after the call and are
+/// not part of the arguments a response is looked up by. Calls to other
+/// methods go to the stub as usual.
+///
+/// A method is identified on the cassette by its type and the value of the
+/// method pointer, which for a virtual method is an offset into the virtual
+/// table on common ABIs. Values are stored in the native byte order. A
+/// cassette is thus only meant to be replayed by the same build of the tests
+/// on the same platform, or at least one where the mocked interface is left
+/// unchanged.
+///
+/// #### Example ####
+/// ~~~
+/// // First run with the real store:
+/// auto cassette =
+///    std::make_shared<Cassette>( "store.cassette", Cassette::Mode::RECORD );
+/// StoreMock mock( std::make_shared<DiskStore>( "fixture" ) );
+/// mock.setCassette( cassette );
+///
+/// // Later runs without it:
+/// auto cassette =
+///    std::make_shared<Cassette>( "store.cassette", Cassette::Mode::REPLAY );
+/// StoreMock mock;
+/// mock.setCassette( cassette );
+/// ~~~
+///
+class Cassette final
+{
+public:
+
+   enum class Mode
+   {
+      RECORD,
+      REPLAY
+   };
+
+   /// Constructor.
+   ///
+   /// In record mode, the cassette file is created or truncated. In replay
+   /// mode, the cassette file is memory mapped where supported, or else read
+   /// into memory, and the recorded calls are indexed. When a call has been
+   /// recorded more than once, the first response is kept.
+   ///
+   /// \param[in] path
+   ///   The path of the cassette file.
+   ///
+   /// \param[in] mode
+   ///   Whether to record or to replay.
+   ///
+   /// \exception std::runtime_error
+   ///   The file can't be opened, or isn't a valid cassette.
+   ///
+   Cassette( const std::string& path, Mode mode );
+
+   /// Destructor.
+   ///
+   /// In record mode, the cassette file is flushed and closed. In replay mode,
+   /// the file is unmapped.
+   ///
+   /// \exception No-throw.
+   ///
+   ~Cassette();
+
+   Cassette( const Cassette& ) = delete;
+   Cassette& operator=( const Cassette& ) = delete;
+
+   /// Gets the mode of the cassette.
+   ///
+   /// \returns
+   ///   Whether the cassette records or replays.
+   ///
+   /// \exception No-throw.
+   ///
+   Mode mode() const noexcept;
+
+   /// Gets the number of calls on the cassette.
+   ///
+   /// \returns
+   ///   The number of calls recorded so far in record mode, or the number of
+   ///   distinct calls indexed in replay mode.
+   ///
+   /// \exception No-throw.
+   ///
+   std::size_t size() const noexcept;
+
+   /// Records a call.
+   ///
+   /// This method is called by the mock and is thread safe. It may only be
+   /// called in record mode.
+   ///
+   /// \param[in] key
+   ///   The serialized method and arguments of the call.
+   ///
+   /// \param[in] value
+   ///   The serialized return value and out parameters of the call.
+   ///
+   /// \exception std::runtime_error
+   ///   The call can't be written to the file.
+   ///
+   void record( const std::string& key, const std::string& value );
+
+   /// Finds a recorded call.
+   ///
+   /// This method is called by the mock. It may only be called in replay mode.
+   ///
+   /// \param[in] key
+   ///   The serialized method and arguments of the call.
+   ///
+   /// \param[out] value
+   ///   The serialized return value and out parameters of the call, referring
+   ///   into the cassette.
+   ///
+   /// \returns
+   ///   True if the call was recorded, otherwise false.
+   ///
+   /// \exception No-throw.
+   ///
+   bool find( const std::string& key, StringView& value ) const noexcept;
+
+
+private:
+
+   Mode mode_;
+
+   std::mutex mutex_;
+
+   std::ofstream file_;
+
+   std::size_t recordCount_;
+
+   const char* data_;
+
+   std::size_t dataSize_;
+
+   // Holds the file contents where it can't be memory mapped.
+   std::vector<char> buffer_;
+
+   std::unordered_map<StringView, StringView> index_;
+
+   void map_( const std::string& path );
+
+   void unmap_() noexcept;
+
+   void buildIndex_();
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "Cassette.icc"
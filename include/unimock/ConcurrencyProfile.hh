@@ -0,0 +1,71 @@
+/*
+
+   ConcurrencyProfile.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <chrono>
+#include <vector>
+
+
+namespace unimock
+{
+
+/// The number of calls in flight at a point in time.
+///
+struct ConcurrencySample
+{
+   /// The time since the tracking started.
+   std::chrono::nanoseconds time;
+
+   /// The number of calls in flight from this time on.
+   std::size_t inFlight;
+};
+
+/// ConcurrencyProfile of the calls to a mocked method or object.
+///
+/// A Mock tracking the concurrency of its methods counts the calls in flight,
+/// the calls that have entered but not yet returned. The profile tells how
+/// many calls there were, the highest number of calls in flight at once, and
+/// how the number changed over time, with a sample each time a call enters or
+/// returns.
+///
+struct ConcurrencyProfile
+{
+   /// Constructor.
+   ///
+   /// Constructs an empty profile.
+   ///
+   /// \exception Exception neutral.
+   ///
+   ConcurrencyProfile();
+
+   /// The number of calls that entered.
+   std::size_t calls;
+
+   /// The highest number of calls in flight at once.
+   std::size_t maxInFlight;
+
+   /// The number of calls in flight over time, ordered by time. The samples
+   /// are kept up to a limit set by the mock, after which the calls are
+   /// still counted but not sampled.
+   std::vector<ConcurrencySample> samples;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "ConcurrencyProfile.icc"
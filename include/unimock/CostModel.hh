@@ -0,0 +1,292 @@
+/*
+
+   CostModel.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Internal/MethodKey.hh"
+
+
+namespace unimock
+{
+
+/// The simulated latency of the calls charged to a CostModel.
+///
+struct CostReport
+{
+   /// Constructor.
+   ///
+   /// Constructs an empty report.
+   ///
+   /// \exception Exception neutral.
+   ///
+   CostReport();
+
+   /// The number of calls charged.
+   std::size_t calls;
+
+   /// The number of threads that made the calls, told apart by their ids.
+   std::size_t threads;
+
+   /// The latency if all calls ran one after another.
+   std::chrono::nanoseconds serialLatency;
+
+   /// The cost of the most costly chain of calls that follow each other, the
+   /// end-to-end latency when the calls that overlap in time run in parallel.
+   std::chrono::nanoseconds criticalPath;
+
+};
+
+/// CostModel computing the simulated latency of the calls to mocked methods.
+///
+/// Each mocked method is given a synthetic cost, a fixed latency or one drawn
+/// from a distribution per call. The mocks sharing the model charge it with
+/// the cost of every call, and the report then tells what the latency of the
+/// code under test would have been with real dependencies. The model keeps
+/// when each call was made and when it returned. A call follows another call
+/// made earlier by the same thread, including the call it's nested in, and
+/// any call that returned before it was made. Calls that overlap in time on
+/// different threads run in parallel. The critical path is the most costly
+/// chain of calls following each other, so work a thread does after joining
+/// other threads adds to the longest of them. A new round trip to a dependency
+/// thus shows up as a number to assert on, in a plain unit test.
+///
+/// #### Example ####
+/// ~~~
+/// std::mt19937 engine;
+/// std::normal_distribution<> distribution( 5000.0, 500.0 );
+///
+/// auto model = std::make_shared<CostModel>();
+/// model->setCost( &IRefrigerator::open, CostModel::fixed(
+///    std::chrono::milliseconds( 2 ) ) );
+/// model->setCost( &IRefrigerator::getTemperature, [&]
+/// {
+///    return std::chrono::microseconds(
+///       static_cast<long>( distribution( engine ) ) );
+/// } );
+///
+/// RefrigeratorMock mock( std::make_shared<RefrigeratorStub>() );
+/// mock.setCostModel( model );
+///
+/// runWorkload( mock );
+/// assert( model->getReport().criticalPath < std::chrono::milliseconds( 20 ) );
+/// ~~~
+///
+class CostModel
+{
+public:
+
+   /// The cost of a call, drawn per call.
+   using Cost = std::function<std::chrono::nanoseconds()>;
+
+   /// Charge of a call from when it's made until it returns.
+   ///
+   class Charge final
+   {
+   public:
+
+      /// Constructor.
+      ///
+      /// Charges a call to a method on the calling thread. Calls to methods
+      /// without a cost aren't charged.
+      ///
+      /// \param[in] model
+      ///   The model to charge, or nullptr to charge nothing.
+      ///
+      /// \param[in] methodKey
+      ///   The method called.
+      ///
+      /// \exception Exception neutral.
+      ///
+      Charge( CostModel* model, const MethodKey& methodKey );
+
+      /// Constructor.
+      ///
+      /// Charges a call with a cost on the calling thread.
+      ///
+      /// \param[in] model
+      ///   The model to charge, or nullptr to charge nothing.
+      ///
+      /// \param[in] cost
+      ///   The cost of the call, or an empty cost to charge nothing.
+      ///
+      /// \exception Exception neutral.
+      ///
+      Charge( CostModel* model, const Cost& cost );
+
+      /// Destructor.
+      ///
+      /// Marks the call as returned.
+      ///
+      /// \exception No-throw.
+      ///
+      ~Charge();
+
+      Charge( const Charge& ) = delete;
+      Charge& operator=( const Charge& ) = delete;
+
+
+   private:
+
+      CostModel* model_;
+
+      std::size_t call_;
+
+   };
+
+   /// Constructor.
+   ///
+   /// Constructs a model without costs or charged calls.
+   ///
+   /// \exception Exception neutral.
+   ///
+   CostModel();
+
+   CostModel( const CostModel& ) = delete;
+   CostModel& operator=( const CostModel& ) = delete;
+
+   /// Makes a fixed cost.
+   ///
+   /// \param[in] latency
+   ///   The latency of every call.
+   ///
+   /// \returns
+   ///   The cost.
+   ///
+   /// \exception Exception neutral.
+   ///
+   static Cost fixed( std::chrono::nanoseconds latency );
+
+   /// Sets the cost of a method.
+   ///
+   /// The costs are drawn one call at a time, under a lock.
+   ///
+   /// \param[in] methodPtr
+   ///   The method.
+   ///
+   /// \param[in] cost
+   ///   The cost of the method, or an empty cost to make it free.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, class T, typename... Parameters>
+   void setCost( R(T::*methodPtr)(Parameters...), Cost cost );
+
+   /// Sets the cost of a method.
+   ///
+   /// This method works the same as the other setCost method. The difference
+   /// is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method.
+   ///
+   /// \param[in] cost
+   ///   The cost of the method, or an empty cost to make it free.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, class T, typename... Parameters>
+   void setCost( R(T::*methodPtr)(Parameters...) const, Cost cost );
+
+   /// Charges a call to a method on the calling thread.
+   ///
+   /// The call is taken to return at once, see Charge for calls that take
+   /// time. Calls to methods without a cost aren't charged.
+   ///
+   /// \param[in] methodKey
+   ///   The method called.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void charge( const MethodKey& methodKey );
+
+   /// Charges a call with a cost on the calling thread.
+   ///
+   /// The call is taken to return at once.
+   ///
+   /// \param[in] cost
+   ///   The cost of the call.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void charge( const Cost& cost );
+
+   /// Gets the report of the calls charged so far.
+   ///
+   /// \returns
+   ///   The report.
+   ///
+   /// \exception Exception neutral.
+   ///
+   CostReport getReport() const;
+
+   /// Forgets the calls charged, keeping the costs.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void reset();
+
+
+private:
+
+   using Clock = std::chrono::steady_clock;
+
+   // A call charged, from when it was made until it returned, with its cost.
+   struct Call_
+   {
+      Clock::time_point start;
+
+      Clock::time_point end;
+
+      bool returned;
+
+      std::thread::id thread;
+
+      std::chrono::nanoseconds cost;
+   };
+
+   mutable std::mutex mutex_;
+
+   std::unordered_map<MethodKey, Cost, MethodKeyHash> costs_;
+
+   std::vector<Call_> calls_;
+
+   // The number of the first call in calls_, counting the calls reset.
+   std::size_t first_;
+
+   // Returns the number of the call charged, or NONE if it isn't charged.
+   std::size_t begin_( const MethodKey& methodKey );
+
+   std::size_t begin_( const Cost& cost );
+
+   std::size_t charge_( const Cost& cost );
+
+   void end_( std::size_t call ) noexcept;
+
+   static const std::size_t NONE = static_cast<std::size_t>( -1 );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "CostModel.tcc"
@@ -0,0 +1,214 @@
+/*
+
+   CostModel.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <algorithm>    // std::max, std::stable_sort
+#include <queue>        // std::priority_queue
+#include <unordered_set>
+#include <utility>      // std::move, std::pair
+
+
+namespace unimock
+{
+
+inline CostReport::CostReport()
+:
+   calls( 0 ),
+   threads( 0 ),
+   serialLatency( 0 ),
+   criticalPath( 0 )
+{
+}
+
+inline CostModel::Charge::Charge( CostModel* model, const MethodKey& methodKey )
+:
+   model_( model ),
+   call_( model ? model->begin_( methodKey ) : NONE )
+{
+}
+
+inline CostModel::Charge::Charge( CostModel* model, const Cost& cost )
+:
+   model_( model ),
+   call_( model ? model->begin_( cost ) : NONE )
+{
+}
+
+inline CostModel::Charge::~Charge()
+{
+   if( call_ != NONE )
+      model_->end_( call_ );
+}
+
+inline CostModel::CostModel()
+:
+   mutex_(),
+   costs_(),
+   calls_(),
+   first_( 0 )
+{
+}
+
+inline CostModel::Cost CostModel::fixed( std::chrono::nanoseconds latency )
+{
+   return [latency]{ return latency; };
+}
+
+template<typename R, class T, typename... Parameters>
+void CostModel::setCost( R(T::*methodPtr)(Parameters...), Cost cost )
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+   if( cost )
+      costs_[ methodPtr ] = std::move( cost );
+   else
+      costs_.erase( methodPtr );
+}
+
+template<typename R, class T, typename... Parameters>
+void CostModel::setCost( R(T::*methodPtr)(Parameters...) const, Cost cost )
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+   if( cost )
+      costs_[ methodPtr ] = std::move( cost );
+   else
+      costs_.erase( methodPtr );
+}
+
+inline void CostModel::charge( const MethodKey& methodKey )
+{
+   end_( begin_( methodKey ) );
+}
+
+inline void CostModel::charge( const Cost& cost )
+{
+   end_( begin_( cost ) );
+}
+
+inline CostReport CostModel::getReport() const
+{
+   std::vector<Call_> calls;
+   {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      calls = calls_;
+   }
+
+   // The calls still in progress are taken to return now.
+   const auto now = Clock::now();
+   for( auto& call : calls )
+   {
+      if( !call.returned )
+         call.end = now;
+   }
+
+   CostReport report;
+   report.calls = calls.size();
+
+   std::unordered_set<std::thread::id> threads;
+   for( const auto& call : calls )
+   {
+      threads.insert( call.thread );
+      report.serialLatency += call.cost;
+   }
+   report.threads = threads.size();
+
+   // The calls are visited in the order they were made. A call follows the
+   // calls that returned before it was made, and the calls of its thread made
+   // before it. The cost of the most costly chain up to each call is kept by
+   // when the call returned, and per thread for the latest call.
+   std::stable_sort(
+      calls.begin(),
+      calls.end(),
+      []( const Call_& a, const Call_& b ) { return a.start < b.start; } );
+
+   using Chain = std::pair<Clock::time_point, std::chrono::nanoseconds>;
+   auto returnsLater = []( const Chain& a, const Chain& b )
+   {
+      return a.first > b.first;
+   };
+   std::priority_queue<Chain, std::vector<Chain>, decltype( returnsLater )>
+      inProgress( returnsLater );
+   std::unordered_map<std::thread::id, std::chrono::nanoseconds> latest;
+   std::chrono::nanoseconds returned = std::chrono::nanoseconds::zero();
+
+   for( const auto& call : calls )
+   {
+      while( !inProgress.empty() && inProgress.top().first <= call.start )
+      {
+         returned = std::max( returned, inProgress.top().second );
+         inProgress.pop();
+      }
+
+      auto& previous = latest[ call.thread ];
+      const auto chain = std::max( returned, previous ) + call.cost;
+      previous = chain;
+      inProgress.push( Chain( call.end, chain ) );
+      report.criticalPath = std::max( report.criticalPath, chain );
+   }
+
+   return report;
+}
+
+inline void CostModel::reset()
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+   first_ += calls_.size();
+   calls_.clear();
+}
+
+inline std::size_t CostModel::begin_( const MethodKey& methodKey )
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+   auto cost = costs_.find( methodKey );
+   if( cost == costs_.end() )
+      return NONE;
+
+   return charge_( cost->second );
+}
+
+inline std::size_t CostModel::begin_( const Cost& cost )
+{
+   if( !cost )
+      return NONE;
+
+   std::lock_guard<std::mutex> lock( mutex_ );
+   return charge_( cost );
+}
+
+inline std::size_t CostModel::charge_( const Cost& cost )
+{
+   const auto latency = cost();
+   calls_.push_back( Call_{
+      Clock::now(), Clock::time_point(), false, std::this_thread::get_id(),
+      latency } );
+
+   return first_ + calls_.size() - 1;
+}
+
+inline void CostModel::end_( std::size_t call ) noexcept
+{
+   if( call == NONE )
+      return;
+
+   const auto now = Clock::now();
+   std::lock_guard<std::mutex> lock( mutex_ );
+
+   // The call is forgotten if the model was reset meanwhile.
+   if( call >= first_ )
+   {
+      auto& charged = calls_[ call - first_ ];
+      charged.end = now;
+      charged.returned = true;
+   }
+}
+
+
+} // namespace
@@ -0,0 +1,67 @@
+/*
+
+   DifferentialReport.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+
+#include "unimock/QuantileSketch.hh"
+
+
+namespace unimock
+{
+
+/// DifferentialReport comparing a primary and a candidate implementation.
+///
+/// A Mock with a candidate mirrors the calls that go to its stub, the primary
+/// implementation, to the candidate. The report of a method tells how many
+/// calls were mirrored, in how many of them the candidate returned another
+/// value than the primary, or threw, in how many the results couldn't be
+/// compared, and how long the calls took in both implementations.
+///
+struct DifferentialReport
+{
+   /// Constructor.
+   ///
+   /// Constructs an empty report.
+   ///
+   /// \exception Exception neutral.
+   ///
+   DifferentialReport();
+
+   /// The number of mirrored calls.
+   std::size_t calls;
+
+   /// The number of calls where the results differ or the candidate threw.
+   std::size_t mismatches;
+
+   /// The number of calls where the results weren't compared. Either the
+   /// result type has no operator==, or the method has parameters the
+   /// implementations may write to, references or pointers to non-const,
+   /// whose values after the candidate call are discarded.
+   std::size_t notCompared;
+
+   /// The latencies of the primary implementation, in nanoseconds.
+   QuantileSketch primaryLatency;
+
+   /// The latencies of the candidate implementation, in nanoseconds.
+   QuantileSketch candidateLatency;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "DifferentialReport.icc"
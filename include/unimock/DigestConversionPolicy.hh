@@ -0,0 +1,91 @@
+/*
+
+   DigestConversionPolicy.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstdint>
+
+#include "Internal/BoundedConversionPolicy.hh"
+
+
+namespace unimock
+{
+
+/// Digest of the bytes in an argument.
+///
+/// The digest holds the size in bytes and a 64 bit hash of the bytes. Two
+/// digests are equal if the arguments had the same bytes, with a very small
+/// probability of a false match.
+///
+struct Digest
+{
+   std::size_t size;
+
+   std::uint64_t hash;
+
+};
+
+bool operator==( const Digest& lhs, const Digest& rhs ) noexcept;
+
+bool operator!=( const Digest& lhs, const Digest& rhs ) noexcept;
+
+/// Capture of digests, used by the DigestConversionPolicy.
+///
+struct DigestCapture
+{
+   template<typename T>
+   using Applies = IsByteRange<T>;
+
+   template<class Range>
+   static Digest capture( const Range& range ) noexcept;
+
+   static Digest capture( const char* stringPtr ) noexcept;
+
+};
+
+/// Makes a digest to compare with the digests of recorded arguments.
+///
+/// #### Example ####
+/// ~~~
+/// auto resultSet = makeResultSet( recorder->find( &IFile::write ) );
+/// assert( resultSet.get<0, 0>() == makeDigest( expectedBuffer ) );
+/// ~~~
+///
+/// \param[in] object
+///   A string, a string literal, or a vector or array of arithmetic values.
+///
+/// \returns
+///   The digest of the object.
+///
+/// \exception No-throw.
+///
+template<typename T>
+Digest makeDigest( const T& object ) noexcept;
+
+/// DigestConversionPolicy to convert from one type to another.
+///
+/// This conversion policy stores a Digest instead of a copy of strings, string
+/// literals, const char*, and vectors and arrays of arithmetic values, also
+/// when they are passed by pointer or std::unique_ptr. Large buffers can then
+/// be checked for identity without the cost of a deep copy. All other types
+/// are converted like in the DefaultConversionPolicy.
+///
+using DigestConversionPolicy = BoundedConversionPolicy<DigestCapture>;
+
+
+} // namespace
+
+
+// Implementation.
+#include "DigestConversionPolicy.tcc"
@@ -0,0 +1,56 @@
+/*
+
+   DigestConversionPolicy.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstring>      // std::strlen
+
+#include "Internal/Hash.hh"
+
+
+namespace unimock
+{
+
+inline bool operator==( const Digest& lhs, const Digest& rhs ) noexcept
+{
+   return lhs.size == rhs.size && lhs.hash == rhs.hash;
+}
+
+inline bool operator!=( const Digest& lhs, const Digest& rhs ) noexcept
+{
+   return !( lhs == rhs );
+}
+
+template<class Range>
+Digest DigestCapture::capture( const Range& range ) noexcept
+{
+   const std::size_t size = byteSize( range );
+
+   return Digest{ size, hashBytes( byteData( range ), size ) };
+}
+
+inline Digest DigestCapture::capture( const char* stringPtr ) noexcept
+{
+   const std::size_t size = std::strlen( stringPtr );
+
+   return Digest{ size, hashBytes( stringPtr, size ) };
+}
+
+template<typename T>
+Digest makeDigest( const T& object ) noexcept
+{
+   return DigestConversionPolicy::convert( object );
+}
+
+
+} // namespace
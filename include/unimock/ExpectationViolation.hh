@@ -0,0 +1,51 @@
+/*
+
+   ExpectationViolation.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <stdexcept>    // std::logic_error
+#include <string>
+
+
+namespace unimock
+{
+
+/// Exception thrown when a recorded call violates an expectation.
+///
+/// The CallRecorder throws this exception from the record method, i.e. from
+/// within the code under test, as soon as a call violates an expectation, and
+/// from verifyExpectations for expectations that weren't met. A violation
+/// handler can be set on the recorder to report the violations in another
+/// way.
+///
+class ExpectationViolation : public std::logic_error
+{
+public:
+
+   /// Constructor.
+   ///
+   /// \param[in] message
+   ///   The description of the violation.
+   ///
+   /// \exception Exception neutral.
+   ///
+   explicit ExpectationViolation( const std::string& message );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "ExpectationViolation.icc"
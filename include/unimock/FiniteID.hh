@@ -14,6 +14,25 @@ ________________________________________________________________________________
 #pragma once
 
 #include <cstdint>
+#include <cstddef>      // std::size_t
+#include <functional>   // std::hash
+
+
+namespace unimock
+{
+
+class FiniteID;
+
+} // namespace
+
+
+namespace std
+{
+
+template<>
+struct hash<unimock::FiniteID>;
+
+} // namespace
 
 
 namespace unimock
@@ -128,6 +147,8 @@ public:
 
 private:
 
+   friend struct std::hash<FiniteID>;
+
    std::uint64_t integerID_;
 
 };
@@ -136,6 +157,23 @@ private:
 } // namespace
 
 
+namespace std
+{
+
+/// Hashes a finite identifier, so that it can be used as a key in unordered
+/// containers. The underlying integer is mixed, which spreads consecutive
+/// identifiers over the buckets. The mix is reversible, so the hash isn't a
+/// way to hide the integer.
+///
+template<>
+struct hash<unimock::FiniteID>
+{
+   std::size_t operator()( const unimock::FiniteID& finiteID ) const noexcept;
+};
+
+} // namespace
+
+
 // Implementation.
 #include "FiniteID.icc"
 
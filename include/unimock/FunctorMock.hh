@@ -15,10 +15,19 @@ ________________________________________________________________________________
 
 #include <memory>       // std::shared_ptr
 #include <functional>
+#include <tuple>
+#include <vector>
+#include <type_traits>
 
 #include "unimock/FiniteID.hh"
 #include "unimock/CallRecorder.hh"
 #include "unimock/DefaultConversionPolicy.hh"
+#include "unimock/Capacity.hh"
+#include "unimock/VirtualScheduler.hh"
+#include "unimock/CostModel.hh"
+#include "Internal/ResponseTable.hh"
+#include "Internal/CapacityLimiter.hh"
+#include "Internal/Deferral.hh"
 
 
 namespace unimock
@@ -103,7 +112,7 @@ public:
    ///
    /// \returns
    ///   The result of the functor that is recorded. The result comes from a
-   ///   stub or a default value, in that order.
+   ///   response, a stub or a default value, in that order.
    ///
    /// \exception Exception neutral.
    ///
@@ -126,6 +135,116 @@ public:
    ///
    auto find() const;
 
+   /// Sets the response to calls with some arguments.
+   ///
+   /// Calls with arguments equal to the ones provided return the response,
+   /// looked up in a hash table without calling the stub. The responses take
+   /// precedence over a response sequence and the stub. They are shared by
+   /// the copies of the mock. The argument types must be hashable with
+   /// std::hash and equality comparable.
+   ///
+   /// \param[in] arguments
+   ///   The arguments to respond to.
+   ///
+   /// \param[in] response
+   ///   The value to return.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void setResponse(
+      std::tuple<std::decay_t<Parameters>...> arguments,
+      ResponseT<R> response );
+
+   /// Sets the responses to the next calls.
+   ///
+   /// The next calls return the responses in order, indexed by the number of
+   /// calls made since the sequence was set. The calls after the last response
+   /// go to the stub as usual.
+   ///
+   /// \param[in] responses
+   ///   The values to return, one per call.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void setResponseSequence( std::vector<ResponseT<R>> responses );
+
+   /// Sets the capacity of the functor.
+   ///
+   /// The functor then emulates a saturated dependency, like a Mock method
+   /// with a capacity does. Calls that exceed the capacity throw
+   /// CapacityExceeded, and the served calls occupy their server for a
+   /// service time before they go on to the stub. Copies of the mock made
+   /// after the capacity is set share it.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// Capacity capacity;
+   /// capacity.servers = 1;
+   /// capacity.queueDepth = 0;
+   ///
+   /// FunctorMock<void(Request)> mock( &handle );
+   /// mock.setCapacity( capacity );
+   /// ~~~
+   ///
+   /// \param[in] capacity
+   ///   The capacity of the functor.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void setCapacity( Capacity capacity );
+
+   /// Gets the capacity statistics of the functor.
+   ///
+   /// \returns
+   ///   The statistics of the functor, empty if it has no capacity.
+   ///
+   /// \exception Exception neutral.
+   ///
+   CapacityStatistics getCapacityStatistics() const;
+
+   /// Sets the virtual latency of a functor returning a future.
+   ///
+   /// The future returned by the stub is then replaced by a future that
+   /// becomes ready when the virtual time of the scheduler has advanced by the
+   /// latency, like for a Mock method with a virtual latency. Copies of the
+   /// mock made after the latency is set share it.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// auto scheduler = std::make_shared<VirtualScheduler>();
+   /// FunctorMock<std::future<int>(int)> mock( &fetch );
+   /// mock.setVirtualLatency( scheduler, std::chrono::milliseconds( 20 ) );
+   /// ~~~
+   ///
+   /// \param[in] scheduler
+   ///   The scheduler of the virtual time, or null to stop deferring.
+   ///
+   /// \param[in] latency
+   ///   The virtual latency of the results.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void setVirtualLatency(
+      std::shared_ptr<VirtualScheduler> scheduler,
+      std::chrono::nanoseconds latency );
+
+   /// Sets a cost model to charge with the cost of the calls.
+   ///
+   /// Every call to the functor is charged to the model with the cost given,
+   /// by the calling thread, like the calls to a Mock method with a cost.
+   ///
+   /// \param[in] costModel
+   ///   The cost model, or nullptr to stop charging.
+   ///
+   /// \param[in] cost
+   ///   The cost of a call.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void setCostModel(
+      std::shared_ptr<CostModel> costModel,
+      CostModel::Cost cost );
+
    /// Gets the identifier of the theoretical functor mocked.
    ///
    /// The identifier that is returned is not connected to the instance of this
@@ -157,6 +276,22 @@ private:
 
    std::function<R(Parameters...)> stub_;
 
+   std::shared_ptr<ResponseTable<R, Parameters...>> responses_;
+
+   std::shared_ptr<CapacityLimiter> capacity_;
+
+   std::shared_ptr<Deferral> deferral_;
+
+   std::shared_ptr<CostModel> costModel_;
+
+   CostModel::Cost cost_;
+
+   template<class F>
+   R deferred_( std::false_type, F function ) const;
+
+   template<class F>
+   R deferred_( std::true_type, F function ) const;
+
 
 };
 
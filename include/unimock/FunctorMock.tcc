@@ -24,7 +24,12 @@ FunctorMock<R(Parameters...), ConversionPolicy>::FunctorMock()
 :
    mockID_( FiniteID::generate() ),
    recorder_( std::make_shared<CallRecorder<ConversionPolicy>>() ),
-   stub_()
+   stub_(),
+   responses_( std::make_shared<ResponseTable<R, Parameters...>>() ),
+   capacity_(),
+   deferral_(),
+   costModel_(),
+   cost_()
 {
 }
 
@@ -34,7 +39,12 @@ FunctorMock<R(Parameters...), ConversionPolicy>::FunctorMock(
 :
    mockID_( FiniteID::generate() ),
    recorder_( std::move( recorder ) ),
-   stub_()
+   stub_(),
+   responses_( std::make_shared<ResponseTable<R, Parameters...>>() ),
+   capacity_(),
+   deferral_(),
+   costModel_(),
+   cost_()
 {
 }
 
@@ -44,7 +54,12 @@ FunctorMock<R(Parameters...), ConversionPolicy>::FunctorMock(
 :
    mockID_( FiniteID::generate() ),
    recorder_( std::make_shared<CallRecorder<ConversionPolicy>>() ),
-   stub_( std::move( stub ) )
+   stub_( std::move( stub ) ),
+   responses_( std::make_shared<ResponseTable<R, Parameters...>>() ),
+   capacity_(),
+   deferral_(),
+   costModel_(),
+   cost_()
 {
 }
 
@@ -55,7 +70,12 @@ FunctorMock<R(Parameters...), ConversionPolicy>::FunctorMock(
 :
    mockID_( FiniteID::generate() ),
    recorder_( std::move( recorder ) ),
-   stub_( std::move( stub ) )
+   stub_( std::move( stub ) ),
+   responses_( std::make_shared<ResponseTable<R, Parameters...>>() ),
+   capacity_(),
+   deferral_(),
+   costModel_(),
+   cost_()
 {
 }
 
@@ -63,21 +83,49 @@ template<typename R, typename... Parameters, class ConversionPolicy>
 R FunctorMock<R(Parameters...), ConversionPolicy>::operator()(
    Parameters... arguments )
 {
+   // The call is charged until it returns.
+   CostModel::Charge charge( costModel_.get(), cost_ );
+
+   // The response is looked up before the arguments are forwarded to the
+   // recorder, which may move from them.
+   auto response =
+      responses_->empty() ? nullptr : responses_->respond( arguments... );
+
    // We use std::forward just like in perfect forwarding. The parameters
    // Parameters... ain't taken with a universal reference T&& but the template
    // types passed to std::forward will be the same regardless of && due to the
    // rvalue reference collapsing rule. The arguments passed will irrespectively
    // of type always call the same overload of std::forward since named
    // variables invoke a function taking T&, and never T&&.
-   recorder_->record(
-      mockID_,
-      &FunctorMock<R(Parameters...), ConversionPolicy>::operator(),
-      std::forward<Parameters>( arguments )... );
+   auto record = [&]
+   {
+      recorder_->record(
+         mockID_,
+         &FunctorMock<R(Parameters...), ConversionPolicy>::operator(),
+         std::forward<Parameters>( arguments )... );
+   };
+
+   // With a capacity, the call is recorded along with the slot of its
+   // queueing delay.
+   auto delaySlot = CallSlots<std::chrono::nanoseconds>::NONE;
+   if( capacity_ )
+      delaySlot = capacity_->reserve( record );
+   else
+      record();
+
+   if( response )
+      return ResponseTable<R, Parameters...>::result( *response );
+
+   CapacityLimiter::Slot slot( capacity_.get(), delaySlot );
+   slot.serve();
 
    if( stub_ )
    {
-      return static_cast<R>(
-         stub_( std::forward<Parameters>( arguments )... ) );
+      return deferred_( IsFuture<R>(), [&]() -> R
+      {
+         return static_cast<R>(
+            stub_( std::forward<Parameters>( arguments )... ) );
+      } );
    }
 
    // Without a stub we just return some default value.
@@ -92,12 +140,83 @@ auto FunctorMock<R(Parameters...), ConversionPolicy>::find() const
       &FunctorMock<R(Parameters...), ConversionPolicy>::operator() );
 }
 
+template<typename R, typename... Parameters, class ConversionPolicy>
+void FunctorMock<R(Parameters...), ConversionPolicy>::setResponse(
+   std::tuple<std::decay_t<Parameters>...> arguments,
+   ResponseT<R> response )
+{
+   responses_->set( std::move( arguments ), std::move( response ) );
+}
+
+template<typename R, typename... Parameters, class ConversionPolicy>
+void FunctorMock<R(Parameters...), ConversionPolicy>::setResponseSequence(
+   std::vector<ResponseT<R>> responses )
+{
+   responses_->setSequence( std::move( responses ) );
+}
+
+template<typename R, typename... Parameters, class ConversionPolicy>
+void FunctorMock<R(Parameters...), ConversionPolicy>::setCapacity(
+   Capacity capacity )
+{
+   capacity_ = std::make_shared<CapacityLimiter>( std::move( capacity ) );
+}
+
+template<typename R, typename... Parameters, class ConversionPolicy>
+CapacityStatistics
+FunctorMock<R(Parameters...), ConversionPolicy>::getCapacityStatistics() const
+{
+   return capacity_ ? capacity_->getStatistics() : CapacityStatistics();
+}
+
+template<typename R, typename... Parameters, class ConversionPolicy>
+void FunctorMock<R(Parameters...), ConversionPolicy>::setVirtualLatency(
+   std::shared_ptr<VirtualScheduler> scheduler,
+   std::chrono::nanoseconds latency )
+{
+   static_assert( IsFuture<R>::value, "Only futures can be deferred" );
+
+   if( scheduler )
+      deferral_ = std::make_shared<Deferral>( std::move( scheduler ), latency );
+   else
+      deferral_.reset();
+}
+
+template<typename R, typename... Parameters, class ConversionPolicy>
+void FunctorMock<R(Parameters...), ConversionPolicy>::setCostModel(
+   std::shared_ptr<CostModel> costModel,
+   CostModel::Cost cost )
+{
+   costModel_ = std::move( costModel );
+   cost_ = std::move( cost );
+}
+
 template<typename R, typename... Parameters, class ConversionPolicy>
 FiniteID FunctorMock<R(Parameters...), ConversionPolicy>::getID() const
 {
    return mockID_;
 }
 
+template<typename R, typename... Parameters, class ConversionPolicy>
+template<class F>
+R FunctorMock<R(Parameters...), ConversionPolicy>::deferred_(
+   std::false_type,
+   F function ) const
+{
+   return function();
+}
 
-} // namespace
+template<typename R, typename... Parameters, class ConversionPolicy>
+template<class F>
+R FunctorMock<R(Parameters...), ConversionPolicy>::deferred_(
+   std::true_type,
+   F function ) const
+{
+   if( !deferral_ )
+      return function();
 
+   return deferral_->scheduler->deferred( deferral_->latency, function() );
+}
+
+
+} // namespace
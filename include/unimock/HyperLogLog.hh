@@ -0,0 +1,106 @@
+/*
+
+   HyperLogLog.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstdint>
+#include <vector>
+
+
+namespace unimock
+{
+
+/// HyperLogLog to estimate the number of distinct values.
+///
+/// The HyperLogLog sketch estimates the number of distinct values it has been
+/// given in constant memory. With the default precision the sketch uses 4 kB
+/// and has a standard error of about 1.6 %. Two sketches with the same
+/// precision can be merged, giving the same estimate as if all values had been
+/// added to one sketch.
+///
+/// The values are hashed with std::hash, so any type with a std::hash
+/// specialization can be added.
+///
+/// #### See also ####
+/// [HyperLogLog](http://algo.inria.fr/flajolet/Publications/FlFuGaMe07.pdf)
+///
+class HyperLogLog
+{
+public:
+
+   /// Constructor.
+   ///
+   /// \param[in] precision
+   ///   The number of hash bits used to select a register. The sketch uses
+   ///   2^precision bytes and the standard error is 1.04 / sqrt(2^precision).
+   ///   The precision must be between 4 and 18.
+   ///
+   /// \exception Exception neutral.
+   ///
+   explicit HyperLogLog( unsigned precision = 12 );
+
+   /// Adds a value to the sketch.
+   ///
+   /// \param[in] value
+   ///   The value to add.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename T>
+   void add( const T& value );
+
+   /// Adds a hashed value to the sketch.
+   ///
+   /// \param[in] hash
+   ///   A well mixed 64 bit hash of the value to add.
+   ///
+   /// \exception No-throw.
+   ///
+   void addHash( std::uint64_t hash ) noexcept;
+
+   /// Merges another sketch into this sketch.
+   ///
+   /// \pre The other sketch must have the same precision.
+   ///
+   /// \param[in] other
+   ///   The sketch to merge.
+   ///
+   /// \exception No-throw.
+   ///
+   void merge( const HyperLogLog& other ) noexcept;
+
+   /// Estimates the number of distinct values added.
+   ///
+   /// \returns
+   ///   The estimated number of distinct values.
+   ///
+   /// \exception No-throw.
+   ///
+   double estimate() const noexcept;
+
+
+private:
+
+   unsigned precision_;
+
+   std::vector<std::uint8_t> registers_;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "HyperLogLog.tcc"
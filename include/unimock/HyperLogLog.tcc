@@ -0,0 +1,101 @@
+/*
+
+   HyperLogLog.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <functional>   // std::hash
+#include <algorithm>    // std::max
+#include <cmath>
+#include <cassert>
+
+#include "Internal/Hash.hh"
+
+
+namespace unimock
+{
+
+inline HyperLogLog::HyperLogLog( unsigned precision )
+:
+   precision_( precision ),
+   registers_( std::size_t( 1 ) << precision, 0 )
+{
+   assert( precision >= 4 && precision <= 18 );
+}
+
+template<typename T>
+void HyperLogLog::add( const T& value )
+{
+   // std::hash is often the identity for integers, so we mix the bits first.
+   addHash( mix64( std::hash<T>()( value ) ) );
+}
+
+inline void HyperLogLog::addHash( std::uint64_t hash ) noexcept
+{
+   // The first bits select the register and the rest of the bits give the
+   // rank, i.e. the position of the leftmost 1 bit. We set the lowest bit to
+   // bound the rank.
+   const std::size_t index = hash >> ( 64 - precision_ );
+   std::uint64_t rest = ( hash << precision_ ) | ( 1ULL << ( precision_ - 1 ) );
+
+   std::uint8_t rank = 1;
+   while( !( rest & ( 1ULL << 63 ) ) )
+   {
+      rest <<= 1;
+      rank++;
+   }
+
+   registers_[ index ] = std::max( registers_[ index ], rank );
+}
+
+inline void HyperLogLog::merge( const HyperLogLog& other ) noexcept
+{
+   assert( precision_ == other.precision_ );
+
+   for( std::size_t i = 0; i < registers_.size(); i++ )
+      registers_[ i ] = std::max( registers_[ i ], other.registers_[ i ] );
+}
+
+inline double HyperLogLog::estimate() const noexcept
+{
+   const double m = static_cast<double>( registers_.size() );
+
+   double sum = 0.0;
+   std::size_t zeroRegisters = 0;
+   for( auto rank : registers_ )
+   {
+      sum += std::ldexp( 1.0, -rank );
+      if( rank == 0 )
+         zeroRegisters++;
+   }
+
+   // The bias correction constant depends on the number of registers.
+   double alpha = 0.7213 / ( 1.0 + 1.079 / m );
+   if( registers_.size() == 16 )
+      alpha = 0.673;
+   else if( registers_.size() == 32 )
+      alpha = 0.697;
+   else if( registers_.size() == 64 )
+      alpha = 0.709;
+
+   const double estimate = alpha * m * m / sum;
+
+   // Small ranges are estimated better by linear counting. With a 64 bit hash
+   // no correction is needed for large ranges.
+   if( estimate <= 2.5 * m && zeroRegisters > 0 )
+      return m * std::log( m / static_cast<double>( zeroRegisters ) );
+
+   return estimate;
+}
+
+
+} // namespace
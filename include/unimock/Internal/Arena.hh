@@ -0,0 +1,67 @@
+/*
+
+   Arena.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <vector>
+#include <memory>       // std::unique_ptr
+
+
+namespace unimock
+{
+
+// A bump allocator handing out memory from large blocks. The memory is only
+// released when the arena is destroyed, which makes an allocation a pointer
+// increment most of the time.
+class Arena
+{
+public:
+
+   Arena();
+
+   // The views handed out refer to the blocks, so an arena isn't copied.
+   Arena( const Arena& ) = delete;
+
+   Arena& operator=( const Arena& ) = delete;
+
+   void* allocate( std::size_t size, std::size_t alignment );
+
+   // Copies the bytes into the arena and returns the copy.
+   const void* copy(
+      const void* data,
+      std::size_t size,
+      std::size_t alignment );
+
+   // The number of bytes allocated from the arena.
+   std::size_t size() const noexcept;
+
+
+private:
+
+   std::vector<std::unique_ptr<unsigned char[]>> blocks_;
+
+   unsigned char* position_;
+
+   std::size_t available_;
+
+   std::size_t size_;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "Arena.icc"
@@ -0,0 +1,49 @@
+/*
+
+   ArgumentFilter.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <functional>
+#include <type_traits>
+
+
+namespace unimock
+{
+
+class ArgumentFilterI
+{
+public:
+
+   virtual ~ArgumentFilterI() {}
+
+};
+
+// A predicate on the arguments of a call, as they are passed to the function
+// or method before any conversion.
+template<typename... FncParameters>
+struct ArgumentFilter : public ArgumentFilterI
+{
+   template<class F>
+   explicit ArgumentFilter( F predicate );
+
+   std::function<bool(const std::remove_reference_t<FncParameters>&...)>
+      predicate;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "ArgumentFilter.tcc"
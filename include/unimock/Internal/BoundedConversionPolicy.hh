@@ -0,0 +1,97 @@
+/*
+
+   BoundedConversionPolicy.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>       // std::unique_ptr
+#include <type_traits>
+
+
+namespace unimock
+{
+
+// Check if a type is a contiguous container of arithmetic values, i.e. a range
+// of bytes that can be hashed or copied in part.
+template<typename T>
+struct IsByteRange : std::false_type {};
+
+template<typename C, class Traits, class Allocator>
+struct IsByteRange<std::basic_string<C, Traits, Allocator>>
+   : std::is_arithmetic<C> {};
+
+template<typename T, class Allocator>
+struct IsByteRange<std::vector<T, Allocator>>
+   : std::integral_constant<bool,
+      std::is_arithmetic<T>::value && !std::is_same<T, bool>::value> {};
+
+template<typename T, std::size_t N>
+struct IsByteRange<std::array<T, N>> : std::is_arithmetic<T> {};
+
+// Check if a type has a size method, like the standard containers.
+template<typename T, typename = void>
+struct HasSize : std::false_type {};
+
+template<typename T>
+struct HasSize<T, decltype( void( std::declval<const T&>().size() ) )>
+   : std::true_type {};
+
+template<class Range>
+const void* byteData( const Range& range ) noexcept;
+
+template<class Range>
+std::size_t byteSize( const Range& range ) noexcept;
+
+// The conversion rules shared by the policies that capture a bounded summary
+// of large arguments instead of a copy. The capture decides which types it
+// applies to and what to store for them, while all other types are converted
+// the same way as in the DefaultConversionPolicy.
+template<class Capture>
+class BoundedConversionPolicy
+{
+public:
+
+   template<typename T>
+   static auto convert( T&& object );
+
+   template<typename T>
+   static auto convert( T* objectPtr );
+
+   static auto convert( const char* stringPtr );
+
+   template<typename T>
+   static auto convert( const std::unique_ptr<T>& objectUPtr );
+
+   template<typename T>
+   static auto convert( std::unique_ptr<T>&& objectUPtr );
+
+
+private:
+
+   template<typename T>
+   static auto capture_( T&& object, std::true_type );
+
+   template<typename T>
+   static auto capture_( T&& object, std::false_type );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "BoundedConversionPolicy.tcc"
@@ -0,0 +1,95 @@
+/*
+
+   BoundedConversionPolicy.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <utility>      // std::forward
+
+
+namespace unimock
+{
+
+template<class Range>
+const void* byteData( const Range& range ) noexcept
+{
+   return range.data();
+}
+
+template<class Range>
+std::size_t byteSize( const Range& range ) noexcept
+{
+   return range.size() * sizeof( typename Range::value_type );
+}
+
+template<class Capture>
+template<typename T>
+auto BoundedConversionPolicy<Capture>::capture_( T&& object, std::true_type )
+{
+   return Capture::capture( object );
+}
+
+// Plain auto never deduces to a reference, so the types that aren't captured
+// are stored as copies, just like in the DefaultConversionPolicy.
+template<class Capture>
+template<typename T>
+auto BoundedConversionPolicy<Capture>::capture_( T&& object, std::false_type )
+{
+   return std::forward<T>( object );
+}
+
+template<class Capture>
+template<typename T>
+auto BoundedConversionPolicy<Capture>::convert( T&& object )
+{
+   return capture_(
+      std::forward<T>( object ),
+      typename Capture::template Applies<std::decay_t<T>>() );
+}
+
+template<class Capture>
+template<typename T>
+auto BoundedConversionPolicy<Capture>::convert( T* objectPtr )
+{
+   return capture_(
+      *objectPtr,
+      typename Capture::template Applies<std::remove_cv_t<T>>() );
+}
+
+template<class Capture>
+auto BoundedConversionPolicy<Capture>::convert( const char* stringPtr )
+{
+   return Capture::capture( stringPtr );
+}
+
+template<class Capture>
+template<typename T>
+auto BoundedConversionPolicy<Capture>::convert(
+   const std::unique_ptr<T>& objectUPtr )
+{
+   return capture_(
+      *objectUPtr,
+      typename Capture::template Applies<std::remove_cv_t<T>>() );
+}
+
+template<class Capture>
+template<typename T>
+auto BoundedConversionPolicy<Capture>::convert(
+   std::unique_ptr<T>&& objectUPtr )
+{
+   return capture_(
+      *objectUPtr,
+      typename Capture::template Applies<std::remove_cv_t<T>>() );
+}
+
+
+} // namespace
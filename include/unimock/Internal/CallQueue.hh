@@ -0,0 +1,149 @@
+/*
+
+   CallQueue.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <memory>       // std::unique_ptr
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+#include "SpscRing.hh"
+
+
+namespace unimock
+{
+
+// A queue of recorded calls, handed over from the recording threads to a
+// background thread. Each recording thread pushes into a ring of its own, so
+// pushing doesn't lock or allocate once the ring is there. The background
+// thread regularly moves the calls from the rings into a vector of its own,
+// where they wait to be drained into the call history.
+//
+// The calls of each recording thread are drained in the order they were
+// pushed, while the interleave between different threads isn't kept.
+//
+// With a consumer, the background thread hands each call over to the consumer
+// instead, and nothing is drained. The consumer is called without any lock
+// held and may push calls itself, even into this queue. Since the consumer
+// may then be the one that has to make room, a full ring overflows into a
+// vector instead of waiting.
+template<typename Call>
+class CallQueue
+{
+public:
+
+   explicit CallQueue( std::function<void(Call&)> consumer = nullptr );
+
+   CallQueue( const CallQueue& ) = delete;
+
+   CallQueue& operator=( const CallQueue& ) = delete;
+
+   ~CallQueue();
+
+   // Pushes a call from the calling thread. Waits if the ring of the calling
+   // thread is full, unless there is a consumer.
+   void push( Call&& call );
+
+   // Appends all calls pushed so far to the history. The returned lock keeps
+   // the background thread out until it's released.
+   std::unique_lock<std::mutex> drain( std::vector<Call>& history );
+
+   // Waits until all calls pushed so far are handed over to the consumer. Must
+   // not be called by the consumer.
+   void flush();
+
+
+private:
+
+   using Ring_ = SpscRing<Call>;
+
+   // The calls pushed by one thread. The overflow takes the calls once the
+   // ring is full, and keeps taking them until it's emptied, which keeps the
+   // calls in order.
+   struct ThreadCalls_
+   {
+      explicit ThreadCalls_( std::size_t size )
+      :
+         ring( size ),
+         mutex(),
+         overflow(),
+         overflowing( false )
+      {
+      }
+
+      Ring_ ring;
+
+      std::mutex mutex;
+
+      std::vector<Call> overflow;
+
+      std::atomic<bool> overflowing;
+   };
+
+   // Identifies the queue in the ring cached per thread, since another queue
+   // may later be created at the same address.
+   const std::uint64_t id_;
+
+   std::mutex ringsMutex_;
+
+   std::vector<std::unique_ptr<ThreadCalls_>> rings_;
+
+   std::unordered_map<std::thread::id, ThreadCalls_*> threadRings_;
+
+   // Taken by whoever collects the calls without a consumer, i.e. the
+   // background thread or a drain. With a consumer, only the background thread
+   // takes the calls, and the lock guards the rounds in which it does.
+   std::mutex mutex_;
+
+   std::condition_variable wakeup_;
+
+   std::condition_variable delivered_;
+
+   std::vector<Call> pending_;
+
+   std::function<void(Call&)> consumer_;
+
+   // The rounds of handing over calls to the consumer started and finished.
+   std::uint64_t startedRounds_;
+
+   std::uint64_t deliveredRounds_;
+
+   bool stopped_;
+
+   std::thread thread_;
+
+   static std::uint64_t nextID_() noexcept;
+
+   ThreadCalls_& threadRing_();
+
+   template<class Consumer>
+   void take_( Consumer consumer );
+
+   void collect_();
+
+   void run_();
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "CallQueue.tcc"
@@ -0,0 +1,253 @@
+/*
+
+   CallQueue.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <chrono>
+#include <atomic>
+#include <iterator>     // std::back_inserter, std::make_move_iterator
+#include <utility>      // std::move
+#include <functional>   // std::ref
+#include <cassert>
+
+
+namespace unimock
+{
+
+namespace
+{
+// The number of calls a recording thread can be ahead of the background thread
+// before it has to wait.
+constexpr const std::size_t CALL_QUEUE_RING_SIZE = 4096;
+
+// How often the background thread empties the rings.
+constexpr const std::chrono::milliseconds CALL_QUEUE_INTERVAL( 1 );
+
+} // unnamed namespace
+
+
+template<typename Call>
+CallQueue<Call>::CallQueue( std::function<void(Call&)> consumer )
+:
+   id_( nextID_() ),
+   ringsMutex_(),
+   rings_(),
+   threadRings_(),
+   mutex_(),
+   wakeup_(),
+   delivered_(),
+   pending_(),
+   consumer_( std::move( consumer ) ),
+   startedRounds_( 0 ),
+   deliveredRounds_( 0 ),
+   stopped_( false ),
+   thread_()
+{
+   thread_ = std::thread( &CallQueue::run_, this );
+}
+
+template<typename Call>
+CallQueue<Call>::~CallQueue()
+{
+   {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      stopped_ = true;
+   }
+
+   wakeup_.notify_one();
+   thread_.join();
+}
+
+template<typename Call>
+void CallQueue<Call>::push( Call&& call )
+{
+   ThreadCalls_& calls = threadRing_();
+
+   if( !calls.overflowing.load( std::memory_order_acquire ) &&
+      calls.ring.tryPush( call ) )
+         return;
+
+   if( !consumer_ )
+   {
+      while( !calls.ring.tryPush( call ) )
+      {
+         wakeup_.notify_one();
+         std::this_thread::yield();
+      }
+
+      return;
+   }
+
+   {
+      std::lock_guard<std::mutex> lock( calls.mutex );
+
+      calls.overflow.push_back( std::move( call ) );
+      calls.overflowing.store( true, std::memory_order_release );
+   }
+
+   wakeup_.notify_one();
+}
+
+template<typename Call>
+std::unique_lock<std::mutex> CallQueue<Call>::drain(
+   std::vector<Call>& history )
+{
+   std::unique_lock<std::mutex> lock( mutex_ );
+
+   collect_();
+
+   history.insert(
+      history.end(),
+      std::make_move_iterator( pending_.begin() ),
+      std::make_move_iterator( pending_.end() ) );
+   pending_.clear();
+
+   return lock;
+}
+
+template<typename Call>
+void CallQueue<Call>::flush()
+{
+   std::unique_lock<std::mutex> lock( mutex_ );
+
+   if( !consumer_ )
+   {
+      collect_();
+      return;
+   }
+
+   assert( std::this_thread::get_id() != thread_.get_id() );
+
+   // A round started after now takes all calls pushed so far.
+   const std::uint64_t round = startedRounds_ + 1;
+
+   wakeup_.notify_one();
+   delivered_.wait( lock, [this, round]()
+   {
+      return deliveredRounds_ >= round;
+   } );
+}
+
+template<typename Call>
+std::uint64_t CallQueue<Call>::nextID_() noexcept
+{
+   static std::atomic<std::uint64_t> id( 0 );
+
+   return ++id;
+}
+
+template<typename Call>
+typename CallQueue<Call>::ThreadCalls_& CallQueue<Call>::threadRing_()
+{
+   // The ring last used by the thread is cached, so that only the first call
+   // from a thread, or a thread switching between queues, takes the lock.
+   struct ThreadRing
+   {
+      std::uint64_t queueID;
+      ThreadCalls_* ring;
+   };
+
+   static thread_local ThreadRing threadRing = { 0, nullptr };
+
+   if( threadRing.queueID == id_ )
+      return *threadRing.ring;
+
+   std::lock_guard<std::mutex> lock( ringsMutex_ );
+
+   ThreadCalls_*& ring = threadRings_[ std::this_thread::get_id() ];
+   if( !ring )
+   {
+      rings_.emplace_back( new ThreadCalls_( CALL_QUEUE_RING_SIZE ) );
+      ring = rings_.back().get();
+   }
+
+   threadRing = { id_, ring };
+
+   return *ring;
+}
+
+template<typename Call>
+template<class Consumer>
+void CallQueue<Call>::take_( Consumer consumer )
+{
+   // The rings live as long as the queue, so they are consumed without holding
+   // the lock.
+   std::vector<ThreadCalls_*> rings;
+   {
+      std::lock_guard<std::mutex> lock( ringsMutex_ );
+
+      for( auto& ring : rings_ )
+         rings.push_back( ring.get() );
+   }
+
+   // The calls in a ring were all pushed before those in its overflow.
+   for( auto ring : rings )
+   {
+      ring->ring.consume( std::ref( consumer ) );
+
+      if( !ring->overflowing.load( std::memory_order_acquire ) )
+         continue;
+
+      std::vector<Call> overflow;
+      {
+         std::lock_guard<std::mutex> lock( ring->mutex );
+
+         overflow.swap( ring->overflow );
+         ring->overflowing.store( false, std::memory_order_release );
+      }
+
+      for( auto& call : overflow )
+         consumer( call );
+   }
+}
+
+template<typename Call>
+void CallQueue<Call>::collect_()
+{
+   take_( [this]( Call& call )
+   {
+      pending_.push_back( std::move( call ) );
+   } );
+}
+
+template<typename Call>
+void CallQueue<Call>::run_()
+{
+   std::unique_lock<std::mutex> lock( mutex_ );
+
+   while( !stopped_ )
+   {
+      if( consumer_ )
+      {
+         // The calls are handed over without the lock, so a consumer pushing
+         // calls or a flush never waits for the consumer while it's locked.
+         const std::uint64_t round = ++startedRounds_;
+
+         lock.unlock();
+         take_( std::ref( consumer_ ) );
+         lock.lock();
+
+         deliveredRounds_ = round;
+         delivered_.notify_all();
+      }
+      else
+      {
+         collect_();
+      }
+
+      wakeup_.wait_for( lock, CALL_QUEUE_INTERVAL );
+   }
+}
+
+
+} // namespace
@@ -0,0 +1,69 @@
+/*
+
+   CallSlots.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <mutex>
+#include <vector>
+
+
+namespace unimock
+{
+
+// A value per recorded call of a method, kept in the order the calls were
+// recorded. A slot is reserved while the call is recorded, so the slots line
+// up with the recorded calls even when the calls complete in another order,
+// and it's filled in once the value is known. Slots that are never filled
+// keep the empty value.
+template<typename T>
+class CallSlots final
+{
+public:
+
+   // The slot of a call that isn't recorded.
+   static const std::size_t NONE = static_cast<std::size_t>( -1 );
+
+   explicit CallSlots( T empty );
+
+   CallSlots( const CallSlots& ) = delete;
+   CallSlots& operator=( const CallSlots& ) = delete;
+
+   // Reserves the slot of a call and records the call with the function
+   // given, both under the lock of the slots. The slot stays reserved if the
+   // function throws.
+   template<class Record>
+   std::size_t reserve( Record record );
+
+   // Fills a reserved slot. Does nothing for NONE.
+   void fill( std::size_t slot, T value );
+
+   std::vector<T> values() const;
+
+
+private:
+
+   mutable std::mutex mutex_;
+
+   const T empty_;
+
+   std::vector<T> values_;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "CallSlots.tcc"
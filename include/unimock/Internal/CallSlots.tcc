@@ -0,0 +1,64 @@
+/*
+
+   CallSlots.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <utility>      // std::move
+
+
+namespace unimock
+{
+
+template<typename T>
+const std::size_t CallSlots<T>::NONE;
+
+template<typename T>
+CallSlots<T>::CallSlots( T empty )
+:
+   mutex_(),
+   empty_( std::move( empty ) ),
+   values_()
+{
+}
+
+template<typename T>
+template<class Record>
+std::size_t CallSlots<T>::reserve( Record record )
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+
+   // The slot is reserved first, so that it's kept for a call recorded before
+   // the recorder throws, such as a call violating an expectation.
+   values_.push_back( empty_ );
+   const std::size_t slot = values_.size() - 1;
+   record();
+   return slot;
+}
+
+template<typename T>
+void CallSlots<T>::fill( std::size_t slot, T value )
+{
+   if( slot == NONE )
+      return;
+
+   std::lock_guard<std::mutex> lock( mutex_ );
+   values_[ slot ] = std::move( value );
+}
+
+template<typename T>
+std::vector<T> CallSlots<T>::values() const
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+   return values_;
+}
+
+
+} // namespace
@@ -0,0 +1,114 @@
+/*
+
+   CapacityLimiter.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+#include "unimock/Capacity.hh"
+#include "unimock/CapacityExceeded.hh"
+#include "CallSlots.hh"
+
+
+namespace unimock
+{
+
+// Limits the calls served at once to the servers of a capacity, queueing or
+// rejecting the others.
+class CapacityLimiter final
+{
+public:
+
+   // Occupies a server from construction until destruction. The service
+   // time of the call is spent by serve, so the call can be counted as in
+   // flight once it's served rather than while it's queued. A slot without a
+   // limiter does nothing.
+   class Slot final
+   {
+   public:
+
+      // Throws CapacityExceeded if the call is rejected or times out. The
+      // queueing delay goes into the slot reserved along with the call.
+      Slot( CapacityLimiter* limiter, std::size_t delaySlot );
+
+      ~Slot();
+
+      Slot( const Slot& ) = delete;
+      Slot& operator=( const Slot& ) = delete;
+
+      // Sleeps for the service time.
+      void serve() const;
+
+
+   private:
+
+      CapacityLimiter* limiter_;
+
+      std::chrono::nanoseconds serviceTime_;
+
+   };
+
+   explicit CapacityLimiter( Capacity capacity );
+
+   CapacityLimiter( const CapacityLimiter& ) = delete;
+   CapacityLimiter& operator=( const CapacityLimiter& ) = delete;
+
+   // Records a call with the function given, and reserves the slot of its
+   // queueing delay.
+   template<class Record>
+   std::size_t reserve( Record record );
+
+   // Waits for a server and returns the service time of the call. The calls
+   // are served in the order they arrive.
+   std::chrono::nanoseconds acquire( std::size_t delaySlot );
+
+   void release();
+
+   CapacityStatistics getStatistics() const;
+
+
+private:
+
+   const Capacity capacity_;
+
+   mutable std::mutex mutex_;
+
+   std::condition_variable released_;
+
+   std::size_t busy_;
+
+   // The tickets of the waiting calls, in the order they arrived.
+   std::deque<std::uint64_t> queue_;
+
+   std::uint64_t nextTicket_;
+
+   // The queueing delays of the recorded calls.
+   CallSlots<std::chrono::nanoseconds> delays_;
+
+   CapacityStatistics statistics_;
+
+   bool isAvailable_() const;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "CapacityLimiter.icc"
@@ -0,0 +1,124 @@
+/*
+
+   CassetteCall.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <string>
+#include <type_traits>
+
+#include "unimock/Cassette.hh"
+#include "ResponseTable.hh"
+#include "Serializer.hh"
+
+
+namespace unimock
+{
+
+// Serializes the calls of a method with the signature R(Parameters...) to and
+// from a cassette. The key of a call holds the method and the arguments that
+// are passed in, and the value holds the return value and the out parameters,
+// which are the non-const lvalue references.
+template<typename R, typename... Parameters>
+class CassetteCall
+{
+public:
+
+   template<typename P>
+   using IsOut = std::integral_constant<
+      bool,
+      std::is_lvalue_reference<P>::value &&
+      !std::is_const<std::remove_reference_t<P>>::value>;
+
+   // Whether the calls can be put on a cassette at all.
+   using IsSupported = AllOf<
+      !std::is_reference<R>::value,
+      Serializer<ResponseT<R>>::WRITABLE,
+      Serializer<ResponseT<R>>::READABLE,
+      ( Serializer<std::decay_t<Parameters>>::WRITABLE &&
+        ( !IsOut<Parameters>::value ||
+          Serializer<std::decay_t<Parameters>>::READABLE ) )...>;
+
+   // Returns an empty key if the calls can't be put on a cassette.
+   template<class MethodPtr, typename... Arguments>
+   static std::string key(
+      const MethodPtr& methodPtr,
+      const Arguments&... arguments );
+
+   // Reads the return value into the response and the out parameters into
+   // the arguments. Returns false if the call wasn't recorded.
+   template<typename... Arguments>
+   static bool replay(
+      const Cassette& cassette,
+      const std::string& key,
+      ResponseT<R>& response,
+      Arguments&... arguments );
+
+   template<typename... Arguments>
+   static void record(
+      Cassette& cassette,
+      const std::string& key,
+      const ResponseT<R>& response,
+      const Arguments&... arguments );
+
+   // Calls the function and returns its result as a response.
+   template<class F>
+   static ResponseT<R> invoke( F&& function );
+
+   static R result( ResponseT<R>&& response );
+
+
+private:
+
+   template<class MethodPtr, typename... Arguments>
+   static std::string key_(
+      std::true_type,
+      const MethodPtr& methodPtr,
+      const Arguments&... arguments );
+
+   template<class MethodPtr, typename... Arguments>
+   static std::string key_(
+      std::false_type,
+      const MethodPtr& methodPtr,
+      const Arguments&... arguments );
+
+   template<typename P, typename A>
+   static void writeIn_( std::string& bytes, const A& argument );
+
+   template<typename P, typename A>
+   static void writeOut_( std::string& bytes, const A& argument );
+
+   template<typename P, typename A>
+   static bool readOut_( const char*& first, const char* last, A& argument );
+
+   template<typename P, typename A>
+   static bool readOut_(
+      const char*& first, const char* last, A& argument, std::true_type );
+
+   template<typename P, typename A>
+   static bool readOut_(
+      const char*& first, const char* last, A& argument, std::false_type );
+
+   template<class F>
+   static ResponseT<R> invoke_( F&& function, std::true_type );
+
+   template<class F>
+   static ResponseT<R> invoke_( F&& function, std::false_type );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "CassetteCall.tcc"
@@ -0,0 +1,186 @@
+/*
+
+   CassetteCall.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <typeinfo>
+#include <utility>      // std::forward, std::move
+
+
+namespace unimock
+{
+
+template<typename R, typename... Parameters>
+template<class MethodPtr, typename... Arguments>
+std::string CassetteCall<R, Parameters...>::key(
+   const MethodPtr& methodPtr,
+   const Arguments&... arguments )
+{
+   return key_( IsSupported(), methodPtr, arguments... );
+}
+
+template<typename R, typename... Parameters>
+template<class MethodPtr, typename... Arguments>
+std::string CassetteCall<R, Parameters...>::key_(
+   std::true_type,
+   const MethodPtr& methodPtr,
+   const Arguments&... arguments )
+{
+   // The method is identified by its type and the bytes of its pointer.
+   std::string bytes;
+   Serializer<const char*>::write( bytes, typeid( MethodPtr ).name() );
+   bytes.append(
+      reinterpret_cast<const char*>( &methodPtr ), sizeof( MethodPtr ) );
+
+   using Expander = int[];
+   (void)Expander{ 0, ( writeIn_<Parameters>( bytes, arguments ), 0 )... };
+
+   return bytes;
+}
+
+template<typename R, typename... Parameters>
+template<class MethodPtr, typename... Arguments>
+std::string CassetteCall<R, Parameters...>::key_(
+   std::false_type,
+   const MethodPtr&,
+   const Arguments&... )
+{
+   return std::string();
+}
+
+template<typename R, typename... Parameters>
+template<typename... Arguments>
+bool CassetteCall<R, Parameters...>::replay(
+   const Cassette& cassette,
+   const std::string& key,
+   ResponseT<R>& response,
+   Arguments&... arguments )
+{
+   StringView value;
+   if( !cassette.find( key, value ) )
+      return false;
+
+   const char* first = value.data();
+   const char* last = value.data() + value.size();
+   bool read = Serializer<ResponseT<R>>::read( first, last, response );
+
+   using Expander = int[];
+   (void)Expander{ 0, ( read = read &&
+      readOut_<Parameters>( first, last, arguments ), 0 )... };
+
+   return read;
+}
+
+template<typename R, typename... Parameters>
+template<typename... Arguments>
+void CassetteCall<R, Parameters...>::record(
+   Cassette& cassette,
+   const std::string& key,
+   const ResponseT<R>& response,
+   const Arguments&... arguments )
+{
+   std::string value;
+   Serializer<ResponseT<R>>::write( value, response );
+
+   using Expander = int[];
+   (void)Expander{ 0, ( writeOut_<Parameters>( value, arguments ), 0 )... };
+
+   cassette.record( key, value );
+}
+
+template<typename R, typename... Parameters>
+template<class F>
+ResponseT<R> CassetteCall<R, Parameters...>::invoke( F&& function )
+{
+   return invoke_( std::forward<F>( function ), std::is_void<R>() );
+}
+
+template<typename R, typename... Parameters>
+R CassetteCall<R, Parameters...>::result( ResponseT<R>&& response )
+{
+   return static_cast<R>( std::move( response ) );
+}
+
+template<typename R, typename... Parameters>
+template<typename P, typename A>
+void CassetteCall<R, Parameters...>::writeIn_(
+   std::string& bytes,
+   const A& argument )
+{
+   if( !IsOut<P>::value )
+      Serializer<std::decay_t<P>>::write( bytes, argument );
+}
+
+template<typename R, typename... Parameters>
+template<typename P, typename A>
+void CassetteCall<R, Parameters...>::writeOut_(
+   std::string& bytes,
+   const A& argument )
+{
+   if( IsOut<P>::value )
+      Serializer<std::decay_t<P>>::write( bytes, argument );
+}
+
+template<typename R, typename... Parameters>
+template<typename P, typename A>
+bool CassetteCall<R, Parameters...>::readOut_(
+   const char*& first,
+   const char* last,
+   A& argument )
+{
+   return readOut_<P>( first, last, argument, IsOut<P>() );
+}
+
+template<typename R, typename... Parameters>
+template<typename P, typename A>
+bool CassetteCall<R, Parameters...>::readOut_(
+   const char*& first,
+   const char* last,
+   A& argument,
+   std::true_type )
+{
+   return Serializer<std::decay_t<P>>::read( first, last, argument );
+}
+
+template<typename R, typename... Parameters>
+template<typename P, typename A>
+bool CassetteCall<R, Parameters...>::readOut_(
+   const char*&,
+   const char*,
+   A&,
+   std::false_type )
+{
+   return true;
+}
+
+template<typename R, typename... Parameters>
+template<class F>
+ResponseT<R> CassetteCall<R, Parameters...>::invoke_(
+   F&& function,
+   std::true_type )
+{
+   function();
+   return NoResponse();
+}
+
+template<typename R, typename... Parameters>
+template<class F>
+ResponseT<R> CassetteCall<R, Parameters...>::invoke_(
+   F&& function,
+   std::false_type )
+{
+   return ResponseT<R>( function() );
+}
+
+
+} // namespace
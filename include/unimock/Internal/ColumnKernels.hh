@@ -0,0 +1,112 @@
+/*
+
+   ColumnKernels.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstdint>
+#include <type_traits>
+
+
+namespace unimock
+{
+
+// The kernels below aggregate contiguous blocks of arithmetic column data. A
+// kernel can be applied to any number of consecutive blocks, and two kernels
+// covering consecutive ranges of rows can be merged into one. The loops are
+// written without branches and with independent accumulators so that the
+// compiler is able to vectorize them.
+
+template<typename T>
+using SumT = std::conditional_t<
+   std::is_floating_point<T>::value,
+   std::conditional_t<std::is_same<T, long double>::value, long double, double>,
+   std::conditional_t<std::is_signed<T>::value, std::int64_t, std::uint64_t>>;
+
+template<typename T>
+struct SumKernel
+{
+   void operator()( const T* data, std::size_t count );
+
+   void merge( const SumKernel& other );
+
+   SumT<T> result = 0;
+
+};
+
+template<typename T>
+struct MinKernel
+{
+   void operator()( const T* data, std::size_t count );
+
+   void merge( const MinKernel& other );
+
+   bool empty = true;
+
+   T result = T();
+
+};
+
+template<typename T>
+struct MaxKernel
+{
+   void operator()( const T* data, std::size_t count );
+
+   void merge( const MaxKernel& other );
+
+   bool empty = true;
+
+   T result = T();
+
+};
+
+template<typename T>
+struct WithinKernel
+{
+   WithinKernel( T low, T high );
+
+   void operator()( const T* data, std::size_t count );
+
+   void merge( const WithinKernel& other );
+
+   T low;
+
+   T high;
+
+   bool result = true;
+
+};
+
+template<typename T>
+struct MonotonicKernel
+{
+   void operator()( const T* data, std::size_t count );
+
+   void merge( const MonotonicKernel& other );
+
+   bool empty = true;
+
+   T first = T();
+
+   T last = T();
+
+   bool result = true;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "ColumnKernels.tcc"
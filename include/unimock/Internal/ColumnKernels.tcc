@@ -0,0 +1,214 @@
+/*
+
+   ColumnKernels.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+
+namespace unimock
+{
+
+namespace
+{
+// The number of independent accumulators used in the reduction loops. Eight
+// lanes fill a 256 bit vector register with 32 bit elements.
+constexpr const std::size_t KERNEL_LANES = 8;
+
+} // unnamed namespace
+
+
+template<typename T>
+void SumKernel<T>::operator()( const T* data, std::size_t count )
+{
+   // Floating point addition isn't associative, so the compiler won't
+   // vectorize a single accumulator without relaxed math. With independent
+   // accumulators we do the reassociation ourselves.
+   SumT<T> lanes[ KERNEL_LANES ] = {};
+
+   std::size_t i = 0;
+   for( ; i + KERNEL_LANES <= count; i += KERNEL_LANES )
+   {
+      for( std::size_t lane = 0; lane < KERNEL_LANES; lane++ )
+         lanes[ lane ] += static_cast<SumT<T>>( data[ i + lane ] );
+   }
+
+   for( ; i < count; i++ )
+      lanes[ 0 ] += static_cast<SumT<T>>( data[ i ] );
+
+   for( std::size_t lane = 0; lane < KERNEL_LANES; lane++ )
+      result += lanes[ lane ];
+}
+
+template<typename T>
+void SumKernel<T>::merge( const SumKernel& other )
+{
+   result += other.result;
+}
+
+template<typename T>
+void MinKernel<T>::operator()( const T* data, std::size_t count )
+{
+   if( count == 0 )
+      return;
+
+   T lanes[ KERNEL_LANES ];
+   for( std::size_t lane = 0; lane < KERNEL_LANES; lane++ )
+      lanes[ lane ] = data[ 0 ];
+
+   std::size_t i = 0;
+   for( ; i + KERNEL_LANES <= count; i += KERNEL_LANES )
+   {
+      for( std::size_t lane = 0; lane < KERNEL_LANES; lane++ )
+      {
+         lanes[ lane ] =
+            data[ i + lane ] < lanes[ lane ] ? data[ i + lane ] : lanes[ lane ];
+      }
+   }
+
+   for( ; i < count; i++ )
+      lanes[ 0 ] = data[ i ] < lanes[ 0 ] ? data[ i ] : lanes[ 0 ];
+
+   MinKernel<T> block;
+   block.empty = false;
+   block.result = lanes[ 0 ];
+   for( std::size_t lane = 1; lane < KERNEL_LANES; lane++ )
+      block.result =
+         lanes[ lane ] < block.result ? lanes[ lane ] : block.result;
+
+   merge( block );
+}
+
+template<typename T>
+void MinKernel<T>::merge( const MinKernel& other )
+{
+   if( other.empty )
+      return;
+
+   if( empty || other.result < result )
+      result = other.result;
+
+   empty = false;
+}
+
+template<typename T>
+void MaxKernel<T>::operator()( const T* data, std::size_t count )
+{
+   if( count == 0 )
+      return;
+
+   T lanes[ KERNEL_LANES ];
+   for( std::size_t lane = 0; lane < KERNEL_LANES; lane++ )
+      lanes[ lane ] = data[ 0 ];
+
+   std::size_t i = 0;
+   for( ; i + KERNEL_LANES <= count; i += KERNEL_LANES )
+   {
+      for( std::size_t lane = 0; lane < KERNEL_LANES; lane++ )
+      {
+         lanes[ lane ] =
+            lanes[ lane ] < data[ i + lane ] ? data[ i + lane ] : lanes[ lane ];
+      }
+   }
+
+   for( ; i < count; i++ )
+      lanes[ 0 ] = lanes[ 0 ] < data[ i ] ? data[ i ] : lanes[ 0 ];
+
+   MaxKernel<T> block;
+   block.empty = false;
+   block.result = lanes[ 0 ];
+   for( std::size_t lane = 1; lane < KERNEL_LANES; lane++ )
+      block.result =
+         block.result < lanes[ lane ] ? lanes[ lane ] : block.result;
+
+   merge( block );
+}
+
+template<typename T>
+void MaxKernel<T>::merge( const MaxKernel& other )
+{
+   if( other.empty )
+      return;
+
+   if( empty || result < other.result )
+      result = other.result;
+
+   empty = false;
+}
+
+template<typename T>
+WithinKernel<T>::WithinKernel( T low, T high )
+:
+   low( low ),
+   high( high )
+{
+}
+
+template<typename T>
+void WithinKernel<T>::operator()( const T* data, std::size_t count )
+{
+   // We use bitwise operators instead of logical ones to avoid the short
+   // circuit branches.
+   unsigned inside = 1;
+
+   for( std::size_t i = 0; i < count; i++ )
+      inside &= static_cast<unsigned>( low <= data[ i ] ) &
+         static_cast<unsigned>( data[ i ] <= high );
+
+   result = result && inside;
+}
+
+template<typename T>
+void WithinKernel<T>::merge( const WithinKernel& other )
+{
+   result = result && other.result;
+}
+
+template<typename T>
+void MonotonicKernel<T>::operator()( const T* data, std::size_t count )
+{
+   if( count == 0 )
+      return;
+
+   unsigned ordered = 1;
+
+   for( std::size_t i = 1; i < count; i++ )
+      ordered &= static_cast<unsigned>( data[ i - 1 ] <= data[ i ] );
+
+   MonotonicKernel<T> block;
+   block.empty = false;
+   block.first = data[ 0 ];
+   block.last = data[ count - 1 ];
+   block.result = ordered;
+
+   merge( block );
+}
+
+template<typename T>
+void MonotonicKernel<T>::merge( const MonotonicKernel& other )
+{
+   // The other kernel is assumed to cover the rows directly following the rows
+   // covered by this kernel, so the boundary between them must be ordered too.
+   if( other.empty )
+      return;
+
+   if( empty )
+   {
+      *this = other;
+      return;
+   }
+
+   result = result && other.result && last <= other.first;
+   last = other.last;
+}
+
+
+} // namespace
@@ -0,0 +1,98 @@
+/*
+
+   CompressedHistory.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstdint>
+#include <vector>
+#include <functional>
+
+#include "unimock/FiniteID.hh"
+
+
+namespace unimock
+{
+
+// A compressed call history for one function or method whose converted
+// arguments are all integers. Each call is a row of an object index followed
+// by the arguments, widened to 64 bits. Rows are appended to an open chunk
+// that is sealed when full. A sealed chunk stores each column on its own,
+// encoded as runs of equal deltas between consecutive values with the run
+// lengths and the zigzag encoded deltas as varints. Monotonic offsets, small
+// enums and repeated object IDs then take a byte or less per call.
+class CompressedHistory
+{
+public:
+
+   explicit CompressedHistory( std::size_t argumentCount );
+
+   void append( const FiniteID& objectID, const std::int64_t* arguments );
+
+   // Calls the visitor with the arguments of each row recorded for the object,
+   // or for all objects if the object ID is empty, in the recorded order.
+   void forEach(
+      const FiniteID& objectID,
+      const std::function<void(const std::int64_t*)>& visitor ) const;
+
+   std::size_t size() const noexcept;
+
+   // The number of bytes held by the chunks, not counting the bookkeeping.
+   std::size_t memoryUsage() const noexcept;
+
+
+private:
+
+   struct Chunk_
+   {
+      std::size_t rowCount;
+      std::vector<std::uint8_t> bytes;
+   };
+
+   std::size_t columnCount_;
+
+   std::size_t size_;
+
+   std::vector<FiniteID> objectIDs_;
+
+   std::size_t lastObjectIndex_;
+
+   std::vector<Chunk_> chunks_;
+
+   // Rows of the open chunk, one after the other.
+   std::vector<std::int64_t> openRows_;
+
+   std::size_t objectIndex_( const FiniteID& objectID );
+
+   void seal_();
+
+   static void encodeColumn_(
+      const std::int64_t* values,
+      std::size_t stride,
+      std::size_t count,
+      std::vector<std::uint8_t>& bytes );
+
+   static const std::uint8_t* decodeColumn_(
+      const std::uint8_t* bytes,
+      std::int64_t* values,
+      std::size_t stride,
+      std::size_t count );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "CompressedHistory.icc"
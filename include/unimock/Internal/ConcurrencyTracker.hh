@@ -0,0 +1,115 @@
+/*
+
+   ConcurrencyTracker.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t
+#include <atomic>
+#include <chrono>
+#include <memory>       // std::unique_ptr
+
+#include "unimock/ConcurrencyProfile.hh"
+
+
+namespace unimock
+{
+
+// Counts the calls in flight. A call entering or leaving updates the count
+// and takes the index of its sample in one atomic operation, so the samples
+// are in the order of the count updates and no lock is taken. The samples go
+// into a buffer allocated up front, and the events beyond it aren't sampled.
+class ConcurrencyTracker final
+{
+public:
+
+   // Enters a call on construction and leaves it on destruction. A scope
+   // without a tracker does nothing.
+   class Scope final
+   {
+   public:
+
+      explicit Scope( ConcurrencyTracker* tracker );
+
+      ~Scope();
+
+      Scope( const Scope& ) = delete;
+      Scope& operator=( const Scope& ) = delete;
+
+
+   private:
+
+      ConcurrencyTracker* tracker_;
+
+   };
+
+   static const std::size_t DEFAULT_SAMPLE_CAPACITY = 1 << 16;
+
+   explicit ConcurrencyTracker(
+      std::size_t sampleCapacity = DEFAULT_SAMPLE_CAPACITY );
+
+   ConcurrencyTracker( const ConcurrencyTracker& ) = delete;
+   ConcurrencyTracker& operator=( const ConcurrencyTracker& ) = delete;
+
+   void enter();
+
+   void leave();
+
+   ConcurrencyProfile getProfile() const;
+
+
+private:
+
+   using Clock = std::chrono::steady_clock;
+
+   // A sample is published by setting written once it's filled in.
+   struct Sample_
+   {
+      Sample_();
+
+      std::atomic<bool> written;
+
+      std::chrono::nanoseconds time;
+
+      std::size_t inFlight;
+   };
+
+   // The state holds the number of events, the calls entering and leaving,
+   // above the number of calls in flight.
+   static const unsigned IN_FLIGHT_BITS = 20;
+
+   static const std::uint64_t IN_FLIGHT_MASK =
+      ( std::uint64_t( 1 ) << IN_FLIGHT_BITS ) - 1;
+
+   const Clock::time_point start_;
+
+   std::atomic<std::size_t> calls_;
+
+   std::atomic<std::size_t> maxInFlight_;
+
+   std::atomic<std::uint64_t> state_;
+
+   const std::size_t sampleCapacity_;
+
+   std::unique_ptr<Sample_[]> samples_;
+
+   void sample_( std::uint64_t previousState, std::size_t inFlight );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "ConcurrencyTracker.icc"
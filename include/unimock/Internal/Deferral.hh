@@ -0,0 +1,53 @@
+/*
+
+   Deferral.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <chrono>
+#include <future>
+#include <memory>       // std::shared_ptr
+#include <type_traits>
+#include <utility>      // std::move
+
+#include "unimock/VirtualScheduler.hh"
+
+
+namespace unimock
+{
+
+// True for the std::future results that can be deferred.
+template<typename R>
+struct IsFuture : std::false_type {};
+
+template<typename T>
+struct IsFuture<std::future<T>> : std::true_type {};
+
+// The virtual latency of the future results of a method.
+struct Deferral
+{
+   Deferral(
+      std::shared_ptr<VirtualScheduler> scheduler,
+      std::chrono::nanoseconds latency )
+   :
+      scheduler( std::move( scheduler ) ),
+      latency( latency )
+   {
+   }
+
+   std::shared_ptr<VirtualScheduler> scheduler;
+
+   std::chrono::nanoseconds latency;
+};
+
+
+} // namespace
@@ -0,0 +1,200 @@
+/*
+
+   Differential.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <chrono>
+#include <memory>       // std::unique_ptr, std::shared_ptr
+#include <mutex>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <type_traits>
+#include <utility>      // std::declval
+
+#include "unimock/DifferentialReport.hh"
+#include "MethodKey.hh"
+#include "TaskQueue.hh"
+#include "ResponseTable.hh"
+
+
+namespace unimock
+{
+
+// Whether the values of a type can be compared with operator==.
+template<typename T, typename Enable = void>
+struct IsEqualityComparable : std::false_type {};
+
+template<typename T>
+struct IsEqualityComparable<
+   T,
+   decltype( std::declval<const T&>() == std::declval<const T&>(), void() )>
+   : std::true_type {};
+
+// Whether a parameter lets the implementation write to the caller's values;
+// a reference or a pointer to non-const.
+template<typename T>
+using IsOutParameter = std::integral_constant<
+   bool,
+   ( std::is_lvalue_reference<T>::value &&
+      !std::is_const<std::remove_reference_t<T>>::value ) ||
+   ( std::is_pointer<T>::value &&
+      !std::is_const<std::remove_pointer_t<T>>::value )>;
+
+// How an argument is kept for the candidate, so that the candidate can't reach
+// the caller's values and its calls may run after the caller has returned.
+// Values are copied, and pointers to const are given copies of the objects
+// they point to, while C strings are copied into strings. Calls with other
+// pointers, that the candidate could write through, aren't mirrored.
+template<typename T, typename Enable = void>
+struct CandidateArgument
+{
+   using Stored = T;
+
+   static constexpr bool MIRRORED = std::is_copy_constructible<T>::value;
+
+   template<typename Argument>
+   static Stored copy( const Argument& argument )
+   {
+      return Stored( argument );
+   }
+
+   static Stored& pass( Stored& argument ) noexcept
+   {
+      return argument;
+   }
+};
+
+// A pointer kept for the candidate, along with the copy it points to.
+template<typename T>
+struct CandidatePointer
+{
+   std::shared_ptr<const void> object;
+
+   T* pointer;
+};
+
+template<typename T>
+struct CandidateArgument<T*, std::enable_if_t<!std::is_function<T>::value>>
+{
+   using Stored = CandidatePointer<T>;
+
+   static constexpr bool MIRRORED =
+      std::is_const<T>::value &&
+      std::is_copy_constructible<T>::value &&
+      !std::is_polymorphic<T>::value;
+
+   static Stored copy( T* argument )
+   {
+      if( !argument )
+         return Stored{ nullptr, nullptr };
+
+      auto object = std::make_shared<std::remove_const_t<T>>( *argument );
+      return Stored{ object, object.get() };
+   }
+
+   static T*& pass( Stored& argument ) noexcept
+   {
+      return argument.pointer;
+   }
+};
+
+template<>
+struct CandidateArgument<const char*>
+{
+   using Stored = CandidatePointer<const char>;
+
+   static constexpr bool MIRRORED = true;
+
+   static Stored copy( const char* argument )
+   {
+      if( !argument )
+         return Stored{ nullptr, nullptr };
+
+      auto characters = std::make_shared<std::string>( argument );
+      return Stored{ characters, characters->c_str() };
+   }
+
+   static const char*& pass( Stored& argument ) noexcept
+   {
+      return argument.pointer;
+   }
+};
+
+template<typename T>
+using CandidateArgumentT = typename CandidateArgument<std::decay_t<T>>::Stored;
+
+// The outcome of comparing the primary and the candidate call.
+enum class Comparison { MATCH, MISMATCH, NOT_COMPARED };
+
+// Collects the differential reports of the methods of a mock, and runs the
+// calls to the candidate either inline or on a worker thread of its own.
+class Differential final
+{
+public:
+
+   using DurationT = std::chrono::steady_clock::duration;
+
+   explicit Differential( bool asynchronous );
+
+   Differential( const Differential& ) = delete;
+   Differential& operator=( const Differential& ) = delete;
+
+   // Runs a mirrored call to the candidate. The task must not throw.
+   void run( std::function<void()> task );
+
+   // Waits until the mirrored calls run so far are reported.
+   void flush();
+
+   void report(
+      const MethodKey& methodKey,
+      DurationT primaryLatency,
+      DurationT candidateLatency,
+      Comparison comparison );
+
+   DifferentialReport getReport( const MethodKey& methodKey ) const;
+
+   // Compares the results, which are never compared for methods with out
+   // parameters, since their values written by the candidate are discarded.
+   template<typename... FncParameters, typename T>
+   static Comparison compare( const T& primary, const T& candidate );
+
+
+private:
+
+   mutable std::mutex mutex_;
+
+   std::unordered_map<MethodKey, DifferentialReport, MethodKeyHash> reports_;
+
+   // Destroyed first, so the worker is joined before the reports go away.
+   std::unique_ptr<TaskQueue> taskQueue_;
+
+   template<typename T>
+   static Comparison compare_(
+      const T& primary, const T& candidate, std::true_type );
+
+   template<typename T>
+   static Comparison compare_(
+      const T& primary, const T& candidate, std::false_type );
+
+   static Comparison compare_(
+      const NoResponse& primary, const NoResponse& candidate, std::false_type );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "Differential.icc"
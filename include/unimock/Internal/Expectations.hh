@@ -0,0 +1,117 @@
+/*
+
+   Expectations.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <string>
+#include <vector>
+#include <functional>
+#include <mutex>
+
+
+namespace unimock
+{
+
+// Expectations on the recorded calls, checked as the calls are recorded. Each
+// expectation is a small state machine in a flat table. The hooks attached to
+// the functions and methods involved drive the state machines by index, and
+// report a violation as soon as one is detected. The table is locked while a
+// state machine moves, but not while a violation is reported, so the handler
+// may throw or record calls itself.
+class Expectations
+{
+public:
+
+   Expectations();
+
+   // The handler is called with a description of each violation. The default
+   // handler throws ExpectationViolation.
+   void setViolationHandler(
+      std::function<void(const std::string&)> violationHandler );
+
+   // Adds an expectation and returns its index.
+   std::size_t addCallCount( std::size_t count );
+
+   std::size_t addOrder();
+
+   std::size_t addWindow( std::size_t limit );
+
+   std::size_t addNever();
+
+   // Events driving the expectation with the index provided.
+   void call( std::size_t expectation );
+
+   void first( std::size_t expectation );
+
+   void second( std::size_t expectation );
+
+   void marker( std::size_t expectation );
+
+   void violate( std::size_t expectation );
+
+   // Reports the expectations that need more calls to be met.
+   void verify() const;
+
+
+private:
+
+   enum class Kind_ { CALL_COUNT, ORDER, WINDOW, NEVER };
+
+   struct Expectation_
+   {
+      Expectation_( Kind_ kind, std::size_t limit )
+      :
+         kind( kind ),
+         limit( limit ),
+         count( 0 ),
+         violated( false )
+      {
+      }
+
+      Kind_ kind;
+
+      // The number of calls allowed, and the number of calls seen in total or
+      // since the last marker. For an order, the count tells whether the
+      // first call is seen.
+      std::size_t limit;
+
+      std::size_t count;
+
+      // Each expectation is reported once, even if the handler doesn't throw.
+      bool violated;
+   };
+
+   mutable std::mutex mutex_;
+
+   std::vector<Expectation_> expectations_;
+
+   std::function<void(const std::string&)> violationHandler_;
+
+   // Marks an expectation as violated and returns the description, or an
+   // empty string if it's already reported. Called with the lock held.
+   std::string violation_(
+      std::size_t expectation,
+      const std::string& message );
+
+   // Calls the handler with a description unless it's empty.
+   void report_( const std::string& violation ) const;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "Expectations.icc"
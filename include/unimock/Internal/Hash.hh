@@ -0,0 +1,42 @@
+/*
+
+   Hash.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstdint>
+#include <tuple>
+
+
+namespace unimock
+{
+
+std::uint64_t mix64( std::uint64_t value ) noexcept;
+
+std::size_t hashCombine( std::size_t seed, std::size_t hash ) noexcept;
+
+std::uint64_t hashBytes( const void* data, std::size_t size ) noexcept;
+
+template<class Tuple>
+struct TupleHash
+{
+   std::size_t operator()( const Tuple& tuple ) const;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "Hash.tcc"
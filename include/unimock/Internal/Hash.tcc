@@ -0,0 +1,94 @@
+/*
+
+   Hash.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <functional>   // std::hash
+#include <utility>      // std::index_sequence
+#include <type_traits>  // std::decay_t
+#include <cstring>      // std::memcpy
+
+
+namespace unimock
+{
+
+namespace
+{
+template<class Tuple, std::size_t... indices>
+std::size_t hashTuple( const Tuple& tuple, std::index_sequence<indices...> )
+{
+   std::size_t seed = 0;
+
+   // Expand the elements in order by means of an initializer list.
+   using Expander = int[];
+   (void)Expander{ 0, ( seed = hashCombine(
+      seed,
+      std::hash<std::decay_t<std::tuple_element_t<indices, Tuple>>>()(
+         std::get<indices>( tuple ) ) ), 0 )... };
+
+   return seed;
+}
+
+} // unnamed namespace
+
+
+inline std::uint64_t mix64( std::uint64_t value ) noexcept
+{
+   // The finalizer of SplitMix64. It spreads every input bit over the whole
+   // output, which std::hash doesn't do for integers.
+   value = ( value ^ ( value >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+   value = ( value ^ ( value >> 27 ) ) * 0x94d049bb133111ebULL;
+
+   return value ^ ( value >> 31 );
+}
+
+inline std::size_t hashCombine( std::size_t seed, std::size_t hash ) noexcept
+{
+   // The combination step from Boost's hash_combine.
+   return seed ^ ( hash + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 ) );
+}
+
+inline std::uint64_t hashBytes( const void* data, std::size_t size ) noexcept
+{
+   // We process eight bytes at a time and mix each word into the state. The
+   // bytes are copied with memcpy since the data may be unaligned.
+   auto bytes = static_cast<const unsigned char*>( data );
+   std::uint64_t state = 0x9e3779b97f4a7c15ULL ^ size;
+
+   std::size_t i = 0;
+   for( ; i + sizeof( std::uint64_t ) <= size; i += sizeof( std::uint64_t ) )
+   {
+      std::uint64_t word;
+      std::memcpy( &word, bytes + i, sizeof( word ) );
+      state = mix64( state ^ word );
+   }
+
+   if( i < size )
+   {
+      std::uint64_t word = 0;
+      std::memcpy( &word, bytes + i, size - i );
+      state = mix64( state ^ word );
+   }
+
+   return mix64( state );
+}
+
+template<class Tuple>
+std::size_t TupleHash<Tuple>::operator()( const Tuple& tuple ) const
+{
+   return hashTuple(
+      tuple, std::make_index_sequence<std::tuple_size<Tuple>::value>() );
+}
+
+
+} // namespace
@@ -0,0 +1,125 @@
+/*
+
+   MemoTable.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <tuple>
+#include <list>
+#include <unordered_map>
+#include <memory>       // std::shared_ptr
+#include <mutex>
+#include <type_traits>
+#include <utility>      // std::declval
+
+#include "unimock/DefaultConversionPolicy.hh"
+#include "ResponseTable.hh"
+#include "Hash.hh"
+
+
+namespace unimock
+{
+
+class MemoTableI
+{
+public:
+
+   virtual ~MemoTableI() {}
+
+   virtual std::size_t hits() const = 0;
+
+   virtual std::size_t misses() const = 0;
+
+   virtual std::size_t size() const = 0;
+
+};
+
+// Results of a function or method memoized by its arguments, evicting the
+// least recently used result when full. The arguments are converted with the
+// DefaultConversionPolicy into a key, so pointers are keyed by what they point
+// to. Like in the ResponseTable, the keys are only made and hashed in
+// functions set by the constructor, so that the argument types only need to be
+// convertible and hashable for memoized methods.
+template<typename R, typename... Parameters>
+class MemoTable : public MemoTableI
+{
+public:
+
+   explicit MemoTable( std::size_t capacity );
+
+   // Looks up the result of a call and counts a hit or a miss.
+   template<typename... Arguments>
+   bool find( ResponseT<R>& result, const Arguments&... arguments );
+
+   // Makes the key to insert the result of a call with, before the arguments
+   // are passed on to the function and possibly moved from.
+   template<typename... Arguments>
+   std::shared_ptr<void> key( const Arguments&... arguments ) const;
+
+   void insert( const std::shared_ptr<void>& key, const ResponseT<R>& result );
+
+   std::size_t hits() const override;
+
+   std::size_t misses() const override;
+
+   std::size_t size() const override;
+
+
+private:
+
+   struct State_;
+
+   mutable std::mutex mutex_;
+
+   std::shared_ptr<State_> state_;
+
+   std::size_t hits_;
+
+   std::size_t misses_;
+
+   std::size_t size_;
+
+   bool (*find_)(
+      State_& state,
+      ResponseT<R>& result,
+      const std::remove_reference_t<Parameters>&... arguments );
+
+   std::shared_ptr<void> (*key_)(
+      const std::remove_reference_t<Parameters>&... arguments );
+
+   std::size_t (*insert_)(
+      State_& state,
+      const std::shared_ptr<void>& key,
+      const ResponseT<R>& result );
+
+   static bool findResult_(
+      State_& state,
+      ResponseT<R>& result,
+      const std::remove_reference_t<Parameters>&... arguments );
+
+   static std::shared_ptr<void> makeKey_(
+      const std::remove_reference_t<Parameters>&... arguments );
+
+   static std::size_t insertResult_(
+      State_& state,
+      const std::shared_ptr<void>& key,
+      const ResponseT<R>& result );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "MemoTable.tcc"
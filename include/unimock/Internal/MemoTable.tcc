@@ -0,0 +1,195 @@
+/*
+
+   MemoTable.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cassert>
+#include <utility>      // std::move
+
+
+namespace unimock
+{
+
+// The results are kept in a hash table by their arguments, and the arguments
+// in a list from the most to the least recently used.
+template<typename R, typename... Parameters>
+struct MemoTable<R, Parameters...>::State_
+{
+   using ArgumentsT = std::tuple<decltype(
+      DefaultConversionPolicy::convert(
+         std::declval<const std::remove_reference_t<Parameters>&>() ) )...>;
+
+   using OrderT = std::list<const ArgumentsT*>;
+
+   struct Entry
+   {
+      Entry( const ResponseT<R>& result )
+      :
+         result( result ),
+         position()
+      {
+      }
+
+      ResponseT<R> result;
+
+      typename OrderT::iterator position;
+
+   };
+
+   explicit State_( std::size_t capacity )
+   :
+      capacity( capacity ),
+      order(),
+      entries()
+   {
+   }
+
+   std::size_t capacity;
+
+   OrderT order;
+
+   std::unordered_map<ArgumentsT, Entry, TupleHash<ArgumentsT>> entries;
+
+};
+
+template<typename R, typename... Parameters>
+MemoTable<R, Parameters...>::MemoTable( std::size_t capacity )
+:
+   mutex_(),
+   state_( std::make_shared<State_>( capacity ) ),
+   hits_( 0 ),
+   misses_( 0 ),
+   size_( 0 ),
+   find_( &findResult_ ),
+   key_( &makeKey_ ),
+   insert_( &insertResult_ )
+{
+   assert( capacity > 0 );
+}
+
+template<typename R, typename... Parameters>
+template<typename... Arguments>
+bool MemoTable<R, Parameters...>::find(
+   ResponseT<R>& result,
+   const Arguments&... arguments )
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+
+   if( find_( *state_, result, arguments... ) )
+   {
+      ++hits_;
+      return true;
+   }
+
+   ++misses_;
+   return false;
+}
+
+template<typename R, typename... Parameters>
+template<typename... Arguments>
+std::shared_ptr<void> MemoTable<R, Parameters...>::key(
+   const Arguments&... arguments ) const
+{
+   return key_( arguments... );
+}
+
+template<typename R, typename... Parameters>
+void MemoTable<R, Parameters...>::insert(
+   const std::shared_ptr<void>& key,
+   const ResponseT<R>& result )
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+   size_ = insert_( *state_, key, result );
+}
+
+template<typename R, typename... Parameters>
+std::size_t MemoTable<R, Parameters...>::hits() const
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+   return hits_;
+}
+
+template<typename R, typename... Parameters>
+std::size_t MemoTable<R, Parameters...>::misses() const
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+   return misses_;
+}
+
+template<typename R, typename... Parameters>
+std::size_t MemoTable<R, Parameters...>::size() const
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+   return size_;
+}
+
+template<typename R, typename... Parameters>
+bool MemoTable<R, Parameters...>::findResult_(
+   State_& state,
+   ResponseT<R>& result,
+   const std::remove_reference_t<Parameters>&... arguments )
+{
+   using ArgumentsT = typename State_::ArgumentsT;
+
+   auto entry = state.entries.find(
+      ArgumentsT( DefaultConversionPolicy::convert( arguments )... ) );
+   if( entry == state.entries.end() )
+      return false;
+
+   // A hit makes the result the most recently used.
+   state.order.splice(
+      state.order.begin(), state.order, entry->second.position );
+   result = entry->second.result;
+   return true;
+}
+
+template<typename R, typename... Parameters>
+std::shared_ptr<void> MemoTable<R, Parameters...>::makeKey_(
+   const std::remove_reference_t<Parameters>&... arguments )
+{
+   return std::make_shared<typename State_::ArgumentsT>(
+      DefaultConversionPolicy::convert( arguments )... );
+}
+
+template<typename R, typename... Parameters>
+std::size_t MemoTable<R, Parameters...>::insertResult_(
+   State_& state,
+   const std::shared_ptr<void>& key,
+   const ResponseT<R>& result )
+{
+   using ArgumentsT = typename State_::ArgumentsT;
+
+   // Another thread may have inserted the same arguments in the meantime.
+   auto inserted = state.entries.emplace(
+      std::move( *static_cast<ArgumentsT*>( key.get() ) ),
+      typename State_::Entry( result ) );
+   if( !inserted.second )
+      return state.entries.size();
+
+   state.order.push_front( &inserted.first->first );
+   inserted.first->second.position = state.order.begin();
+
+   if( state.entries.size() > state.capacity )
+   {
+      // The key to erase lives in the entry itself, so we find the entry
+      // before erasing it.
+      auto leastRecent = state.entries.find( *state.order.back() );
+      state.order.pop_back();
+      state.entries.erase( leastRecent );
+   }
+
+   return state.entries.size();
+}
+
+
+} // namespace
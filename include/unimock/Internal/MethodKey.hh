@@ -0,0 +1,75 @@
+/*
+
+   MethodKey.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <typeindex>
+
+
+namespace unimock
+{
+
+// A key identifying a non-member function, a static member function, or a
+// class method, without regard to any object. It's used to look up settings
+// and state kept per function or method.
+class MethodKey
+{
+public:
+
+   template<typename R, typename... Parameters>
+   MethodKey( R(*functionPtr)(Parameters...) );
+
+   template<typename R, class T, typename... Parameters>
+   MethodKey( R(T::*methodPtr)(Parameters...) );
+
+   template<typename R, class T, typename... Parameters>
+   MethodKey( R(T::*methodPtr)(Parameters...) const );
+
+   template<class FunctionPtr, class MethodPtr>
+   MethodKey(
+      const std::type_index& typeIndex,
+      FunctionPtr functionPtr,
+      MethodPtr methodPtr );
+
+   bool operator==( const MethodKey& other ) const noexcept;
+
+   bool operator!=( const MethodKey& other ) const noexcept;
+
+   std::size_t hash() const noexcept;
+
+
+private:
+
+   class VoidType_;
+
+   std::type_index typeIndex_;
+
+   void(*functionPtr_)();
+
+   void(VoidType_::*methodPtr_)();
+
+};
+
+struct MethodKeyHash
+{
+   std::size_t operator()( const MethodKey& methodKey ) const noexcept;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "MethodKey.tcc"
@@ -0,0 +1,95 @@
+/*
+
+   MethodKey.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include "Hash.hh"
+
+
+namespace unimock
+{
+
+template<typename R, typename... Parameters>
+MethodKey::MethodKey( R(*functionPtr)(Parameters...) )
+:
+   MethodKey(
+      typeid( decltype( functionPtr ) ),
+      functionPtr,
+      static_cast<void(VoidType_::*)()>( nullptr ) )
+{
+}
+
+template<typename R, class T, typename... Parameters>
+MethodKey::MethodKey( R(T::*methodPtr)(Parameters...) )
+:
+   MethodKey(
+      typeid( decltype( methodPtr ) ),
+      static_cast<void(*)()>( nullptr ),
+      methodPtr )
+{
+}
+
+template<typename R, class T, typename... Parameters>
+MethodKey::MethodKey( R(T::*methodPtr)(Parameters...) const )
+:
+   MethodKey(
+      typeid( decltype( methodPtr ) ),
+      static_cast<void(*)()>( nullptr ),
+      methodPtr )
+{
+}
+
+template<class FunctionPtr, class MethodPtr>
+MethodKey::MethodKey(
+   const std::type_index& typeIndex,
+   FunctionPtr functionPtr,
+   MethodPtr methodPtr )
+:
+   typeIndex_( typeIndex ),
+   functionPtr_( reinterpret_cast<void(*)()>( functionPtr ) ),
+   methodPtr_( reinterpret_cast<void(VoidType_::*)()>( methodPtr ) )
+{
+}
+
+inline bool MethodKey::operator==( const MethodKey& other ) const noexcept
+{
+   // WARNING! The == comparison of the converted method pointers is
+   // unspecified by the standard, see [C++14, §5.10/3 Equality operators]. It
+   // works on many compilers though, just like in CallRecorder.
+   return typeIndex_ == other.typeIndex_ &&
+      functionPtr_ == other.functionPtr_ &&
+      methodPtr_ == other.methodPtr_;
+}
+
+inline bool MethodKey::operator!=( const MethodKey& other ) const noexcept
+{
+   return !( *this == other );
+}
+
+inline std::size_t MethodKey::hash() const noexcept
+{
+   // We don't hash the type index since std::type_index::hash_code may hash
+   // the whole type name. Keys that are equal have equal pointers anyway.
+   return hashCombine(
+      hashBytes( &functionPtr_, sizeof( functionPtr_ ) ),
+      hashBytes( &methodPtr_, sizeof( methodPtr_ ) ) );
+}
+
+inline std::size_t MethodKeyHash::operator()(
+   const MethodKey& methodKey ) const noexcept
+{
+   return methodKey.hash();
+}
+
+
+} // namespace
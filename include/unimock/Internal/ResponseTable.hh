@@ -0,0 +1,209 @@
+/*
+
+   ResponseTable.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <tuple>
+#include <vector>
+#include <unordered_map>
+#include <list>
+#include <string>
+#include <atomic>
+#include <memory>       // std::shared_ptr
+#include <type_traits>
+#include <utility>      // std::index_sequence
+
+#include "Hash.hh"
+
+
+namespace unimock
+{
+
+// Stands in for the response of a function returning void.
+struct NoResponse {};
+
+template<typename R>
+using ResponseT =
+   std::conditional_t<std::is_void<R>::value, NoResponse, std::decay_t<R>>;
+
+template<bool...>
+struct BoolPack;
+
+// True if all the values are true.
+template<bool... values>
+using AllOf =
+   std::is_same<BoolPack<true, values...>, BoolPack<values..., true>>;
+
+// How an argument of some type is kept in the key of a response, and how it's
+// referred to when a response is looked up. Arguments are kept as copies and
+// referred to by pointer, so a lookup doesn't copy them.
+template<typename T>
+struct ResponseKey
+{
+   using Owned = T;
+
+   using View = const T*;
+
+   static Owned own( T argument );
+
+   static View view( const T& argument ) noexcept;
+
+   static std::size_t hash( View argument );
+
+   static bool equal( View lhs, View rhs );
+};
+
+// C strings are kept as strings and looked up by their characters, like the
+// DefaultConversionPolicy converts them. A null pointer is keyed like an empty
+// string.
+template<>
+struct ResponseKey<const char*>
+{
+   using Owned = std::string;
+
+   using View = const char*;
+
+   static Owned own( const char* argument );
+
+   static View view( const char* argument ) noexcept;
+
+   static View view( const std::string& argument ) noexcept;
+
+   static std::size_t hash( View argument ) noexcept;
+
+   static bool equal( View lhs, View rhs ) noexcept;
+};
+
+template<>
+struct ResponseKey<char*> : public ResponseKey<const char*>
+{
+};
+
+// Hashes and compares the views of all arguments in a key.
+template<typename... Ts>
+struct ResponseKeysHash
+{
+   std::size_t operator()(
+      const std::tuple<typename ResponseKey<Ts>::View...>& keys ) const;
+};
+
+template<typename... Ts>
+struct ResponseKeysEqual
+{
+   bool operator()(
+      const std::tuple<typename ResponseKey<Ts>::View...>& lhs,
+      const std::tuple<typename ResponseKey<Ts>::View...>& rhs ) const;
+};
+
+class ResponseTableI
+{
+public:
+
+   virtual ~ResponseTableI() {}
+
+};
+
+// Precomputed responses to the calls of a function or method. A response is
+// looked up by the arguments of the call in a hash table, and otherwise taken
+// from a sequence by the number of calls made since the sequence was set.
+// C string arguments are matched by their characters, not by their address.
+template<typename R, typename... Parameters>
+class ResponseTable : public ResponseTableI
+{
+public:
+
+   using ArgumentsT = std::tuple<std::decay_t<Parameters>...>;
+
+   ResponseTable();
+
+   bool empty() const noexcept;
+
+   void set( ArgumentsT arguments, ResponseT<R> response );
+
+   void setSequence( std::vector<ResponseT<R>> responses );
+
+   // Returns the response to a call, or nullptr if there is none. Each call
+   // counts, whether it gets a response or not.
+   template<typename... Arguments>
+   const ResponseT<R>* respond( const Arguments&... arguments );
+
+   // Converts a response to the result of a call.
+   static R result( const ResponseT<R>& response );
+
+
+private:
+
+   // The arguments of the responses are kept in a list, where they stay put,
+   // and the responses are looked up by views of them. A call is then looked
+   // up by views of its arguments, without copying them.
+   using KeysT_ = std::tuple<
+      typename ResponseKey<std::decay_t<Parameters>>::View...>;
+
+   using OwnedKeysT_ = std::tuple<
+      typename ResponseKey<std::decay_t<Parameters>>::Owned...>;
+
+   struct Responses_
+   {
+      Responses_() : keys(), responses() {}
+
+      std::list<OwnedKeysT_> keys;
+
+      std::unordered_map<
+         KeysT_,
+         ResponseT<R>,
+         ResponseKeysHash<std::decay_t<Parameters>...>,
+         ResponseKeysEqual<std::decay_t<Parameters>...>> responses;
+   };
+
+   // The responses by arguments are type erased and looked up through a
+   // function set along with the first response. This way the argument types
+   // only need to be hashable when responses are set.
+   std::shared_ptr<void> responses_;
+
+   const ResponseT<R>* (*lookup_)(
+      const void* responses,
+      const std::remove_reference_t<Parameters>&... arguments );
+
+   std::vector<ResponseT<R>> sequence_;
+
+   // Counted by every call, from any thread.
+   std::atomic<std::size_t> callCount_;
+
+   template<std::size_t... I>
+   static KeysT_ ownedViews_(
+      const OwnedKeysT_& keys,
+      std::index_sequence<I...> ) noexcept;
+
+   template<std::size_t... I>
+   static OwnedKeysT_ own_( ArgumentsT&& arguments, std::index_sequence<I...> );
+
+   static const ResponseT<R>* find_(
+      const void* responses,
+      const std::remove_reference_t<Parameters>&... arguments );
+
+   // Responses of types that can't be copied are never set, so the second
+   // overload only exists to keep the call paths compiling for such types.
+   static R result_( const ResponseT<R>& response, std::true_type );
+   static R result_( const ResponseT<R>& response, std::false_type );
+
+   using IsCopyable_ = std::is_copy_constructible<ResponseT<R>>;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "ResponseTable.tcc"
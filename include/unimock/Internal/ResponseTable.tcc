@@ -0,0 +1,262 @@
+/*
+
+   ResponseTable.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <utility>      // std::move
+#include <cstring>      // std::strlen, std::strcmp
+#include <functional>   // std::hash
+
+
+namespace unimock
+{
+
+template<typename T>
+auto ResponseKey<T>::own( T argument ) -> Owned
+{
+   return argument;
+}
+
+template<typename T>
+auto ResponseKey<T>::view( const T& argument ) noexcept -> View
+{
+   return &argument;
+}
+
+template<typename T>
+std::size_t ResponseKey<T>::hash( View argument )
+{
+   return std::hash<T>()( *argument );
+}
+
+template<typename T>
+bool ResponseKey<T>::equal( View lhs, View rhs )
+{
+   return *lhs == *rhs;
+}
+
+inline auto ResponseKey<const char*>::own( const char* argument ) -> Owned
+{
+   return argument ? std::string( argument ) : std::string();
+}
+
+inline auto ResponseKey<const char*>::view( const char* argument ) noexcept
+   -> View
+{
+   return argument ? argument : "";
+}
+
+inline auto ResponseKey<const char*>::view(
+   const std::string& argument ) noexcept -> View
+{
+   return argument.c_str();
+}
+
+inline std::size_t ResponseKey<const char*>::hash( View argument ) noexcept
+{
+   return static_cast<std::size_t>(
+      hashBytes( argument, std::strlen( argument ) ) );
+}
+
+inline bool ResponseKey<const char*>::equal( View lhs, View rhs ) noexcept
+{
+   return std::strcmp( lhs, rhs ) == 0;
+}
+
+namespace
+{
+template<typename... Ts, std::size_t... I>
+std::size_t hashResponseKeys(
+   const std::tuple<typename ResponseKey<Ts>::View...>& keys,
+   std::index_sequence<I...> )
+{
+   std::size_t seed = 0;
+
+   using Expander = int[];
+   (void)Expander{ 0, ( seed = hashCombine(
+      seed, ResponseKey<Ts>::hash( std::get<I>( keys ) ) ), 0 )... };
+
+   return seed;
+}
+
+template<typename... Ts, std::size_t... I>
+bool equalResponseKeys(
+   const std::tuple<typename ResponseKey<Ts>::View...>& lhs,
+   const std::tuple<typename ResponseKey<Ts>::View...>& rhs,
+   std::index_sequence<I...> )
+{
+   bool equal = true;
+
+   using Expander = int[];
+   (void)Expander{ 0, ( equal = equal && ResponseKey<Ts>::equal(
+      std::get<I>( lhs ), std::get<I>( rhs ) ), 0 )... };
+
+   return equal;
+}
+
+} // unnamed namespace
+
+template<typename... Ts>
+std::size_t ResponseKeysHash<Ts...>::operator()(
+   const std::tuple<typename ResponseKey<Ts>::View...>& keys ) const
+{
+   return hashResponseKeys<Ts...>( keys, std::index_sequence_for<Ts...>() );
+}
+
+template<typename... Ts>
+bool ResponseKeysEqual<Ts...>::operator()(
+   const std::tuple<typename ResponseKey<Ts>::View...>& lhs,
+   const std::tuple<typename ResponseKey<Ts>::View...>& rhs ) const
+{
+   return equalResponseKeys<Ts...>(
+      lhs, rhs, std::index_sequence_for<Ts...>() );
+}
+
+template<typename R, typename... Parameters>
+ResponseTable<R, Parameters...>::ResponseTable()
+:
+   responses_(),
+   lookup_( nullptr ),
+   sequence_(),
+   callCount_( 0 )
+{
+}
+
+template<typename R, typename... Parameters>
+bool ResponseTable<R, Parameters...>::empty() const noexcept
+{
+   return !responses_ && sequence_.empty();
+}
+
+template<typename R, typename... Parameters>
+void ResponseTable<R, Parameters...>::set(
+   ArgumentsT arguments,
+   ResponseT<R> response )
+{
+   static_assert( IsCopyable_::value, "Responses must be copy constructible" );
+
+   if( !responses_ )
+   {
+      responses_ = std::make_shared<Responses_>();
+      lookup_ = &find_;
+   }
+
+   auto& responses = *static_cast<Responses_*>( responses_.get() );
+
+   OwnedKeysT_ keys = own_(
+      std::move( arguments ), std::index_sequence_for<Parameters...>() );
+   auto found = responses.responses.find(
+      ownedViews_( keys, std::index_sequence_for<Parameters...>() ) );
+   if( found != responses.responses.end() )
+   {
+      found->second = std::move( response );
+      return;
+   }
+
+   responses.keys.push_back( std::move( keys ) );
+   responses.responses.emplace(
+      ownedViews_(
+         responses.keys.back(), std::index_sequence_for<Parameters...>() ),
+      std::move( response ) );
+}
+
+template<typename R, typename... Parameters>
+void ResponseTable<R, Parameters...>::setSequence(
+   std::vector<ResponseT<R>> responses )
+{
+   static_assert( IsCopyable_::value, "Responses must be copy constructible" );
+
+   sequence_ = std::move( responses );
+   callCount_.store( 0 );
+}
+
+template<typename R, typename... Parameters>
+template<typename... Arguments>
+const ResponseT<R>* ResponseTable<R, Parameters...>::respond(
+   const Arguments&... arguments )
+{
+   const std::size_t call = callCount_.fetch_add( 1 );
+
+   if( lookup_ )
+   {
+      auto response = lookup_( responses_.get(), arguments... );
+      if( response )
+         return response;
+   }
+
+   if( call < sequence_.size() )
+      return &sequence_[ call ];
+
+   return nullptr;
+}
+
+template<typename R, typename... Parameters>
+R ResponseTable<R, Parameters...>::result( const ResponseT<R>& response )
+{
+   return result_( response, IsCopyable_() );
+}
+
+template<typename R, typename... Parameters>
+const ResponseT<R>* ResponseTable<R, Parameters...>::find_(
+   const void* responses,
+   const std::remove_reference_t<Parameters>&... arguments )
+{
+   auto& responsesByArguments =
+      static_cast<const Responses_*>( responses )->responses;
+
+   auto response = responsesByArguments.find( KeysT_(
+      ResponseKey<std::decay_t<Parameters>>::view( arguments )... ) );
+   if( response == responsesByArguments.end() )
+      return nullptr;
+
+   return &response->second;
+}
+
+template<typename R, typename... Parameters>
+template<std::size_t... I>
+auto ResponseTable<R, Parameters...>::ownedViews_(
+   const OwnedKeysT_& keys,
+   std::index_sequence<I...> ) noexcept -> KeysT_
+{
+   return KeysT_( ResponseKey<std::decay_t<Parameters>>::view(
+      std::get<I>( keys ) )... );
+}
+
+template<typename R, typename... Parameters>
+template<std::size_t... I>
+auto ResponseTable<R, Parameters...>::own_(
+   ArgumentsT&& arguments,
+   std::index_sequence<I...> ) -> OwnedKeysT_
+{
+   return OwnedKeysT_( ResponseKey<std::decay_t<Parameters>>::own(
+      std::move( std::get<I>( arguments ) ) )... );
+}
+
+template<typename R, typename... Parameters>
+R ResponseTable<R, Parameters...>::result_(
+   const ResponseT<R>& response,
+   std::true_type )
+{
+   return static_cast<R>( response );
+}
+
+template<typename R, typename... Parameters>
+R ResponseTable<R, Parameters...>::result_(
+   const ResponseT<R>&,
+   std::false_type )
+{
+   return R();
+}
+
+
+} // namespace
@@ -0,0 +1,116 @@
+/*
+
+   Serializer.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#include "ResponseTable.hh"
+
+
+namespace unimock
+{
+
+// Writes values to and reads them back from a byte string. Arithmetic and
+// enumeration types are stored as their bytes in the native byte order, so a
+// serialized value is only meant to be read back on the same platform.
+// Strings and vectors are prefixed with their size. The primary template
+// stands for a type that can't be serialized.
+template<typename T, typename Enable = void>
+struct Serializer
+{
+   static constexpr bool WRITABLE = false;
+   static constexpr bool READABLE = false;
+
+};
+
+template<typename T>
+struct Serializer<
+   T,
+   std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value>>
+{
+   static constexpr bool WRITABLE = true;
+   static constexpr bool READABLE = true;
+
+   static void write( std::string& bytes, const T& value );
+
+   static bool read( const char*& first, const char* last, T& value );
+
+};
+
+template<>
+struct Serializer<std::string>
+{
+   static constexpr bool WRITABLE = true;
+   static constexpr bool READABLE = true;
+
+   static void write( std::string& bytes, const std::string& value );
+
+   static bool read(
+      const char*& first, const char* last, std::string& value );
+
+};
+
+// A string pointer is written as the string it points to, or as null. It can't
+// be read back since there is nowhere to keep the characters.
+template<>
+struct Serializer<const char*>
+{
+   static constexpr bool WRITABLE = true;
+   static constexpr bool READABLE = false;
+
+   static void write( std::string& bytes, const char* value );
+
+};
+
+template<typename T>
+struct Serializer<
+   std::vector<T>,
+   std::enable_if_t<
+      Serializer<T>::WRITABLE && Serializer<T>::READABLE &&
+      !std::is_same<T, bool>::value>>
+{
+   static constexpr bool WRITABLE = true;
+   static constexpr bool READABLE = true;
+
+   static void write( std::string& bytes, const std::vector<T>& value );
+
+   static bool read(
+      const char*& first, const char* last, std::vector<T>& value );
+
+};
+
+// The response of a function returning void takes no bytes.
+template<>
+struct Serializer<NoResponse>
+{
+   static constexpr bool WRITABLE = true;
+   static constexpr bool READABLE = true;
+
+   static void write( std::string& bytes, const NoResponse& value );
+
+   static bool read(
+      const char*& first, const char* last, NoResponse& value );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "Serializer.tcc"
@@ -0,0 +1,155 @@
+/*
+
+   Serializer.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstring>      // std::memcpy, std::strlen
+
+
+namespace unimock
+{
+
+namespace
+{
+inline void writeSize( std::string& bytes, std::size_t size )
+{
+   const std::uint64_t size64 = size;
+   bytes.append( reinterpret_cast<const char*>( &size64 ), sizeof( size64 ) );
+}
+
+inline bool readSize( const char*& first, const char* last, std::size_t& size )
+{
+   std::uint64_t size64;
+   if( static_cast<std::size_t>( last - first ) < sizeof( size64 ) )
+      return false;
+
+   std::memcpy( &size64, first, sizeof( size64 ) );
+   first += sizeof( size64 );
+   if( size64 > static_cast<std::size_t>( last - first ) )
+      return false;
+
+   size = static_cast<std::size_t>( size64 );
+   return true;
+}
+
+} // unnamed namespace
+
+
+template<typename T>
+void Serializer<
+   T,
+   std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value>>::
+write( std::string& bytes, const T& value )
+{
+   bytes.append( reinterpret_cast<const char*>( &value ), sizeof( T ) );
+}
+
+template<typename T>
+bool Serializer<
+   T,
+   std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value>>::
+read( const char*& first, const char* last, T& value )
+{
+   if( static_cast<std::size_t>( last - first ) < sizeof( T ) )
+      return false;
+
+   std::memcpy( &value, first, sizeof( T ) );
+   first += sizeof( T );
+   return true;
+}
+
+inline void Serializer<std::string>::write(
+   std::string& bytes,
+   const std::string& value )
+{
+   writeSize( bytes, value.size() );
+   bytes += value;
+}
+
+inline bool Serializer<std::string>::read(
+   const char*& first,
+   const char* last,
+   std::string& value )
+{
+   std::size_t size;
+   if( !readSize( first, last, size ) )
+      return false;
+
+   value.assign( first, size );
+   first += size;
+   return true;
+}
+
+inline void Serializer<const char*>::write(
+   std::string& bytes,
+   const char* value )
+{
+   bytes += value ? '\1' : '\0';
+   if( value )
+   {
+      const std::size_t size = std::strlen( value );
+      writeSize( bytes, size );
+      bytes.append( value, size );
+   }
+}
+
+template<typename T>
+void Serializer<
+   std::vector<T>,
+   std::enable_if_t<
+      Serializer<T>::WRITABLE && Serializer<T>::READABLE &&
+      !std::is_same<T, bool>::value>>::
+write( std::string& bytes, const std::vector<T>& value )
+{
+   writeSize( bytes, value.size() );
+   for( const auto& element : value )
+      Serializer<T>::write( bytes, element );
+}
+
+template<typename T>
+bool Serializer<
+   std::vector<T>,
+   std::enable_if_t<
+      Serializer<T>::WRITABLE && Serializer<T>::READABLE &&
+      !std::is_same<T, bool>::value>>::
+read( const char*& first, const char* last, std::vector<T>& value )
+{
+   std::size_t size;
+   if( !readSize( first, last, size ) )
+      return false;
+
+   std::vector<T> elements( size );
+   for( auto& element : elements )
+   {
+      if( !Serializer<T>::read( first, last, element ) )
+         return false;
+   }
+
+   value = std::move( elements );
+   return true;
+}
+
+inline void Serializer<NoResponse>::write( std::string&, const NoResponse& )
+{
+}
+
+inline bool Serializer<NoResponse>::read(
+   const char*&,
+   const char*,
+   NoResponse& )
+{
+   return true;
+}
+
+
+} // namespace
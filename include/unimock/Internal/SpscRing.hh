@@ -0,0 +1,76 @@
+/*
+
+   SpscRing.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <atomic>
+#include <memory>       // std::unique_ptr
+#include <type_traits>  // std::aligned_storage_t
+
+
+namespace unimock
+{
+
+// A fixed size lock free ring buffer with a single producer thread and a single
+// consumer thread. The producer and the consumer each own one of the positions,
+// on separate cache lines, and only read the other one.
+template<typename T>
+class SpscRing
+{
+public:
+
+   // The capacity must be a power of two.
+   explicit SpscRing( std::size_t capacity );
+
+   SpscRing( const SpscRing& ) = delete;
+
+   SpscRing& operator=( const SpscRing& ) = delete;
+
+   ~SpscRing();
+
+   // Moves the object into the ring unless it's full. Called by the producer.
+   bool tryPush( T& object );
+
+   // Calls the consumer with each object in the ring, in the order they were
+   // pushed, and removes them. Called by the consumer.
+   template<class Consumer>
+   void consume( Consumer consumer );
+
+
+private:
+
+   using Slot_ = std::aligned_storage_t<sizeof( T ), alignof( T )>;
+
+   const std::size_t mask_;
+
+   std::unique_ptr<Slot_[]> slots_;
+
+   // The next position to pop, written by the consumer only.
+   std::atomic<std::size_t> head_;
+
+   // Keeps the positions on separate cache lines. Padding is used instead of
+   // alignas, since over-aligned types can't be allocated with new in C++14.
+   char padding_[ 64 ];
+
+   // The next position to push, written by the producer only.
+   std::atomic<std::size_t> tail_;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "SpscRing.tcc"
@@ -0,0 +1,81 @@
+/*
+
+   SpscRing.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <new>          // placement new
+#include <utility>      // std::move
+#include <cassert>
+
+
+namespace unimock
+{
+
+template<typename T>
+SpscRing<T>::SpscRing( std::size_t capacity )
+:
+   mask_( capacity - 1 ),
+   slots_( new Slot_[ capacity ] ),
+   head_( 0 ),
+   padding_(),
+   tail_( 0 )
+{
+   assert( capacity > 0 && ( capacity & ( capacity - 1 ) ) == 0 );
+}
+
+template<typename T>
+SpscRing<T>::~SpscRing()
+{
+   const std::size_t head = head_.load( std::memory_order_relaxed );
+   const std::size_t tail = tail_.load( std::memory_order_acquire );
+
+   for( std::size_t i = head; i != tail; i++ )
+      reinterpret_cast<T&>( slots_[ i & mask_ ] ).~T();
+}
+
+template<typename T>
+bool SpscRing<T>::tryPush( T& object )
+{
+   const std::size_t tail = tail_.load( std::memory_order_relaxed );
+
+   if( tail - head_.load( std::memory_order_acquire ) > mask_ )
+      return false;
+
+   new( &slots_[ tail & mask_ ] ) T( std::move( object ) );
+   tail_.store( tail + 1, std::memory_order_release );
+
+   return true;
+}
+
+template<typename T>
+template<class Consumer>
+void SpscRing<T>::consume( Consumer consumer )
+{
+   const std::size_t tail = tail_.load( std::memory_order_acquire );
+
+   // The head is moved past each object as soon as it's consumed, so the ring
+   // stays consistent if the consumer throws.
+   for( std::size_t head = head_.load( std::memory_order_relaxed );
+      head != tail;
+      head++ )
+   {
+      T& object = reinterpret_cast<T&>( slots_[ head & mask_ ] );
+      consumer( object );
+      object.~T();
+
+      head_.store( head + 1, std::memory_order_release );
+   }
+}
+
+
+} // namespace
@@ -0,0 +1,72 @@
+/*
+
+   TaskQueue.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+namespace unimock
+{
+
+// Runs tasks one at a time on a worker thread, in the order they are pushed.
+// The tasks must not throw.
+class TaskQueue final
+{
+public:
+
+   TaskQueue();
+
+   // Runs the remaining tasks before joining the worker thread.
+   ~TaskQueue();
+
+   TaskQueue( const TaskQueue& ) = delete;
+   TaskQueue& operator=( const TaskQueue& ) = delete;
+
+   void push( std::function<void()> task );
+
+   // Waits until all tasks pushed so far have been run.
+   void flush();
+
+
+private:
+
+   std::mutex mutex_;
+
+   std::condition_variable wakeUp_;
+
+   std::condition_variable done_;
+
+   std::deque<std::function<void()>> tasks_;
+
+   bool busy_;
+
+   bool stop_;
+
+   // The worker is started last, once the other members are constructed.
+   std::thread worker_;
+
+   void run_();
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "TaskQueue.icc"
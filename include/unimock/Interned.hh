@@ -0,0 +1,142 @@
+/*
+
+   Interned.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <functional>   // std::hash
+#include <string>
+#include <type_traits>
+
+
+namespace unimock
+{
+
+/// Trait selecting the types stored as shared copies.
+///
+/// The InterningConversionPolicy stores one shared copy of each distinct value
+/// of the types for which this trait is true, and records handles to them. It
+/// is true for std::string. Specialize it as std::true_type for your own types
+/// to have them interned as well. The type must be equality comparable and
+/// have a std::hash specialization.
+///
+template<typename T>
+struct IsInterned : std::false_type {};
+
+template<>
+struct IsInterned<std::string> : std::true_type {};
+
+/// Interned handle to a value.
+///
+/// The handle refers to the shared copy of a value kept by the conversion
+/// policy that created it, and is only valid as long as that policy, usually
+/// the CallRecorder, is alive. The handle is compared, ordered and hashed by
+/// the value it refers to, and converts implicitly to a const reference to the
+/// value.
+///
+template<typename T>
+class Interned
+{
+public:
+
+   /// Constructor.
+   ///
+   /// \param[in] value
+   ///   The shared copy of the value to refer to.
+   ///
+   /// \exception No-throw.
+   ///
+   explicit Interned( const T& value ) noexcept;
+
+   /// Returns the value referred to.
+   ///
+   /// \returns
+   ///   The value.
+   ///
+   /// \exception No-throw.
+   ///
+   const T& get() const noexcept;
+
+   /// Returns the value referred to.
+   ///
+   /// \returns
+   ///   The value.
+   ///
+   /// \exception No-throw.
+   ///
+   operator const T&() const noexcept;
+
+   /// Returns the value referred to.
+   ///
+   /// \returns
+   ///   The value.
+   ///
+   /// \exception No-throw.
+   ///
+   const T& operator*() const noexcept;
+
+   /// Accesses a member of the value referred to.
+   ///
+   /// \returns
+   ///   A pointer to the value.
+   ///
+   /// \exception No-throw.
+   ///
+   const T* operator->() const noexcept;
+
+
+private:
+
+   const T* valuePtr_;
+
+};
+
+template<typename T>
+bool operator==( const Interned<T>& lhs, const Interned<T>& rhs );
+
+template<typename T>
+bool operator!=( const Interned<T>& lhs, const Interned<T>& rhs );
+
+template<typename T>
+bool operator<( const Interned<T>& lhs, const Interned<T>& rhs );
+
+template<typename T, typename U>
+bool operator==( const Interned<T>& lhs, const U& rhs );
+
+template<typename T, typename U>
+bool operator==( const U& lhs, const Interned<T>& rhs );
+
+template<typename T, typename U>
+bool operator!=( const Interned<T>& lhs, const U& rhs );
+
+template<typename T, typename U>
+bool operator!=( const U& lhs, const Interned<T>& rhs );
+
+
+} // namespace
+
+
+namespace std
+{
+
+template<typename T>
+struct hash<unimock::Interned<T>>
+{
+   std::size_t operator()( const unimock::Interned<T>& interned ) const;
+};
+
+} // namespace
+
+
+// Implementation.
+#include "Interned.tcc"
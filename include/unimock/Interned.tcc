@@ -0,0 +1,109 @@
+/*
+
+   Interned.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+
+namespace unimock
+{
+
+template<typename T>
+Interned<T>::Interned( const T& value ) noexcept
+:
+   valuePtr_( &value )
+{
+}
+
+template<typename T>
+const T& Interned<T>::get() const noexcept
+{
+   return *valuePtr_;
+}
+
+template<typename T>
+Interned<T>::operator const T&() const noexcept
+{
+   return *valuePtr_;
+}
+
+template<typename T>
+const T& Interned<T>::operator*() const noexcept
+{
+   return *valuePtr_;
+}
+
+template<typename T>
+const T* Interned<T>::operator->() const noexcept
+{
+   return valuePtr_;
+}
+
+template<typename T>
+bool operator==( const Interned<T>& lhs, const Interned<T>& rhs )
+{
+   // Handles from the same pool refer to the same copy if the values are
+   // equal, so most comparisons end with the address.
+   return &lhs.get() == &rhs.get() || lhs.get() == rhs.get();
+}
+
+template<typename T>
+bool operator!=( const Interned<T>& lhs, const Interned<T>& rhs )
+{
+   return !( lhs == rhs );
+}
+
+template<typename T>
+bool operator<( const Interned<T>& lhs, const Interned<T>& rhs )
+{
+   return lhs.get() < rhs.get();
+}
+
+template<typename T, typename U>
+bool operator==( const Interned<T>& lhs, const U& rhs )
+{
+   return lhs.get() == rhs;
+}
+
+template<typename T, typename U>
+bool operator==( const U& lhs, const Interned<T>& rhs )
+{
+   return lhs == rhs.get();
+}
+
+template<typename T, typename U>
+bool operator!=( const Interned<T>& lhs, const U& rhs )
+{
+   return !( lhs == rhs );
+}
+
+template<typename T, typename U>
+bool operator!=( const U& lhs, const Interned<T>& rhs )
+{
+   return !( lhs == rhs );
+}
+
+
+} // namespace
+
+
+namespace std
+{
+
+template<typename T>
+std::size_t hash<unimock::Interned<T>>::operator()(
+   const unimock::Interned<T>& interned ) const
+{
+   return std::hash<T>()( interned.get() );
+}
+
+} // namespace
@@ -0,0 +1,116 @@
+/*
+
+   InterningConversionPolicy.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <string>
+#include <memory>       // std::unique_ptr
+#include <typeindex>
+#include <unordered_map>
+#include <type_traits>
+
+#include "unimock/Interned.hh"
+#include "unimock/StringView.hh"
+
+
+namespace unimock
+{
+
+/// InterningConversionPolicy to convert from one type to another.
+///
+/// This conversion policy converts like the DefaultConversionPolicy, but the
+/// converted values of the types selected by the IsInterned trait are stored
+/// only once. Each recorded call holds an Interned handle to the shared copy
+/// instead of a copy of its own. String literals and const char* are interned
+/// as std::string. When the same values are recorded over and over again, the
+/// memory used scales with the number of distinct values rather than with the
+/// number of calls.
+///
+/// The handles are valid as long as the policy, i.e. the CallRecorder, is
+/// alive. Result sets holding handles must not outlive the recorder.
+///
+/// #### Example ####
+/// ~~~
+/// auto recorder =
+///    std::make_shared<CallRecorder<InterningConversionPolicy>>();
+/// recorder->record( setName, "Fred" );
+/// auto resultSet = makeResultSet( recorder->find( setName ) );
+/// assert( resultSet.get<0>( 0 ) == "Fred" );
+/// ~~~
+///
+class InterningConversionPolicy
+{
+public:
+
+   /// Constructor.
+   ///
+   /// \exception Exception neutral.
+   ///
+   InterningConversionPolicy();
+
+   template<typename T>
+   auto convert( T&& object );
+
+   template<typename T>
+   auto convert( T* objectPtr );
+
+   Interned<std::string> convert( const char* stringPtr );
+
+   template<typename T>
+   auto convert( const std::unique_ptr<T>& objectUPtr );
+
+   template<typename T>
+   auto convert( std::unique_ptr<T>&& objectUPtr );
+
+   /// Returns the number of distinct values stored, counted over all types.
+   ///
+   /// \returns
+   ///   The number of distinct values.
+   ///
+   /// \exception No-throw.
+   ///
+   std::size_t internedCount() const noexcept;
+
+
+private:
+
+   struct PoolI_
+   {
+      virtual ~PoolI_() {}
+      virtual std::size_t size() const noexcept = 0;
+   };
+
+   template<typename T>
+   struct Pool_;
+
+   std::unordered_map<std::type_index, std::unique_ptr<PoolI_>> pools_;
+
+   // The interned strings by their characters, which lets a const char* be
+   // looked up without constructing a std::string.
+   std::unordered_map<StringView, Interned<std::string>> strings_;
+
+   template<typename T>
+   auto intern_( T&& object, std::false_type );
+
+   template<typename T>
+   auto intern_( T&& object, std::true_type );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "InterningConversionPolicy.tcc"
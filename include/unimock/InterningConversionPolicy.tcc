@@ -0,0 +1,130 @@
+/*
+
+   InterningConversionPolicy.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <utility>      // std::forward
+#include <unordered_set>
+
+
+namespace unimock
+{
+
+// The values of each interned type are kept in a node based hash set, so the
+// addresses handed out in the handles stay valid when the set grows.
+template<typename T>
+struct InterningConversionPolicy::Pool_ : public PoolI_
+{
+   Pool_() : values() {}
+
+   std::size_t size() const noexcept override
+   {
+      return values.size();
+   }
+
+   std::unordered_set<T> values;
+};
+
+inline InterningConversionPolicy::InterningConversionPolicy()
+:
+   pools_(),
+   strings_()
+{
+}
+
+// Plain auto never deduces to a reference, so the types that aren't interned
+// are stored as copies, just like in the DefaultConversionPolicy.
+template<typename T>
+auto InterningConversionPolicy::intern_( T&& object, std::false_type )
+{
+   return std::forward<T>( object );
+}
+
+template<typename T>
+auto InterningConversionPolicy::intern_( T&& object, std::true_type )
+{
+   using ValueT = std::decay_t<T>;
+
+   auto& pool = pools_[ typeid( ValueT ) ];
+   if( !pool )
+      pool.reset( new Pool_<ValueT>() );
+
+   // Look up the value before inserting it, since inserting allocates a node
+   // even when the value turns out to be there already.
+   auto& values = static_cast<Pool_<ValueT>&>( *pool ).values;
+   auto value = values.find( object );
+   if( value == values.end() )
+      value = values.insert( std::forward<T>( object ) ).first;
+
+   return Interned<ValueT>( *value );
+}
+
+template<typename T>
+auto InterningConversionPolicy::convert( T&& object )
+{
+   return intern_(
+      std::forward<T>( object ), IsInterned<std::decay_t<T>>() );
+}
+
+template<typename T>
+auto InterningConversionPolicy::convert( T* objectPtr )
+{
+   return intern_(
+      static_cast<const T&>( *objectPtr ),
+      IsInterned<std::remove_cv_t<T>>() );
+}
+
+inline Interned<std::string> InterningConversionPolicy::convert(
+   const char* stringPtr )
+{
+   // A std::string is only constructed for a string not seen before. The
+   // view used as key refers to the interned copy, not to the argument.
+   auto string = strings_.find( StringView( stringPtr ) );
+   if( string == strings_.end() )
+   {
+      const auto interned =
+         intern_( std::string( stringPtr ), std::true_type() );
+      string = strings_.emplace( StringView( *interned ), interned ).first;
+   }
+
+   return string->second;
+}
+
+template<typename T>
+auto InterningConversionPolicy::convert(
+   const std::unique_ptr<T>& objectUPtr )
+{
+   return intern_(
+      static_cast<const T&>( *objectUPtr ),
+      IsInterned<std::remove_cv_t<T>>() );
+}
+
+template<typename T>
+auto InterningConversionPolicy::convert( std::unique_ptr<T>&& objectUPtr )
+{
+   return intern_(
+      static_cast<const T&>( *objectUPtr ),
+      IsInterned<std::remove_cv_t<T>>() );
+}
+
+inline std::size_t InterningConversionPolicy::internedCount() const noexcept
+{
+   std::size_t count = 0;
+   for( auto& pool : pools_ )
+      count += pool.second->size();
+
+   return count;
+}
+
+
+} // namespace
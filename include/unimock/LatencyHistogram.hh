@@ -0,0 +1,163 @@
+/*
+
+   LatencyHistogram.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t
+#include <vector>
+
+
+namespace unimock
+{
+
+/// LatencyHistogram to record latencies with a bounded relative error.
+///
+/// The histogram is log bucketed in the manner of an HDR histogram. Values
+/// below 2^precisionBits have a bucket each, and every power of two above that
+/// is split into 2^(precisionBits - 1) buckets of equal width. Recording a
+/// value is thus a constant time increment, and a quantile is within
+/// 2^-precisionBits of the true value relatively, about 0.8 % by default. The
+/// buckets are allocated up to the largest value recorded. Two histograms of
+/// the same precision can be merged.
+///
+/// #### Example ####
+/// ~~~
+/// auto histogram = mock.getLatencyHistogram( &IStore::get );
+/// std::cout << "p99: " << histogram.quantile( 0.99 ) << " ns" << std::endl;
+/// ~~~
+///
+/// #### See also ####
+/// [HdrHistogram](http://hdrhistogram.org)
+///
+class LatencyHistogram
+{
+public:
+
+   /// Constructor.
+   ///
+   /// \param[in] precisionBits
+   ///   The number of bits of precision kept in every value, between 1 and
+   ///   16. Each bit halves the relative error and doubles the memory used.
+   ///
+   /// \exception Exception neutral.
+   ///
+   explicit LatencyHistogram( unsigned precisionBits = 7 );
+
+   /// Adds a value to the histogram.
+   ///
+   /// \param[in] value
+   ///   The value to add, typically a latency in nanoseconds.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void add( std::uint64_t value );
+
+   /// Merges another histogram into this histogram.
+   ///
+   /// \pre The histograms must have the same precision.
+   ///
+   /// \param[in] other
+   ///   The histogram to merge.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void merge( const LatencyHistogram& other );
+
+   /// Gets the number of values added.
+   ///
+   /// \returns
+   ///   The number of values added.
+   ///
+   /// \exception No-throw.
+   ///
+   std::size_t size() const noexcept;
+
+   /// Gets the smallest value added.
+   ///
+   /// \pre The histogram must not be empty.
+   ///
+   /// \returns
+   ///   The exact smallest value.
+   ///
+   /// \exception No-throw.
+   ///
+   std::uint64_t min() const noexcept;
+
+   /// Gets the largest value added.
+   ///
+   /// \pre The histogram must not be empty.
+   ///
+   /// \returns
+   ///   The exact largest value.
+   ///
+   /// \exception No-throw.
+   ///
+   std::uint64_t max() const noexcept;
+
+   /// Gets the mean of the values added.
+   ///
+   /// \pre The histogram must not be empty.
+   ///
+   /// \returns
+   ///   The exact mean.
+   ///
+   /// \exception No-throw.
+   ///
+   double mean() const noexcept;
+
+   /// Estimates a quantile.
+   ///
+   /// \pre The histogram must not be empty.
+   ///
+   /// \param[in] q
+   ///   The quantile, between 0 and 1. The median is 0.5, the 99th percentile
+   ///   is 0.99 and the 99.9th percentile is 0.999.
+   ///
+   /// \returns
+   ///   The middle of the bucket holding the quantile, clamped to the smallest
+   ///   and the largest value.
+   ///
+   /// \exception No-throw.
+   ///
+   std::uint64_t quantile( double q ) const noexcept;
+
+
+private:
+
+   unsigned precisionBits_;
+
+   std::size_t count_;
+
+   std::uint64_t min_;
+
+   std::uint64_t max_;
+
+   double sum_;
+
+   std::vector<std::uint64_t> counts_;
+
+   std::size_t bucketIndex_( std::uint64_t value ) const noexcept;
+
+   std::uint64_t bucketFirst_( std::size_t index ) const noexcept;
+
+   std::uint64_t bucketWidth_( std::size_t index ) const noexcept;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "LatencyHistogram.icc"
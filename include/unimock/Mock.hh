@@ -13,12 +13,37 @@ ________________________________________________________________________________
 
 #pragma once
 
+#include <cstddef>      // std::size_t
 #include <memory>       // std::shared_ptr
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <string>
+#include <type_traits>
+#include <chrono>
+#include <mutex>
 
 #include "unimock/FiniteID.hh"
 #include "unimock/CallRecorder.hh"
 #include "unimock/DefaultConversionPolicy.hh"
+#include "unimock/Cassette.hh"
+#include "unimock/DifferentialReport.hh"
+#include "unimock/LatencyHistogram.hh"
+#include "unimock/ConcurrencyProfile.hh"
+#include "unimock/Capacity.hh"
+#include "unimock/VirtualScheduler.hh"
+#include "unimock/CostModel.hh"
 #include "Internal/FunctionMap.hh"
+#include "Internal/MethodKey.hh"
+#include "Internal/ArgumentFilter.hh"
+#include "Internal/ResponseTable.hh"
+#include "Internal/CassetteCall.hh"
+#include "Internal/MemoTable.hh"
+#include "Internal/Differential.hh"
+#include "Internal/ConcurrencyTracker.hh"
+#include "Internal/CapacityLimiter.hh"
+#include "Internal/Deferral.hh"
+#include "Internal/CallSlots.hh"
 
 
 namespace unimock
@@ -27,6 +52,26 @@ namespace unimock
 template<class TI, class ConversionPolicy = DefaultConversionPolicy>
 class Mock;
 
+/// Statistics of a memoized method.
+///
+/// Hits are calls answered from memoized results, and misses are calls that
+/// went on to the stub.
+///
+struct MemoStatistics
+{
+   std::size_t hits;
+   std::size_t misses;
+   std::size_t size;
+};
+
+/// How the calls to a candidate implementation are run.
+///
+/// INLINE candidates are called right after the stub by the calling thread.
+/// ASYNCHRONOUS candidates are called by a worker thread of the mock, so they
+/// don't slow down the calling thread.
+///
+enum class CandidateExecution { INLINE, ASYNCHRONOUS };
+
 
 /// Mock to record call activity and provide stub functionality.
 ///
@@ -130,6 +175,751 @@ public:
    template<typename R, typename... Parameters, class F>
    void override( R(TI::*methodPtr)(Parameters...) const, F functor );
 
+   /// Sets whether calls to an interface method are recorded.
+   ///
+   /// Calls that aren't recorded are dropped before their arguments are
+   /// converted, but they are still forwarded to an overriding functor or the
+   /// stub. The setting only applies to this mock. The call recorder may drop
+   /// the calls as well, according to its own settings.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method who's calls shall be recorded or dropped.
+   ///
+   /// \param[in] recorded
+   ///   True to record the calls, false to drop them.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setRecorded( R(TI::*methodPtr)(Parameters...), bool recorded );
+
+   /// Sets whether calls to an interface method are recorded.
+   ///
+   /// This method works the same as the other setRecorded method. The
+   /// difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method who's calls shall be recorded or dropped.
+   ///
+   /// \param[in] recorded
+   ///   True to record the calls, false to drop them.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setRecorded( R(TI::*methodPtr)(Parameters...) const, bool recorded );
+
+   /// Sets a filter selecting which calls to an interface method are recorded.
+   ///
+   /// The filter is a predicate called with the arguments as they are passed,
+   /// as const references, before any conversion. Calls for which it returns
+   /// false aren't recorded, but they are still forwarded to an overriding
+   /// functor or the stub. The filter only applies to this mock and replaces
+   /// any previous filter for the method. It's independent of setRecorded; a
+   /// method set not to be recorded drops its calls whatever the filter says.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method who's calls shall be filtered.
+   ///
+   /// \param[in] predicate
+   ///   The predicate selecting the calls to record.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters, class F>
+   void setFilter( R(TI::*methodPtr)(Parameters...), F predicate );
+
+   /// Sets a filter selecting which calls to an interface method are recorded.
+   ///
+   /// This method works the same as the other setFilter method. The difference
+   /// is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method who's calls shall be filtered.
+   ///
+   /// \param[in] predicate
+   ///   The predicate selecting the calls to record.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters, class F>
+   void setFilter( R(TI::*methodPtr)(Parameters...) const, F predicate );
+
+   /// Sets the response to calls to an interface method with some arguments.
+   ///
+   /// Calls to the method with arguments equal to the ones provided return
+   /// the response, looked up in a hash table without calling any functor.
+   /// The responses take precedence over a response sequence, an overriding
+   /// functor and the stub, in that order. The argument types must be
+   /// hashable with std::hash and equality comparable.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// for( auto& row : fixture )
+   ///    mock.setResponse( &IStore::get, std::make_tuple( row.key ), row.val );
+   /// ~~~
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to respond to.
+   ///
+   /// \param[in] arguments
+   ///   The arguments to respond to.
+   ///
+   /// \param[in] response
+   ///   The value to return.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setResponse(
+      R(TI::*methodPtr)(Parameters...),
+      std::tuple<std::decay_t<Parameters>...> arguments,
+      ResponseT<R> response );
+
+   /// Sets the response to calls to an interface method with some arguments.
+   ///
+   /// This method works the same as the other setResponse method. The
+   /// difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to respond to.
+   ///
+   /// \param[in] arguments
+   ///   The arguments to respond to.
+   ///
+   /// \param[in] response
+   ///   The value to return.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setResponse(
+      R(TI::*methodPtr)(Parameters...) const,
+      std::tuple<std::decay_t<Parameters>...> arguments,
+      ResponseT<R> response );
+
+   /// Sets the responses to the next calls to an interface method.
+   ///
+   /// The next calls to the method return the responses in order, indexed by
+   /// the number of calls made since the sequence was set. The calls after the
+   /// last response go to an overriding functor or the stub as usual.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// mock.setResponseSequence( &ISocket::receive, { 512, 512, 0 } );
+   /// ~~~
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to respond to.
+   ///
+   /// \param[in] responses
+   ///   The values to return, one per call.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setResponseSequence(
+      R(TI::*methodPtr)(Parameters...),
+      std::vector<ResponseT<R>> responses );
+
+   /// Sets the responses to the next calls to an interface method.
+   ///
+   /// This method works the same as the other setResponseSequence method. The
+   /// difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to respond to.
+   ///
+   /// \param[in] responses
+   ///   The values to return, one per call.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setResponseSequence(
+      R(TI::*methodPtr)(Parameters...) const,
+      std::vector<ResponseT<R>> responses );
+
+   /// Sets a cassette to record stub responses on or to replay them from.
+   ///
+   /// With a cassette in record mode, the calls that go to the stub are
+   /// recorded on the cassette along with their return values and out
+   /// parameters. With a cassette in replay mode, the calls that would go to
+   /// the stub are answered from the cassette instead, and only the calls that
+   /// weren't recorded go to the stub or return a default value. Responses and
+   /// method overrides still take precedence. See Cassette for the methods
+   /// that can be put on a cassette.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// mock.setCassette( std::make_shared<Cassette>(
+   ///    "store.cassette", Cassette::Mode::REPLAY ) );
+   /// ~~~
+   ///
+   /// \param[in] cassette
+   ///   The cassette, or nullptr to call the stub directly.
+   ///
+   /// \exception No-throw.
+   ///
+   void setCassette( std::shared_ptr<Cassette> cassette ) noexcept;
+
+   /// Memoizes the results of the stub for an interface method.
+   ///
+   /// Calls to the method that would go to the stub are looked up by their
+   /// arguments first, and the stub is only called when there is no result
+   /// for the arguments yet. The arguments are converted with the
+   /// DefaultConversionPolicy and hashed with std::hash, so pointers and smart
+   /// pointers are keyed by the objects they point to and string pointers by
+   /// their characters. When the capacity is reached, the least recently used
+   /// result is evicted. The calls are recorded as usual, hit or miss.
+   ///
+   /// This is meant for stubs that are deterministic but expensive, like pure
+   /// computations. The method must return a copyable value and can't have
+   /// out parameters, that is non-const references or pointers to non-const.
+   /// Memoizing a method again clears its results and statistics.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// SolverMock mock( std::make_shared<Solver>() );
+   /// mock.memoize( &ISolver::solve, 1024 );
+   /// ~~~
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to memoize.
+   ///
+   /// \param[in] capacity
+   ///   The maximum number of results to keep, at least one.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void memoize( R(TI::*methodPtr)(Parameters...), std::size_t capacity );
+
+   /// Memoizes the results of the stub for an interface method.
+   ///
+   /// This method works the same as the other memoize method. The difference
+   /// is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to memoize.
+   ///
+   /// \param[in] capacity
+   ///   The maximum number of results to keep, at least one.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void memoize( R(TI::*methodPtr)(Parameters...) const, std::size_t capacity );
+
+   /// Gets the statistics of a memoized interface method.
+   ///
+   /// \param[in] methodPtr
+   ///   The memoized interface method.
+   ///
+   /// \returns
+   ///   The number of hits, misses and kept results, all zero if the method
+   ///   isn't memoized.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   MemoStatistics getMemoStatistics(
+      R(TI::*methodPtr)(Parameters...) ) const;
+
+   /// Gets the statistics of a memoized interface method.
+   ///
+   /// This method works the same as the other getMemoStatistics method. The
+   /// difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The memoized interface method.
+   ///
+   /// \returns
+   ///   The number of hits, misses and kept results, all zero if the method
+   ///   isn't memoized.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   MemoStatistics getMemoStatistics(
+      R(TI::*methodPtr)(Parameters...) const ) const;
+
+   /// Sets a candidate implementation to mirror the stub calls to.
+   ///
+   /// Every call that goes to the stub, the primary implementation, is also
+   /// made to the candidate with a copy of the arguments. The results are
+   /// compared and the latencies of both implementations are reported per
+   /// method, see getDifferentialReport. The result of the stub is returned as
+   /// usual. Only methods taking and returning copyable types are mirrored.
+   /// Pointers to const are passed to the candidate as pointers to copies of
+   /// the objects, and C strings as copies of their characters, while methods
+   /// with pointer to non-const parameters aren't mirrored, so the candidate
+   /// never reaches the caller's values. Exceptions thrown by the candidate
+   /// are counted as mismatches, while the candidate isn't called at all when
+   /// the stub throws. Results without operator==, and calls of methods with
+   /// non-const reference parameters, whose values written by the candidate
+   /// are discarded, are counted as not compared.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// StoreMock mock( std::make_shared<DiskStore>() );
+   /// mock.setCandidate(
+   ///    std::make_shared<FlashStore>(), CandidateExecution::ASYNCHRONOUS );
+   ///
+   /// runWorkload( mock );
+   ///
+   /// mock.flushCandidate();
+   /// auto report = mock.getDifferentialReport( &IStore::get );
+   /// assert( report.mismatches == 0 );
+   /// ~~~
+   ///
+   /// \param[in] candidate
+   ///   The candidate implementation, or nullptr to stop mirroring.
+   ///
+   /// \param[in] execution
+   ///   Whether the candidate is called inline or asynchronously.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void setCandidate(
+      std::shared_ptr<TI> candidate,
+      CandidateExecution execution = CandidateExecution::INLINE );
+
+   /// Waits for the asynchronous calls to the candidate made so far.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void flushCandidate();
+
+   /// Gets the comparison of the stub and the candidate for a method.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to get the report of.
+   ///
+   /// \returns
+   ///   The report of the mirrored calls to the method, empty if there are
+   ///   none.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   DifferentialReport getDifferentialReport(
+      R(TI::*methodPtr)(Parameters...) ) const;
+
+   /// Gets the comparison of the stub and the candidate for a method.
+   ///
+   /// This method works the same as the other getDifferentialReport method.
+   /// The difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to get the report of.
+   ///
+   /// \returns
+   ///   The report of the mirrored calls to the method, empty if there are
+   ///   none.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   DifferentialReport getDifferentialReport(
+      R(TI::*methodPtr)(Parameters...) const ) const;
+
+   /// Sets whether the calls to an interface method are timed.
+   ///
+   /// A timed call measures how long the method override, the stub, or
+   /// whatever else provides the result takes to return. The latencies are
+   /// aggregated in a LatencyHistogram per method, and the latencies of the
+   /// recorded calls are also kept in the order they were recorded. Wrapping a
+   /// real implementation in a mock thus profiles the calls made to it. Calls
+   /// answered by a response aren't timed, and neither are calls that throw.
+   /// Setting a method timed again resets its latencies.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// StoreMock mock( std::make_shared<DiskStore>() );
+   /// mock.setTimed( &IStore::get, true );
+   ///
+   /// runWorkload( mock );
+   ///
+   /// auto histogram = mock.getLatencyHistogram( &IStore::get );
+   /// std::cout << histogram.quantile( 0.999 ) << " ns" << std::endl;
+   /// ~~~
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to time.
+   ///
+   /// \param[in] timed
+   ///   True to time the calls, false to stop timing them and drop their
+   ///   latencies.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setTimed( R(TI::*methodPtr)(Parameters...), bool timed );
+
+   /// Sets whether the calls to an interface method are timed.
+   ///
+   /// This method works the same as the other setTimed method. The difference
+   /// is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to time.
+   ///
+   /// \param[in] timed
+   ///   True to time the calls, false to stop timing them and drop their
+   ///   latencies.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setTimed( R(TI::*methodPtr)(Parameters...) const, bool timed );
+
+   /// Gets the latencies of a timed interface method as a histogram.
+   ///
+   /// \param[in] methodPtr
+   ///   The timed interface method.
+   ///
+   /// \returns
+   ///   The histogram of the latencies in nanoseconds, empty if the method
+   ///   isn't timed.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   LatencyHistogram getLatencyHistogram(
+      R(TI::*methodPtr)(Parameters...) ) const;
+
+   /// Gets the latencies of a timed interface method as a histogram.
+   ///
+   /// This method works the same as the other getLatencyHistogram method. The
+   /// difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The timed interface method.
+   ///
+   /// \returns
+   ///   The histogram of the latencies in nanoseconds, empty if the method
+   ///   isn't timed.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   LatencyHistogram getLatencyHistogram(
+      R(TI::*methodPtr)(Parameters...) const ) const;
+
+   /// Finds the latencies of the recorded calls to a timed interface method.
+   ///
+   /// There is a latency per call recorded by this mock since the method was
+   /// set timed, in the order the calls were recorded, even if they returned
+   /// in another order. They thus line up with the calls found by the find
+   /// method, as long as the recorder keeps every call and, in asynchronous
+   /// mode, only one thread calls the method. Recorded calls that weren't
+   /// timed, since they were answered by a response or threw, have the
+   /// latency std::chrono::nanoseconds::min().
+   ///
+   /// \param[in] methodPtr
+   ///   The timed interface method.
+   ///
+   /// \returns
+   ///   The latencies of the recorded calls, empty if the method isn't timed.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   std::vector<std::chrono::nanoseconds> findLatencies(
+      R(TI::*methodPtr)(Parameters...) ) const;
+
+   /// Finds the latencies of the recorded calls to a timed interface method.
+   ///
+   /// This method works the same as the other findLatencies method. The
+   /// difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The timed interface method.
+   ///
+   /// \returns
+   ///   The latencies of the recorded calls, empty if the method isn't timed.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   std::vector<std::chrono::nanoseconds> findLatencies(
+      R(TI::*methodPtr)(Parameters...) const ) const;
+
+   /// Sets whether the calls in flight to an interface method are tracked.
+   ///
+   /// A tracked method counts the calls that have entered its override or
+   /// stub but not yet returned, which tells whether the code under test
+   /// keeps the concurrency towards a dependency within bounds, and how much
+   /// of it the code actually achieves. The calls to all tracked methods of
+   /// the mock are also counted together, for the concurrency towards the
+   /// mocked object as a whole. Calls answered by a response aren't tracked,
+   /// and calls waiting for a server of a capacity are in flight only once
+   /// they're served. The first 65536 calls entering or returning are sampled
+   /// in the profile, without a lock. Setting a method tracked again resets
+   /// its profile.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// ConnectionMock mock( std::make_shared<SlowConnection>() );
+   /// mock.setConcurrencyTracked( &IConnection::send, true );
+   ///
+   /// ConnectionPool pool( mock, 4 );
+   /// runWorkload( pool );
+   ///
+   /// auto profile = mock.getConcurrencyProfile( &IConnection::send );
+   /// assert( profile.maxInFlight <= 4 );
+   /// ~~~
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to track.
+   ///
+   /// \param[in] tracked
+   ///   True to track the calls, false to stop tracking them and drop the
+   ///   profile of the method.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setConcurrencyTracked(
+      R(TI::*methodPtr)(Parameters...),
+      bool tracked );
+
+   /// Sets whether the calls in flight to an interface method are tracked.
+   ///
+   /// This method works the same as the other setConcurrencyTracked method.
+   /// The difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to track.
+   ///
+   /// \param[in] tracked
+   ///   True to track the calls, false to stop tracking them and drop the
+   ///   profile of the method.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setConcurrencyTracked(
+      R(TI::*methodPtr)(Parameters...) const,
+      bool tracked );
+
+   /// Gets the concurrency profile of a tracked interface method.
+   ///
+   /// \param[in] methodPtr
+   ///   The tracked interface method.
+   ///
+   /// \returns
+   ///   The concurrency profile of the method, empty if the method isn't
+   ///   tracked.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   ConcurrencyProfile getConcurrencyProfile(
+      R(TI::*methodPtr)(Parameters...) ) const;
+
+   /// Gets the concurrency profile of a tracked interface method.
+   ///
+   /// This method works the same as the other getConcurrencyProfile method
+   /// taking a method pointer. The difference is that it takes a const method
+   /// pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The tracked interface method.
+   ///
+   /// \returns
+   ///   The concurrency profile of the method, empty if the method isn't
+   ///   tracked.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   ConcurrencyProfile getConcurrencyProfile(
+      R(TI::*methodPtr)(Parameters...) const ) const;
+
+   /// Gets the concurrency profile of the calls to all tracked methods.
+   ///
+   /// \returns
+   ///   The concurrency profile of the mocked object, empty if no method is
+   ///   tracked.
+   ///
+   /// \exception Exception neutral.
+   ///
+   ConcurrencyProfile getConcurrencyProfile() const;
+
+   /// Sets the capacity of an interface method.
+   ///
+   /// The method then emulates a saturated dependency, a server with a
+   /// bounded number of calls served at once and a bounded queue. A call that
+   /// is rejected by a full queue, or that times out waiting for a server,
+   /// throws CapacityExceeded to the caller, and the served calls occupy their
+   /// server for a service time drawn from the capacity before they go on to
+   /// the override or stub. The calls are served in the order they arrive,
+   /// and their queueing delays are kept along with the recorded calls.
+   /// Calls answered by a response don't go through the capacity. Setting a
+   /// capacity again resets the statistics of the method.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// Capacity capacity;
+   /// capacity.servers = 2;
+   /// capacity.queueDepth = 0;
+   /// capacity.serviceTime = []{ return std::chrono::milliseconds( 5 ); };
+   ///
+   /// ServiceMock mock( std::make_shared<ServiceStub>() );
+   /// mock.setCapacity( &IService::request, capacity );
+   ///
+   /// RetryingClient client( mock );
+   /// runWorkload( client );
+   ///
+   /// auto statistics = mock.getCapacityStatistics( &IService::request );
+   /// std::cout << statistics.rejected << " rejected" << std::endl;
+   /// ~~~
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to limit.
+   ///
+   /// \param[in] capacity
+   ///   The capacity of the method.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setCapacity( R(TI::*methodPtr)(Parameters...), Capacity capacity );
+
+   /// Sets the capacity of an interface method.
+   ///
+   /// This method works the same as the other setCapacity method. The
+   /// difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method to limit.
+   ///
+   /// \param[in] capacity
+   ///   The capacity of the method.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setCapacity(
+      R(TI::*methodPtr)(Parameters...) const,
+      Capacity capacity );
+
+   /// Gets the capacity statistics of an interface method.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method with a capacity.
+   ///
+   /// \returns
+   ///   The statistics of the method, empty if the method has no capacity.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   CapacityStatistics getCapacityStatistics(
+      R(TI::*methodPtr)(Parameters...) ) const;
+
+   /// Gets the capacity statistics of an interface method.
+   ///
+   /// This method works the same as the other getCapacityStatistics method.
+   /// The difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method with a capacity.
+   ///
+   /// \returns
+   ///   The statistics of the method, empty if the method has no capacity.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   CapacityStatistics getCapacityStatistics(
+      R(TI::*methodPtr)(Parameters...) const ) const;
+
+   /// Sets the virtual latency of an interface method returning a future.
+   ///
+   /// The future returned by the method override or stub is then replaced by
+   /// a future that becomes ready when the virtual time of the scheduler has
+   /// advanced by the latency, with the same result. Slow asynchronous
+   /// dependencies can thus be simulated without sleeping, deterministically.
+   /// The future of the override or stub should be ready by the time the
+   /// result is taken. Calls answered by a response aren't deferred.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// auto scheduler = std::make_shared<VirtualScheduler>();
+   /// StoreMock mock( std::make_shared<StoreStub>() );
+   /// mock.setVirtualLatency(
+   ///    &IStore::fetch, scheduler, std::chrono::milliseconds( 20 ) );
+   ///
+   /// auto value = mock.fetch( 1 );
+   /// scheduler->advance( std::chrono::milliseconds( 20 ) );
+   /// std::cout << value.get() << std::endl;
+   /// ~~~
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method returning a std::future.
+   ///
+   /// \param[in] scheduler
+   ///   The scheduler of the virtual time, or null to stop deferring.
+   ///
+   /// \param[in] latency
+   ///   The virtual latency of the results.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setVirtualLatency(
+      R(TI::*methodPtr)(Parameters...),
+      std::shared_ptr<VirtualScheduler> scheduler,
+      std::chrono::nanoseconds latency );
+
+   /// Sets the virtual latency of an interface method returning a future.
+   ///
+   /// This method works the same as the other setVirtualLatency method. The
+   /// difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method returning a std::future.
+   ///
+   /// \param[in] scheduler
+   ///   The scheduler of the virtual time, or null to stop deferring.
+   ///
+   /// \param[in] latency
+   ///   The virtual latency of the results.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename R, typename... Parameters>
+   void setVirtualLatency(
+      R(TI::*methodPtr)(Parameters...) const,
+      std::shared_ptr<VirtualScheduler> scheduler,
+      std::chrono::nanoseconds latency );
+
+   /// Sets a cost model to charge with the costs of the calls.
+   ///
+   /// Every call to a method with a cost in the model is charged to the model
+   /// by the calling thread, whether it's answered by a response, an override
+   /// or the stub. Several mocks may share a model, so the report of the model
+   /// tells the simulated latency of the code under test across all of its
+   /// dependencies.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// auto model = std::make_shared<CostModel>();
+   /// model->setCost(
+   ///    &IStore::get, CostModel::fixed( std::chrono::milliseconds( 3 ) ) );
+   /// mock.setCostModel( model );
+   /// ~~~
+   ///
+   /// \param[in] costModel
+   ///   The cost model, or nullptr to stop charging.
+   ///
+   /// \exception No-throw.
+   ///
+   void setCostModel( std::shared_ptr<CostModel> costModel ) noexcept;
+
    /// Finds all recorded calls for the method provided.
    ///
    /// This find method looks up all recorded occasions of calls to the method
@@ -178,6 +968,85 @@ public:
    template<typename R, typename... Parameters>
    auto find( R(TI::*methodPtr)(Parameters...) const ) const;
 
+   /// Keeps only some of the arguments in calls to an interface method.
+   ///
+   /// From now on, the calls to the method are recorded with only the
+   /// arguments in the columns given. The other arguments are never converted
+   /// or copied. The projection is set in the call recorder and therefore
+   /// applies to all mocks sharing it. The projected calls are looked up with
+   /// the find methods taking the same columns as template arguments.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method who's calls shall be projected.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      typename... Parameters>
+   void project( R(TI::*methodPtr)(Parameters...) );
+
+   /// Keeps only some of the arguments in calls to an interface method.
+   ///
+   /// This method works the same as the other project method. The difference
+   /// is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The interface method who's calls shall be projected.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      typename... Parameters>
+   void project( R(TI::*methodPtr)(Parameters...) const );
+
+   /// Finds all projected calls for the method provided.
+   ///
+   /// This find method looks up the calls to the mock recorded after the
+   /// method was projected with the same columns.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's projected calls shall be looked up.
+   ///
+   /// \returns
+   ///   The projected calls for the provided method, returned as an iterable
+   ///   container of tuples where each tuple contains the converted arguments
+   ///   in the projected columns.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      typename... Parameters>
+   auto find( R(TI::*methodPtr)(Parameters...) );
+
+   /// Finds all projected calls for the method provided.
+   ///
+   /// This find method works the same as the other find method for projected
+   /// calls. The difference is that it takes a const method pointer.
+   ///
+   /// \param[in] methodPtr
+   ///   The method who's projected calls shall be looked up.
+   ///
+   /// \returns
+   ///   The projected calls for the provided method.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column,
+      std::size_t... columns,
+      typename R,
+      typename... Parameters>
+   auto find( R(TI::*methodPtr)(Parameters...) const ) const;
+
    /// Gets the identifier of the theoretical object mocked.
    ///
    /// The identifier that is returned is not connected to the instance of this
@@ -238,7 +1107,8 @@ protected:
    ///
    /// \returns
    ///   The result of the method that is recorded. The result comes from a
-   ///   method override, a stub, or a default value, in that order.
+   ///   response, a method override, a memoized result, a cassette, a stub,
+   ///   or a default value, in that order.
    ///
    /// \exception Exception neutral.
    ///
@@ -260,7 +1130,8 @@ protected:
    ///
    /// \returns
    ///   The result of the method that is recorded. The result comes from a
-   ///   method override, a stub, or a default value, in that order.
+   ///   response, a method override, a memoized result, a cassette, a stub,
+   ///   or a default value, in that order.
    ///
    /// \exception Exception neutral.
    ///
@@ -280,6 +1151,286 @@ private:
 
    std::shared_ptr<TI> stub_;
 
+   std::shared_ptr<Cassette> cassette_;
+
+   std::shared_ptr<TI> candidate_;
+
+   std::shared_ptr<Differential> differential_;
+
+   std::shared_ptr<CostModel> costModel_;
+
+   // Methods who's calls aren't recorded, checked before any filter.
+   std::unordered_set<MethodKey, MethodKeyHash> dropped_;
+
+   // Filters selecting the calls to record, per method.
+   std::unordered_map<
+      MethodKey, std::shared_ptr<ArgumentFilterI>, MethodKeyHash> filters_;
+
+   // Precomputed responses, per method.
+   std::unordered_map<
+      MethodKey, std::shared_ptr<ResponseTableI>, MethodKeyHash> responses_;
+
+   // Memoized stub results, per method.
+   std::unordered_map<
+      MethodKey, std::shared_ptr<MemoTableI>, MethodKeyHash> memos_;
+
+   template<typename R, typename... Parameters, class MethodPtr>
+   ResponseTable<R, Parameters...>& responseTable_( MethodPtr methodPtr );
+
+   // Latencies of a timed method. The histogram is guarded by the mutex, and
+   // the latencies of the recorded calls have a slot each, reserved when the
+   // call is recorded.
+   struct Timing_
+   {
+      Timing_();
+
+      std::mutex mutex;
+
+      LatencyHistogram histogram;
+
+      CallSlots<std::chrono::nanoseconds> latencies;
+
+   };
+
+   std::unordered_map<
+      MethodKey, std::shared_ptr<Timing_>, MethodKeyHash> timings_;
+
+   // Calls in flight, per method and to all tracked methods together.
+   std::unordered_map<
+      MethodKey,
+      std::shared_ptr<ConcurrencyTracker>,
+      MethodKeyHash> concurrency_;
+
+   std::shared_ptr<ConcurrencyTracker> objectConcurrency_;
+
+   // Capacities of the methods emulating saturated dependencies.
+   std::unordered_map<
+      MethodKey, std::shared_ptr<CapacityLimiter>, MethodKeyHash> capacities_;
+
+   // Virtual latencies of the methods returning futures.
+   std::unordered_map<
+      MethodKey, std::shared_ptr<Deferral>, MethodKeyHash> deferrals_;
+
+   template<typename R, typename... Parameters, class MethodPtr>
+   void memoize_( MethodPtr methodPtr, std::size_t capacity );
+
+   template<class MethodPtr>
+   MemoStatistics getMemoStatistics_( MethodPtr methodPtr ) const;
+
+   template<class MethodPtr>
+   void setTimed_( MethodPtr methodPtr, bool timed );
+
+   template<class MethodPtr>
+   Timing_* timing_( MethodPtr methodPtr ) const;
+
+   // The slots of a recorded call, NONE for the values that aren't kept.
+   struct RecordedSlots_
+   {
+      RecordedSlots_();
+
+      std::size_t latency;
+
+      std::size_t queueingDelay;
+
+   };
+
+   // Records a call, and reserves the slots of its latency if the method is
+   // timed and of its queueing delay if the method has a capacity.
+   template<class MethodPtr, typename... Parameters>
+   RecordedSlots_ record_(
+      Timing_* timing,
+      CapacityLimiter* limiter,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   template<class MethodPtr>
+   LatencyHistogram getLatencyHistogram_( MethodPtr methodPtr ) const;
+
+   template<class MethodPtr>
+   std::vector<std::chrono::nanoseconds> findLatencies_(
+      MethodPtr methodPtr ) const;
+
+   template<class MethodPtr>
+   void setConcurrencyTracked_( MethodPtr methodPtr, bool tracked );
+
+   template<class MethodPtr>
+   ConcurrencyTracker* concurrencyTracker_( MethodPtr methodPtr ) const;
+
+   template<class MethodPtr>
+   CapacityLimiter* capacityLimiter_( MethodPtr methodPtr ) const;
+
+   template<typename R, class MethodPtr>
+   void setVirtualLatency_(
+      MethodPtr methodPtr,
+      std::shared_ptr<VirtualScheduler> scheduler,
+      std::chrono::nanoseconds latency );
+
+   static ConcurrencyProfile getConcurrencyProfile_(
+      const ConcurrencyTracker* tracker );
+
+   // Calls the method through the concurrency tracking, the capacity and the
+   // deferral of the method.
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callImplementation_(
+      std::size_t delaySlot,
+      const std::string& cassetteKey,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callDeferred_(
+      std::false_type,
+      const std::string& cassetteKey,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callDeferred_(
+      std::true_type,
+      const std::string& cassetteKey,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   // Calls the method override, or else the stub in one way or another.
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callTarget_(
+      const std::string& cassetteKey,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callTimed_(
+      Timing_& timing,
+      const RecordedSlots_& slots,
+      const std::string& cassetteKey,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callMemoized_(
+      const std::string& cassetteKey,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   // Calls the stub through the cassette, if the call goes on the cassette.
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callThrough_(
+      const std::string& cassetteKey,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   const ResponseT<R>* respond_(
+      MethodPtr methodPtr,
+      const Parameters&... arguments ) const;
+
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callStub_( MethodPtr methodPtr, Parameters&&... arguments ) const;
+
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callMirrored_(
+      std::true_type,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callMirrored_(
+      std::false_type,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      std::size_t... indices>
+   static R callCandidate_(
+      TI& candidate,
+      MethodPtr methodPtr,
+      std::tuple<CandidateArgumentT<FncParameters>...>& arguments,
+      std::index_sequence<indices...> );
+
+   // The key of a call on the cassette, or an empty string if there is no
+   // cassette or the call can't be put on it.
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   std::string cassetteKey_(
+      MethodPtr methodPtr,
+      const Parameters&... arguments ) const;
+
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callCassette_(
+      std::true_type,
+      const std::string& key,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   template<
+      typename R,
+      typename... FncParameters,
+      class MethodPtr,
+      typename... Parameters>
+   R callCassette_(
+      std::false_type,
+      const std::string& key,
+      MethodPtr methodPtr,
+      Parameters&&... arguments ) const;
+
+   template<typename... FncParameters, class MethodPtr, typename... Parameters>
+   bool isRecorded_(
+      MethodPtr methodPtr,
+      const Parameters&... arguments ) const;
 
 };
 
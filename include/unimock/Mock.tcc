@@ -14,6 +14,11 @@ ________________________________________________________________________________
 #pragma once
 
 #include <utility>      // std::move, std::forward
+#include <type_traits>
+#include <tuple>
+#include <chrono>
+#include <cstdint>      // std::uint64_t
+#include <mutex>
 
 
 namespace unimock
@@ -25,7 +30,20 @@ Mock<TI, ConversionPolicy>::Mock()
    mockID_( FiniteID::generate() ),
    recorder_( std::make_shared<CallRecorder<ConversionPolicy>>() ),
    functionMap_(),
-   stub_()
+   stub_(),
+   cassette_(),
+   candidate_(),
+   differential_(),
+   costModel_(),
+   dropped_(),
+   filters_(),
+   responses_(),
+   memos_(),
+   timings_(),
+   concurrency_(),
+   objectConcurrency_(),
+   capacities_(),
+   deferrals_()
 {
 }
 
@@ -36,7 +54,20 @@ Mock<TI, ConversionPolicy>::Mock(
    mockID_( FiniteID::generate() ),
    recorder_( std::move( recorder ) ),
    functionMap_(),
-   stub_()
+   stub_(),
+   cassette_(),
+   candidate_(),
+   differential_(),
+   costModel_(),
+   dropped_(),
+   filters_(),
+   responses_(),
+   memos_(),
+   timings_(),
+   concurrency_(),
+   objectConcurrency_(),
+   capacities_(),
+   deferrals_()
 {
 }
 
@@ -46,7 +77,20 @@ Mock<TI, ConversionPolicy>::Mock( std::shared_ptr<TI> stub )
    mockID_( FiniteID::generate() ),
    recorder_( std::make_shared<CallRecorder<ConversionPolicy>>() ),
    functionMap_(),
-   stub_( std::move( stub ) )
+   stub_( std::move( stub ) ),
+   cassette_(),
+   candidate_(),
+   differential_(),
+   costModel_(),
+   dropped_(),
+   filters_(),
+   responses_(),
+   memos_(),
+   timings_(),
+   concurrency_(),
+   objectConcurrency_(),
+   capacities_(),
+   deferrals_()
 {
 }
 
@@ -58,7 +102,20 @@ Mock<TI, ConversionPolicy>::Mock(
    mockID_( FiniteID::generate() ),
    recorder_( std::move( recorder ) ),
    functionMap_(),
-   stub_( std::move( stub ) )
+   stub_( std::move( stub ) ),
+   cassette_(),
+   candidate_(),
+   differential_(),
+   costModel_(),
+   dropped_(),
+   filters_(),
+   responses_(),
+   memos_(),
+   timings_(),
+   concurrency_(),
+   objectConcurrency_(),
+   capacities_(),
+   deferrals_()
 {
 }
 
@@ -78,6 +135,327 @@ void Mock<TI, ConversionPolicy>::override(
    functionMap_.set( methodPtr, std::move( functor ) );
 }
 
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setRecorded(
+   R(TI::*methodPtr)(Parameters...), bool recorded )
+{
+   if( recorded )
+      dropped_.erase( methodPtr );
+   else
+      dropped_.insert( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setRecorded(
+   R(TI::*methodPtr)(Parameters...) const, bool recorded )
+{
+   if( recorded )
+      dropped_.erase( methodPtr );
+   else
+      dropped_.insert( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters, class F>
+void Mock<TI, ConversionPolicy>::setFilter(
+   R(TI::*methodPtr)(Parameters...), F predicate )
+{
+   filters_[ methodPtr ] =
+      std::make_shared<ArgumentFilter<Parameters...>>( std::move( predicate ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters, class F>
+void Mock<TI, ConversionPolicy>::setFilter(
+   R(TI::*methodPtr)(Parameters...) const, F predicate )
+{
+   filters_[ methodPtr ] =
+      std::make_shared<ArgumentFilter<Parameters...>>( std::move( predicate ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setResponse(
+   R(TI::*methodPtr)(Parameters...),
+   std::tuple<std::decay_t<Parameters>...> arguments,
+   ResponseT<R> response )
+{
+   responseTable_<R, Parameters...>( methodPtr ).set(
+      std::move( arguments ), std::move( response ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setResponse(
+   R(TI::*methodPtr)(Parameters...) const,
+   std::tuple<std::decay_t<Parameters>...> arguments,
+   ResponseT<R> response )
+{
+   responseTable_<R, Parameters...>( methodPtr ).set(
+      std::move( arguments ), std::move( response ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setResponseSequence(
+   R(TI::*methodPtr)(Parameters...),
+   std::vector<ResponseT<R>> responses )
+{
+   responseTable_<R, Parameters...>( methodPtr ).setSequence(
+      std::move( responses ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setResponseSequence(
+   R(TI::*methodPtr)(Parameters...) const,
+   std::vector<ResponseT<R>> responses )
+{
+   responseTable_<R, Parameters...>( methodPtr ).setSequence(
+      std::move( responses ) );
+}
+
+template<class TI, class ConversionPolicy>
+void Mock<TI, ConversionPolicy>::setCassette(
+   std::shared_ptr<Cassette> cassette ) noexcept
+{
+   cassette_ = std::move( cassette );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::memoize(
+   R(TI::*methodPtr)(Parameters...),
+   std::size_t capacity )
+{
+   memoize_<R, Parameters...>( methodPtr, capacity );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::memoize(
+   R(TI::*methodPtr)(Parameters...) const,
+   std::size_t capacity )
+{
+   memoize_<R, Parameters...>( methodPtr, capacity );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+MemoStatistics Mock<TI, ConversionPolicy>::getMemoStatistics(
+   R(TI::*methodPtr)(Parameters...) ) const
+{
+   return getMemoStatistics_( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+MemoStatistics Mock<TI, ConversionPolicy>::getMemoStatistics(
+   R(TI::*methodPtr)(Parameters...) const ) const
+{
+   return getMemoStatistics_( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+void Mock<TI, ConversionPolicy>::setCandidate(
+   std::shared_ptr<TI> candidate,
+   CandidateExecution execution )
+{
+   candidate_ = std::move( candidate );
+   differential_ = candidate_
+      ? std::make_shared<Differential>(
+         execution == CandidateExecution::ASYNCHRONOUS )
+      : nullptr;
+}
+
+template<class TI, class ConversionPolicy>
+void Mock<TI, ConversionPolicy>::flushCandidate()
+{
+   if( differential_ )
+      differential_->flush();
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+DifferentialReport Mock<TI, ConversionPolicy>::getDifferentialReport(
+   R(TI::*methodPtr)(Parameters...) ) const
+{
+   if( !differential_ )
+      return DifferentialReport();
+
+   return differential_->getReport( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+DifferentialReport Mock<TI, ConversionPolicy>::getDifferentialReport(
+   R(TI::*methodPtr)(Parameters...) const ) const
+{
+   if( !differential_ )
+      return DifferentialReport();
+
+   return differential_->getReport( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setTimed(
+   R(TI::*methodPtr)(Parameters...),
+   bool timed )
+{
+   setTimed_( methodPtr, timed );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setTimed(
+   R(TI::*methodPtr)(Parameters...) const,
+   bool timed )
+{
+   setTimed_( methodPtr, timed );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+LatencyHistogram Mock<TI, ConversionPolicy>::getLatencyHistogram(
+   R(TI::*methodPtr)(Parameters...) ) const
+{
+   return getLatencyHistogram_( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+LatencyHistogram Mock<TI, ConversionPolicy>::getLatencyHistogram(
+   R(TI::*methodPtr)(Parameters...) const ) const
+{
+   return getLatencyHistogram_( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+std::vector<std::chrono::nanoseconds>
+Mock<TI, ConversionPolicy>::findLatencies(
+   R(TI::*methodPtr)(Parameters...) ) const
+{
+   return findLatencies_( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+std::vector<std::chrono::nanoseconds>
+Mock<TI, ConversionPolicy>::findLatencies(
+   R(TI::*methodPtr)(Parameters...) const ) const
+{
+   return findLatencies_( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setConcurrencyTracked(
+   R(TI::*methodPtr)(Parameters...),
+   bool tracked )
+{
+   setConcurrencyTracked_( methodPtr, tracked );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setConcurrencyTracked(
+   R(TI::*methodPtr)(Parameters...) const,
+   bool tracked )
+{
+   setConcurrencyTracked_( methodPtr, tracked );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+ConcurrencyProfile Mock<TI, ConversionPolicy>::getConcurrencyProfile(
+   R(TI::*methodPtr)(Parameters...) ) const
+{
+   return getConcurrencyProfile_( concurrencyTracker_( methodPtr ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+ConcurrencyProfile Mock<TI, ConversionPolicy>::getConcurrencyProfile(
+   R(TI::*methodPtr)(Parameters...) const ) const
+{
+   return getConcurrencyProfile_( concurrencyTracker_( methodPtr ) );
+}
+
+template<class TI, class ConversionPolicy>
+ConcurrencyProfile Mock<TI, ConversionPolicy>::getConcurrencyProfile() const
+{
+   return getConcurrencyProfile_( objectConcurrency_.get() );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setCapacity(
+   R(TI::*methodPtr)(Parameters...),
+   Capacity capacity )
+{
+   capacities_[ methodPtr ] =
+      std::make_shared<CapacityLimiter>( std::move( capacity ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setCapacity(
+   R(TI::*methodPtr)(Parameters...) const,
+   Capacity capacity )
+{
+   capacities_[ methodPtr ] =
+      std::make_shared<CapacityLimiter>( std::move( capacity ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+CapacityStatistics Mock<TI, ConversionPolicy>::getCapacityStatistics(
+   R(TI::*methodPtr)(Parameters...) ) const
+{
+   auto limiter = capacityLimiter_( methodPtr );
+   return limiter ? limiter->getStatistics() : CapacityStatistics();
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+CapacityStatistics Mock<TI, ConversionPolicy>::getCapacityStatistics(
+   R(TI::*methodPtr)(Parameters...) const ) const
+{
+   auto limiter = capacityLimiter_( methodPtr );
+   return limiter ? limiter->getStatistics() : CapacityStatistics();
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setVirtualLatency(
+   R(TI::*methodPtr)(Parameters...),
+   std::shared_ptr<VirtualScheduler> scheduler,
+   std::chrono::nanoseconds latency )
+{
+   setVirtualLatency_<R>( methodPtr, std::move( scheduler ), latency );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters>
+void Mock<TI, ConversionPolicy>::setVirtualLatency(
+   R(TI::*methodPtr)(Parameters...) const,
+   std::shared_ptr<VirtualScheduler> scheduler,
+   std::chrono::nanoseconds latency )
+{
+   setVirtualLatency_<R>( methodPtr, std::move( scheduler ), latency );
+}
+
+template<class TI, class ConversionPolicy>
+void Mock<TI, ConversionPolicy>::setCostModel(
+   std::shared_ptr<CostModel> costModel ) noexcept
+{
+   costModel_ = std::move( costModel );
+}
+
 template<class TI, class ConversionPolicy>
 template<typename R, typename... Parameters>
 auto Mock<TI, ConversionPolicy>::find(
@@ -94,6 +472,54 @@ auto Mock<TI, ConversionPolicy>::find(
    return recorder_->find( mockID_, methodPtr );
 }
 
+template<class TI, class ConversionPolicy>
+template<
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
+   typename... Parameters>
+void Mock<TI, ConversionPolicy>::project(
+   R(TI::*methodPtr)(Parameters...) )
+{
+   recorder_->template project<column, columns...>( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
+   typename... Parameters>
+void Mock<TI, ConversionPolicy>::project(
+   R(TI::*methodPtr)(Parameters...) const )
+{
+   recorder_->template project<column, columns...>( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
+   typename... Parameters>
+auto Mock<TI, ConversionPolicy>::find(
+   R(TI::*methodPtr)(Parameters...) )
+{
+   return recorder_->template find<column, columns...>( mockID_, methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   std::size_t column,
+   std::size_t... columns,
+   typename R,
+   typename... Parameters>
+auto Mock<TI, ConversionPolicy>::find(
+   R(TI::*methodPtr)(Parameters...) const ) const
+{
+   return recorder_->template find<column, columns...>( mockID_, methodPtr );
+}
+
 template<class TI, class ConversionPolicy>
 FiniteID Mock<TI, ConversionPolicy>::getID() const
 {
@@ -106,24 +532,44 @@ R Mock<TI, ConversionPolicy>::call(
    R(TI::*methodPtr)(FncParameters...),
    Parameters&&... arguments )
 {
-   recorder_->record(
-      mockID_, methodPtr, std::forward<Parameters>( arguments )... );
+   // The call is charged until it returns.
+   CostModel::Charge charge( costModel_.get(), methodPtr );
 
-   auto overridingFunctor = functionMap_.get( methodPtr );
-   if( overridingFunctor )
+   // The response and the cassette key are looked up before the arguments
+   // are forwarded to the recorder, which may move from them.
+   auto response = respond_<R, FncParameters...>( methodPtr, arguments... );
+   auto cassetteKey =
+      cassetteKey_<R, FncParameters...>( methodPtr, arguments... );
+
+   Timing_* timing = timing_( methodPtr );
+   RecordedSlots_ slots;
+   if( isRecorded_<FncParameters...>( methodPtr, arguments... ) )
    {
-      return static_cast<R>(
-         overridingFunctor( std::forward<Parameters>( arguments )... ) );
+      slots = record_(
+         timing,
+         capacityLimiter_( methodPtr ),
+         methodPtr,
+         std::forward<Parameters>( arguments )... );
    }
 
-   if( stub_ )
+   if( response )
+      return ResponseTable<R, FncParameters...>::result( *response );
+
+   if( timing )
    {
-      return static_cast<R>(
-         ((*stub_).*methodPtr)( std::forward<Parameters>( arguments )... ) );
+      return callTimed_<R, FncParameters...>(
+         *timing,
+         slots,
+         cassetteKey,
+         methodPtr,
+         std::forward<Parameters>( arguments )... );
    }
 
-   // Without an overriding functor or a stub we just return some default value.
-   return static_cast<R>( R() );
+   return callImplementation_<R, FncParameters...>(
+      slots.queueingDelay,
+      cassetteKey,
+      methodPtr,
+      std::forward<Parameters>( arguments )... );
 }
 
 template<class TI, class ConversionPolicy>
@@ -132,9 +578,330 @@ R Mock<TI, ConversionPolicy>::call(
    R(TI::*methodPtr)(FncParameters...) const,
    Parameters&&... arguments ) const
 {
-   recorder_->record(
-      mockID_, methodPtr, std::forward<Parameters>( arguments )... );
+   // The call is charged until it returns.
+   CostModel::Charge charge( costModel_.get(), methodPtr );
+
+   // The response and the cassette key are looked up before the arguments
+   // are forwarded to the recorder, which may move from them.
+   auto response = respond_<R, FncParameters...>( methodPtr, arguments... );
+   auto cassetteKey =
+      cassetteKey_<R, FncParameters...>( methodPtr, arguments... );
+
+   Timing_* timing = timing_( methodPtr );
+   RecordedSlots_ slots;
+   if( isRecorded_<FncParameters...>( methodPtr, arguments... ) )
+   {
+      slots = record_(
+         timing,
+         capacityLimiter_( methodPtr ),
+         methodPtr,
+         std::forward<Parameters>( arguments )... );
+   }
+
+   if( response )
+      return ResponseTable<R, FncParameters...>::result( *response );
+
+   if( timing )
+   {
+      return callTimed_<R, FncParameters...>(
+         *timing,
+         slots,
+         cassetteKey,
+         methodPtr,
+         std::forward<Parameters>( arguments )... );
+   }
+
+   return callImplementation_<R, FncParameters...>(
+      slots.queueingDelay,
+      cassetteKey,
+      methodPtr,
+      std::forward<Parameters>( arguments )... );
+}
+
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters, class MethodPtr>
+ResponseTable<R, Parameters...>& Mock<TI, ConversionPolicy>::responseTable_(
+   MethodPtr methodPtr )
+{
+   auto& responseTable = responses_[ methodPtr ];
+   if( !responseTable )
+      responseTable = std::make_shared<ResponseTable<R, Parameters...>>();
+
+   return static_cast<ResponseTable<R, Parameters...>&>( *responseTable );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, typename... Parameters, class MethodPtr>
+void Mock<TI, ConversionPolicy>::memoize_(
+   MethodPtr methodPtr,
+   std::size_t capacity )
+{
+   static_assert(
+      !std::is_void<R>::value &&
+      std::is_copy_constructible<ResponseT<R>>::value,
+      "Memoized methods must return a copyable value" );
+   static_assert(
+      AllOf<!IsOutParameter<Parameters>::value...>::value,
+      "Memoized methods can't have out parameters" );
+
+   memos_[ methodPtr ] =
+      std::make_shared<MemoTable<R, Parameters...>>( capacity );
+}
+
+template<class TI, class ConversionPolicy>
+template<class MethodPtr>
+MemoStatistics Mock<TI, ConversionPolicy>::getMemoStatistics_(
+   MethodPtr methodPtr ) const
+{
+   auto memoTable = memos_.find( methodPtr );
+   if( memoTable == memos_.end() )
+      return MemoStatistics{ 0, 0, 0 };
+
+   return MemoStatistics{
+      memoTable->second->hits(),
+      memoTable->second->misses(),
+      memoTable->second->size() };
+}
+
+template<class TI, class ConversionPolicy>
+Mock<TI, ConversionPolicy>::Timing_::Timing_()
+:
+   mutex(),
+   histogram(),
+   latencies( std::chrono::nanoseconds::min() )
+{
+}
+
+template<class TI, class ConversionPolicy>
+template<class MethodPtr>
+auto Mock<TI, ConversionPolicy>::timing_( MethodPtr methodPtr ) const
+   -> Timing_*
+{
+   if( timings_.empty() )
+      return nullptr;
+
+   auto timing = timings_.find( methodPtr );
+   return timing != timings_.end() ? timing->second.get() : nullptr;
+}
+
+template<class TI, class ConversionPolicy>
+Mock<TI, ConversionPolicy>::RecordedSlots_::RecordedSlots_()
+:
+   latency( CallSlots<std::chrono::nanoseconds>::NONE ),
+   queueingDelay( CallSlots<std::chrono::nanoseconds>::NONE )
+{
+}
+
+template<class TI, class ConversionPolicy>
+template<class MethodPtr, typename... Parameters>
+auto Mock<TI, ConversionPolicy>::record_(
+   Timing_* timing,
+   CapacityLimiter* limiter,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const -> RecordedSlots_
+{
+   RecordedSlots_ slots;
+
+   auto record = [&]
+   {
+      recorder_->record(
+         mockID_, methodPtr, std::forward<Parameters>( arguments )... );
+   };
+   auto recordQueued = [&]
+   {
+      if( limiter )
+         slots.queueingDelay = limiter->reserve( record );
+      else
+         record();
+   };
+
+   if( timing )
+      slots.latency = timing->latencies.reserve( recordQueued );
+   else
+      recordQueued();
+
+   return slots;
+}
+
+template<class TI, class ConversionPolicy>
+template<class MethodPtr>
+void Mock<TI, ConversionPolicy>::setTimed_( MethodPtr methodPtr, bool timed )
+{
+   if( timed )
+      timings_[ methodPtr ] = std::make_shared<Timing_>();
+   else
+      timings_.erase( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<class MethodPtr>
+LatencyHistogram Mock<TI, ConversionPolicy>::getLatencyHistogram_(
+   MethodPtr methodPtr ) const
+{
+   auto timing = timings_.find( methodPtr );
+   if( timing == timings_.end() )
+      return LatencyHistogram();
+
+   std::lock_guard<std::mutex> lock( timing->second->mutex );
+   return timing->second->histogram;
+}
+
+template<class TI, class ConversionPolicy>
+template<class MethodPtr>
+std::vector<std::chrono::nanoseconds>
+Mock<TI, ConversionPolicy>::findLatencies_( MethodPtr methodPtr ) const
+{
+   auto timing = timings_.find( methodPtr );
+   if( timing == timings_.end() )
+      return std::vector<std::chrono::nanoseconds>();
+
+   return timing->second->latencies.values();
+}
+
+template<class TI, class ConversionPolicy>
+template<class MethodPtr>
+void Mock<TI, ConversionPolicy>::setConcurrencyTracked_(
+   MethodPtr methodPtr,
+   bool tracked )
+{
+   if( tracked )
+      concurrency_[ methodPtr ] = std::make_shared<ConcurrencyTracker>();
+   else
+      concurrency_.erase( methodPtr );
+
+   if( concurrency_.empty() )
+      objectConcurrency_.reset();
+   else if( !objectConcurrency_ )
+      objectConcurrency_ = std::make_shared<ConcurrencyTracker>();
+}
+
+template<class TI, class ConversionPolicy>
+template<class MethodPtr>
+ConcurrencyTracker* Mock<TI, ConversionPolicy>::concurrencyTracker_(
+   MethodPtr methodPtr ) const
+{
+   if( concurrency_.empty() )
+      return nullptr;
+
+   auto tracker = concurrency_.find( methodPtr );
+   return tracker != concurrency_.end() ? tracker->second.get() : nullptr;
+}
+
+template<class TI, class ConversionPolicy>
+template<typename R, class MethodPtr>
+void Mock<TI, ConversionPolicy>::setVirtualLatency_(
+   MethodPtr methodPtr,
+   std::shared_ptr<VirtualScheduler> scheduler,
+   std::chrono::nanoseconds latency )
+{
+   static_assert( IsFuture<R>::value, "Only futures can be deferred" );
+
+   if( scheduler )
+   {
+      deferrals_[ methodPtr ] =
+         std::make_shared<Deferral>( std::move( scheduler ), latency );
+   }
+   else
+      deferrals_.erase( methodPtr );
+}
+
+template<class TI, class ConversionPolicy>
+template<class MethodPtr>
+CapacityLimiter* Mock<TI, ConversionPolicy>::capacityLimiter_(
+   MethodPtr methodPtr ) const
+{
+   if( capacities_.empty() )
+      return nullptr;
+
+   auto limiter = capacities_.find( methodPtr );
+   return limiter != capacities_.end() ? limiter->second.get() : nullptr;
+}
+
+template<class TI, class ConversionPolicy>
+ConcurrencyProfile Mock<TI, ConversionPolicy>::getConcurrencyProfile_(
+   const ConcurrencyTracker* tracker )
+{
+   return tracker ? tracker->getProfile() : ConcurrencyProfile();
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callImplementation_(
+   std::size_t delaySlot,
+   const std::string& cassetteKey,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
+   // A call waiting for a server of the capacity isn't in flight yet.
+   CapacityLimiter::Slot slot( capacityLimiter_( methodPtr ), delaySlot );
+   auto tracker = concurrencyTracker_( methodPtr );
+   ConcurrencyTracker::Scope objectScope(
+      tracker ? objectConcurrency_.get() : nullptr );
+   ConcurrencyTracker::Scope methodScope( tracker );
+   slot.serve();
 
+   return callDeferred_<R, FncParameters...>(
+      IsFuture<R>(),
+      cassetteKey,
+      methodPtr,
+      std::forward<Parameters>( arguments )... );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callDeferred_(
+   std::false_type,
+   const std::string& cassetteKey,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
+   return callTarget_<R, FncParameters...>(
+      cassetteKey, methodPtr, std::forward<Parameters>( arguments )... );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callDeferred_(
+   std::true_type,
+   const std::string& cassetteKey,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
+   auto result = callTarget_<R, FncParameters...>(
+      cassetteKey, methodPtr, std::forward<Parameters>( arguments )... );
+
+   auto deferral = deferrals_.find( methodPtr );
+   if( deferral == deferrals_.end() )
+      return result;
+
+   return deferral->second->scheduler->deferred(
+      deferral->second->latency, std::move( result ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callTarget_(
+   const std::string& cassetteKey,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
    auto overridingFunctor = functionMap_.get( methodPtr );
    if( overridingFunctor )
    {
@@ -142,15 +909,345 @@ R Mock<TI, ConversionPolicy>::call(
          overridingFunctor( std::forward<Parameters>( arguments )... ) );
    }
 
+   if( !memos_.empty() )
+   {
+      return callMemoized_<R, FncParameters...>(
+         cassetteKey, methodPtr, std::forward<Parameters>( arguments )... );
+   }
+
+   return callThrough_<R, FncParameters...>(
+      cassetteKey, methodPtr, std::forward<Parameters>( arguments )... );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callTimed_(
+   Timing_& timing,
+   const RecordedSlots_& slots,
+   const std::string& cassetteKey,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
+   using Clock = std::chrono::steady_clock;
+
+   const auto start = Clock::now();
+   ResponseT<R> result = CassetteCall<R, FncParameters...>::invoke( [&]() -> R
+   {
+      return callImplementation_<R, FncParameters...>(
+         slots.queueingDelay,
+         cassetteKey,
+         methodPtr,
+         std::forward<Parameters>( arguments )... );
+   } );
+   const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now() - start );
+
+   {
+      std::lock_guard<std::mutex> lock( timing.mutex );
+      timing.histogram.add( static_cast<std::uint64_t>( latency.count() ) );
+   }
+   timing.latencies.fill( slots.latency, latency );
+
+   return CassetteCall<R, FncParameters...>::result( std::move( result ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callMemoized_(
+   const std::string& cassetteKey,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
+   auto memo = memos_.find( methodPtr );
+   if( memo == memos_.end() )
+   {
+      return callThrough_<R, FncParameters...>(
+         cassetteKey, methodPtr, std::forward<Parameters>( arguments )... );
+   }
+
+   auto& memoTable =
+      static_cast<MemoTable<R, FncParameters...>&>( *memo->second );
+
+   ResponseT<R> result;
+   if( memoTable.find( result, arguments... ) )
+      return ResponseTable<R, FncParameters...>::result( result );
+
+   auto key = memoTable.key( arguments... );
+   result = CassetteCall<R, FncParameters...>::invoke( [&]() -> R
+   {
+      return callThrough_<R, FncParameters...>(
+         cassetteKey, methodPtr, std::forward<Parameters>( arguments )... );
+   } );
+   memoTable.insert( key, result );
+
+   return ResponseTable<R, FncParameters...>::result( result );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callThrough_(
+   const std::string& cassetteKey,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
+   if( !cassetteKey.empty() )
+   {
+      return callCassette_<R, FncParameters...>(
+         typename CassetteCall<R, FncParameters...>::IsSupported(),
+         cassetteKey,
+         methodPtr,
+         std::forward<Parameters>( arguments )... );
+   }
+
+   return callStub_<R, FncParameters...>(
+      methodPtr, std::forward<Parameters>( arguments )... );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+const ResponseT<R>* Mock<TI, ConversionPolicy>::respond_(
+   MethodPtr methodPtr,
+   const Parameters&... arguments ) const
+{
+   if( responses_.empty() )
+      return nullptr;
+
+   auto responseTable = responses_.find( methodPtr );
+   if( responseTable == responses_.end() )
+      return nullptr;
+
+   return static_cast<ResponseTable<R, FncParameters...>&>(
+      *responseTable->second ).respond( arguments... );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callStub_(
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
+   if( stub_ && candidate_ )
+   {
+      // Only calls with copyable results, and arguments that can be kept
+      // for the candidate, are mirrored.
+      using IsMirrored = AllOf<
+         std::is_copy_constructible<ResponseT<R>>::value,
+         CandidateArgument<std::decay_t<FncParameters>>::MIRRORED...>;
+
+      return callMirrored_<R, FncParameters...>(
+         IsMirrored(), methodPtr, std::forward<Parameters>( arguments )... );
+   }
+
    if( stub_ )
    {
       return static_cast<R>(
          ((*stub_).*methodPtr)( std::forward<Parameters>( arguments )... ) );
    }
 
+   // Without an overriding functor or a stub we just return some default value.
    return static_cast<R>( R() );
 }
 
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callMirrored_(
+   std::true_type,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
+   using Clock = std::chrono::steady_clock;
+   using ArgumentsT = std::tuple<CandidateArgumentT<FncParameters>...>;
+
+   // The candidate gets a copy of the arguments, taken before the stub may
+   // move from them or change them.
+   ArgumentsT candidateArguments(
+      CandidateArgument<std::decay_t<FncParameters>>::copy( arguments )... );
+
+   const auto start = Clock::now();
+   ResponseT<R> result = CassetteCall<R, FncParameters...>::invoke( [&]() -> R
+   {
+      return static_cast<R>(
+         ((*stub_).*methodPtr)( std::forward<Parameters>( arguments )... ) );
+   } );
+   const auto primaryLatency = Clock::now() - start;
+
+   // The differential outlives the calls it runs, since it waits for them
+   // before it's destroyed.
+   auto candidate = candidate_;
+   auto differential = differential_.get();
+   differential_->run(
+      [candidate, differential, methodPtr, primaryLatency, result,
+       candidateArguments]() mutable
+   {
+      Comparison comparison = Comparison::MISMATCH;
+      const auto start = Clock::now();
+      try
+      {
+         ResponseT<R> candidateResult =
+            CassetteCall<R, FncParameters...>::invoke( [&]() -> R
+         {
+            return callCandidate_<R, FncParameters...>(
+               *candidate,
+               methodPtr,
+               candidateArguments,
+               std::index_sequence_for<FncParameters...>() );
+         } );
+         comparison = Differential::compare<FncParameters...>(
+            result, candidateResult );
+      }
+      catch( ... )
+      {
+      }
+
+      differential->report(
+         methodPtr, primaryLatency, Clock::now() - start, comparison );
+   } );
+
+   return CassetteCall<R, FncParameters...>::result( std::move( result ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callMirrored_(
+   std::false_type,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
+   return static_cast<R>(
+      ((*stub_).*methodPtr)( std::forward<Parameters>( arguments )... ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   std::size_t... indices>
+R Mock<TI, ConversionPolicy>::callCandidate_(
+   TI& candidate,
+   MethodPtr methodPtr,
+   std::tuple<CandidateArgumentT<FncParameters>...>& arguments,
+   std::index_sequence<indices...> )
+{
+   return static_cast<R>( (candidate.*methodPtr)(
+      std::forward<FncParameters>(
+         CandidateArgument<std::decay_t<FncParameters>>::pass(
+            std::get<indices>( arguments ) ) )... ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+std::string Mock<TI, ConversionPolicy>::cassetteKey_(
+   MethodPtr methodPtr,
+   const Parameters&... arguments ) const
+{
+   if( !cassette_ )
+      return std::string();
+
+   return CassetteCall<R, FncParameters...>::key( methodPtr, arguments... );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callCassette_(
+   std::true_type,
+   const std::string& key,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
+   using CassetteCallT = CassetteCall<R, FncParameters...>;
+
+   ResponseT<R> response;
+   if( cassette_->mode() == Cassette::Mode::REPLAY )
+   {
+      if( CassetteCallT::replay( *cassette_, key, response, arguments... ) )
+         return CassetteCallT::result( std::move( response ) );
+
+      return callStub_<R, FncParameters...>(
+         methodPtr, std::forward<Parameters>( arguments )... );
+   }
+
+   response = CassetteCallT::invoke( [&]() -> R
+   {
+      return callStub_<R, FncParameters...>(
+         methodPtr, std::forward<Parameters>( arguments )... );
+   } );
+   CassetteCallT::record( *cassette_, key, response, arguments... );
+
+   return CassetteCallT::result( std::move( response ) );
+}
+
+template<class TI, class ConversionPolicy>
+template<
+   typename R,
+   typename... FncParameters,
+   class MethodPtr,
+   typename... Parameters>
+R Mock<TI, ConversionPolicy>::callCassette_(
+   std::false_type,
+   const std::string&,
+   MethodPtr methodPtr,
+   Parameters&&... arguments ) const
+{
+   return callStub_<R, FncParameters...>(
+      methodPtr, std::forward<Parameters>( arguments )... );
+}
+
+template<class TI, class ConversionPolicy>
+template<typename... FncParameters, class MethodPtr, typename... Parameters>
+bool Mock<TI, ConversionPolicy>::isRecorded_(
+   MethodPtr methodPtr,
+   const Parameters&... arguments ) const
+{
+   if( !dropped_.empty() && dropped_.count( methodPtr ) > 0 )
+      return false;
+
+   if( filters_.empty() )
+      return true;
+
+   auto filter = filters_.find( methodPtr );
+   if( filter == filters_.end() )
+      return true;
+
+   return static_cast<const ArgumentFilter<FncParameters...>&>(
+      *filter->second ).predicate( arguments... );
+}
 
 } // namespace
 
@@ -0,0 +1,94 @@
+/*
+
+   PrefixConversionPolicy.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <array>
+
+#include "Internal/BoundedConversionPolicy.hh"
+
+
+namespace unimock
+{
+
+/// Prefix of the bytes in an argument.
+///
+/// The prefix holds the size in bytes of the argument and a copy of at most N
+/// of its first bytes.
+///
+template<std::size_t N>
+struct Prefix
+{
+   /// The size of the argument in bytes.
+   std::size_t size;
+
+   /// The number of bytes kept, the smaller of the size and N.
+   std::size_t length;
+
+   std::array<unsigned char, N> bytes;
+
+};
+
+template<std::size_t N>
+bool operator==( const Prefix<N>& lhs, const Prefix<N>& rhs ) noexcept;
+
+template<std::size_t N>
+bool operator!=( const Prefix<N>& lhs, const Prefix<N>& rhs ) noexcept;
+
+/// Capture of prefixes, used by the PrefixConversionPolicy.
+///
+template<std::size_t N>
+struct PrefixCapture
+{
+   template<typename T>
+   using Applies = IsByteRange<T>;
+
+   template<class Range>
+   static Prefix<N> capture( const Range& range ) noexcept;
+
+   static Prefix<N> capture( const char* stringPtr ) noexcept;
+
+};
+
+/// Makes a prefix to compare with the prefixes of recorded arguments.
+///
+/// \param[in] object
+///   A string, a string literal, or a vector or array of arithmetic values.
+///
+/// \returns
+///   The prefix of the object.
+///
+/// \exception No-throw.
+///
+template<std::size_t N, typename T>
+Prefix<N> makePrefix( const T& object ) noexcept;
+
+/// PrefixConversionPolicy to convert from one type to another.
+///
+/// This conversion policy stores a Prefix of at most N bytes instead of a copy
+/// of strings, string literals, const char*, and vectors and arrays of
+/// arithmetic values, also when they are passed by pointer or std::unique_ptr.
+/// The size and the start of large buffers, like headers, can then be checked
+/// without the cost of a deep copy. All other types are converted like in the
+/// DefaultConversionPolicy.
+///
+template<std::size_t N = 64>
+using PrefixConversionPolicy = BoundedConversionPolicy<PrefixCapture<N>>;
+
+
+} // namespace
+
+
+// Implementation.
+#include "PrefixConversionPolicy.tcc"
@@ -0,0 +1,73 @@
+/*
+
+   PrefixConversionPolicy.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstring>      // std::memcpy, std::memcmp, std::strlen
+#include <algorithm>    // std::min
+
+
+namespace unimock
+{
+
+namespace
+{
+template<std::size_t N>
+Prefix<N> makePrefixFromBytes( const void* data, std::size_t size ) noexcept
+{
+   Prefix<N> prefix{};
+   prefix.size = size;
+   prefix.length = std::min( size, N );
+   std::memcpy( prefix.bytes.data(), data, prefix.length );
+
+   return prefix;
+}
+
+} // unnamed namespace
+
+
+template<std::size_t N>
+bool operator==( const Prefix<N>& lhs, const Prefix<N>& rhs ) noexcept
+{
+   return lhs.size == rhs.size &&
+      lhs.length == rhs.length &&
+      std::memcmp( lhs.bytes.data(), rhs.bytes.data(), lhs.length ) == 0;
+}
+
+template<std::size_t N>
+bool operator!=( const Prefix<N>& lhs, const Prefix<N>& rhs ) noexcept
+{
+   return !( lhs == rhs );
+}
+
+template<std::size_t N>
+template<class Range>
+Prefix<N> PrefixCapture<N>::capture( const Range& range ) noexcept
+{
+   return makePrefixFromBytes<N>( byteData( range ), byteSize( range ) );
+}
+
+template<std::size_t N>
+Prefix<N> PrefixCapture<N>::capture( const char* stringPtr ) noexcept
+{
+   return makePrefixFromBytes<N>( stringPtr, std::strlen( stringPtr ) );
+}
+
+template<std::size_t N, typename T>
+Prefix<N> makePrefix( const T& object ) noexcept
+{
+   return PrefixConversionPolicy<N>::convert( object );
+}
+
+
+} // namespace
@@ -0,0 +1,151 @@
+/*
+
+   QuantileSketch.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <vector>
+
+
+namespace unimock
+{
+
+/// QuantileSketch to estimate quantiles of a stream of values.
+///
+/// The quantile sketch is a merging t-digest. It keeps a bounded number of
+/// centroids, each representing a cluster of nearby values, and therefore
+/// uses constant memory no matter how many values are added. The clusters are
+/// kept small near the extreme quantiles, which makes estimates like the 99th
+/// percentile accurate. Two sketches can be merged.
+///
+/// #### See also ####
+/// [t-digest](https://github.com/tdunning/t-digest)
+///
+class QuantileSketch
+{
+public:
+
+   /// Constructor.
+   ///
+   /// \param[in] compression
+   ///   The compression parameter, bounding the number of centroids. Higher
+   ///   values give more accurate estimates but use more memory.
+   ///
+   /// \exception Exception neutral.
+   ///
+   explicit QuantileSketch( double compression = 100.0 );
+
+   /// Adds a value to the sketch.
+   ///
+   /// \param[in] value
+   ///   The value to add.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void add( double value );
+
+   /// Merges another sketch into this sketch.
+   ///
+   /// \param[in] other
+   ///   The sketch to merge.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void merge( const QuantileSketch& other );
+
+   /// Gets the number of values added.
+   ///
+   /// \returns
+   ///   The number of values added.
+   ///
+   /// \exception No-throw.
+   ///
+   std::size_t size() const noexcept;
+
+   /// Gets the smallest value added.
+   ///
+   /// \pre The sketch must not be empty.
+   ///
+   /// \returns
+   ///   The exact smallest value.
+   ///
+   /// \exception No-throw.
+   ///
+   double min() const noexcept;
+
+   /// Gets the largest value added.
+   ///
+   /// \pre The sketch must not be empty.
+   ///
+   /// \returns
+   ///   The exact largest value.
+   ///
+   /// \exception No-throw.
+   ///
+   double max() const noexcept;
+
+   /// Estimates a quantile.
+   ///
+   /// The sketch isn't modified by the estimate, so several threads may
+   /// estimate quantiles of the same sketch at once. Values still buffered
+   /// since the last compression are merged into a copy of the centroids.
+   ///
+   /// \pre The sketch must not be empty.
+   ///
+   /// \param[in] q
+   ///   The quantile, between 0 and 1. The median is 0.5 and the 99th
+   ///   percentile is 0.99.
+   ///
+   /// \returns
+   ///   The estimated value at the quantile.
+   ///
+   /// \exception Exception neutral.
+   ///
+   double quantile( double q ) const;
+
+
+private:
+
+   struct Centroid_
+   {
+      double mean;
+      double weight;
+   };
+
+   double compression_;
+
+   std::size_t count_;
+
+   double min_;
+
+   double max_;
+
+   // Incoming values are buffered and merged into the centroids when the
+   // buffer is full or another sketch is merged.
+   std::vector<Centroid_> centroids_;
+
+   std::vector<Centroid_> buffer_;
+
+   static void compress_(
+      double compression,
+      std::vector<Centroid_>& buffer,
+      std::vector<Centroid_>& centroids );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "QuantileSketch.icc"
@@ -16,6 +16,8 @@ ________________________________________________________________________________
 #include <vector>
 #include <tuple>
 
+#include "unimock/ThreadPool.hh"
+
 
 namespace unimock
 {
@@ -28,11 +30,33 @@ namespace unimock
 /// ResultSet is one way to access the data, and the idea with this helper class
 /// is that it should provide an interface similar to a database result set.
 ///
+/// The rows can be accessed with compile-time indices, with run-time indices,
+/// or by iterating over the result set. All element access is done by const
+/// reference so large result sets can be checked without copying. A temporary
+/// result set hands out its elements by value instead, so they don't dangle.
+///
+/// #### Example ####
+/// ~~~
+/// auto resultSet = makeResultSet( mock, &ISomeClass::setInt );
+///
+/// for( std::size_t row = 0; row < resultSet.size(); row++ )
+///    assert( resultSet.get<0>( row ) < 8000 );
+///
+/// for( auto& call : resultSet )
+///    assert( std::get<0>( call ) < 8000 );
+/// ~~~
+///
 template<typename... Parameters>
 class ResultSet
 {
 public:
 
+   /// The type of a row in the result set.
+   using value_type = std::tuple<Parameters...>;
+
+   /// Random access iterator over the rows in the result set.
+   using const_iterator = typename std::vector<value_type>::const_iterator;
+
    /// Constructor.
    ///
    /// This constructor makes a result set out of the container provided.
@@ -56,18 +80,93 @@ public:
    ///
    auto size() const noexcept;
 
+   /// Checks whether the result set is empty.
+   ///
+   /// \retval true
+   ///   The result set has no rows.
+   ///
+   /// \retval false
+   ///   The result set has at least one row.
+   ///
+   /// \exception No-throw.
+   ///
+   bool empty() const noexcept;
+
+   /// Gets an iterator to the first row in the result set.
+   ///
+   /// \returns
+   ///   A random access iterator to the first row.
+   ///
+   /// \exception No-throw.
+   ///
+   const_iterator begin() const noexcept;
+
+   /// Gets an iterator past the last row in the result set.
+   ///
+   /// \returns
+   ///   A random access iterator past the last row.
+   ///
+   /// \exception No-throw.
+   ///
+   const_iterator end() const noexcept;
+
+   /// Gets the row at the position provided.
+   ///
+   /// This operator returns the whole row as a tuple. The row is provided in
+   /// run-time, which makes it suitable for loops over large result sets.
+   ///
+   /// \param[in] row
+   ///   The index of the row.
+   ///
+   /// \returns
+   ///   A const reference to the row.
+   ///
+   /// \exception No-throw.
+   ///
+   const value_type& operator[]( std::size_t row ) const& noexcept;
+
+   /// Gets the row at the position provided.
+   ///
+   /// This overload is used on a temporary result set, such as the one
+   /// returned by makeResultSet. It moves the row out of the result set and
+   /// returns it by value, so the row can't outlive the result set.
+   ///
+   /// \param[in] row
+   ///   The index of the row.
+   ///
+   /// \returns
+   ///   The row at the position provided.
+   ///
+   /// \exception Exception neutral.
+   ///
+   value_type operator[]( std::size_t row ) &&;
+
    /// Gets the element at position [row, column].
    ///
    /// This method returns the element at the row and column provided. The row
    /// and column shall be provided as integers.
    ///
    /// \returns
+   ///   A const reference to the element at the position [row, column].
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t row, std::size_t column>
+   const auto& get() const&;
+
+   /// Gets the element at position [row, column].
+   ///
+   /// This overload is used on a temporary result set, such as the one
+   /// returned by makeResultSet. It moves the element out of the result set and
+   /// returns it by value, so the element can't outlive the result set.
+   ///
+   /// \returns
    ///   The element at the position [row, column].
    ///
    /// \exception Exception neutral.
    ///
    template<std::size_t row, std::size_t column>
-   auto get() const;
+   auto get() &&;
 
    /// Gets the element at position [row, column].
    ///
@@ -77,18 +176,456 @@ public:
    /// type then an index must be used instead.
    ///
    /// \returns
-   ///   The element at the position [row, column] where row is an integer and
-   ///   column is the type of the column sought.
+   ///   A const reference to the element at the position [row, column] where
+   ///   row is an integer and column is the type of the column sought.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t row, typename ColumnT>
+   const auto& get() const&;
+
+   /// Gets the element at position [row, column].
+   ///
+   /// This overload is used on a temporary result set, such as the one
+   /// returned by makeResultSet. It moves the element out of the result set and
+   /// returns it by value, so the element can't outlive the result set.
+   ///
+   /// \returns
+   ///   The element at the position [row, column].
    ///
    /// \exception Exception neutral.
    ///
    template<std::size_t row, typename ColumnT>
-   auto get() const;
+   auto get() &&;
+
+   /// Gets the element at position [row, column].
+   ///
+   /// This method works the same as the get method taking both row and column
+   /// as template arguments. The difference is that the row is provided in
+   /// run-time.
+   ///
+   /// \param[in] row
+   ///   The index of the row.
+   ///
+   /// \returns
+   ///   A const reference to the element at the position [row, column].
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   const auto& get( std::size_t row ) const&;
+
+   /// Gets the element at position [row, column].
+   ///
+   /// This overload is used on a temporary result set, such as the one
+   /// returned by makeResultSet. It moves the element out of the result set and
+   /// returns it by value, so the element can't outlive the result set.
+   ///
+   /// \param[in] row
+   ///   The index of the row.
+   ///
+   /// \returns
+   ///   The element at the position [row, column].
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   auto get( std::size_t row ) &&;
+
+   /// Gets the element at position [row, column].
+   ///
+   /// This method works the same as the get method taking the column as a
+   /// type. The difference is that the row is provided in run-time.
+   ///
+   /// \param[in] row
+   ///   The index of the row.
+   ///
+   /// \returns
+   ///   A const reference to the element at the position [row, column] where
+   ///   column is the type of the column sought.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename ColumnT>
+   const ColumnT& get( std::size_t row ) const&;
+
+   /// Gets the element at position [row, column].
+   ///
+   /// This overload is used on a temporary result set, such as the one
+   /// returned by makeResultSet. It moves the element out of the result set and
+   /// returns it by value, so the element can't outlive the result set.
+   ///
+   /// \param[in] row
+   ///   The index of the row.
+   ///
+   /// \returns
+   ///   The element at the position [row, column].
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename ColumnT>
+   ColumnT get( std::size_t row ) &&;
+
+   /// Sums all elements in a column.
+   ///
+   /// The column must be of an arithmetic type. Integral columns are summed as
+   /// 64 bit integers and floating point columns as double or long double.
+   /// Since the elements are summed in parallel lanes, a floating point sum may
+   /// differ slightly from a sum done in strict row order.
+   ///
+   /// \returns
+   ///   The sum of all elements in the column, or zero if the result set is
+   ///   empty.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   auto sum() const;
+
+   /// Gets the smallest element in a column.
+   ///
+   /// The column must be of an arithmetic type.
+   ///
+   /// \pre The result set must not be empty.
+   ///
+   /// \returns
+   ///   The smallest element in the column.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   auto min() const;
+
+   /// Gets the largest element in a column.
+   ///
+   /// The column must be of an arithmetic type.
+   ///
+   /// \pre The result set must not be empty.
+   ///
+   /// \returns
+   ///   The largest element in the column.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   auto max() const;
+
+   /// Gets the arithmetic mean of a column.
+   ///
+   /// The column must be of an arithmetic type.
+   ///
+   /// \pre The result set must not be empty.
+   ///
+   /// \returns
+   ///   The mean of all elements in the column.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   double mean() const;
+
+   /// Checks whether all elements in a column are within a range.
+   ///
+   /// The column must be of an arithmetic type.
+   ///
+   /// \param[in] low
+   ///   The lowest value allowed, inclusive.
+   ///
+   /// \param[in] high
+   ///   The highest value allowed, inclusive.
+   ///
+   /// \retval true
+   ///   All elements are within the range, or the result set is empty.
+   ///
+   /// \retval false
+   ///   At least one element is outside the range.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   bool allWithin(
+      const std::tuple_element_t<column, value_type>& low,
+      const std::tuple_element_t<column, value_type>& high ) const;
+
+   /// Checks whether a column is monotonically non-decreasing.
+   ///
+   /// The column must be of an arithmetic type.
+   ///
+   /// \retval true
+   ///   Every element is equal to or larger than the element in the row
+   ///   before, or the result set is empty.
+   ///
+   /// \retval false
+   ///   At least one element is smaller than the element in the row before.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   bool isMonotonic() const;
+
+   /// Sums all elements in a column in parallel.
+   ///
+   /// This method works the same as the sum method without a thread pool. The
+   /// difference is that the rows are split into chunks that are summed on
+   /// the thread pool provided.
+   ///
+   /// \param[in] threadPool
+   ///   The thread pool to process the chunks.
+   ///
+   /// \returns
+   ///   The sum of all elements in the column, or zero if the result set is
+   ///   empty.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   auto sum( ThreadPool& threadPool ) const;
+
+   /// Gets the smallest element in a column in parallel.
+   ///
+   /// \pre The result set must not be empty.
+   ///
+   /// \param[in] threadPool
+   ///   The thread pool to process the chunks.
+   ///
+   /// \returns
+   ///   The smallest element in the column.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   auto min( ThreadPool& threadPool ) const;
+
+   /// Gets the largest element in a column in parallel.
+   ///
+   /// \pre The result set must not be empty.
+   ///
+   /// \param[in] threadPool
+   ///   The thread pool to process the chunks.
+   ///
+   /// \returns
+   ///   The largest element in the column.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   auto max( ThreadPool& threadPool ) const;
+
+   /// Gets the arithmetic mean of a column in parallel.
+   ///
+   /// \pre The result set must not be empty.
+   ///
+   /// \param[in] threadPool
+   ///   The thread pool to process the chunks.
+   ///
+   /// \returns
+   ///   The mean of all elements in the column.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   double mean( ThreadPool& threadPool ) const;
+
+   /// Checks in parallel whether all elements in a column are within a range.
+   ///
+   /// \param[in] low
+   ///   The lowest value allowed, inclusive.
+   ///
+   /// \param[in] high
+   ///   The highest value allowed, inclusive.
+   ///
+   /// \param[in] threadPool
+   ///   The thread pool to process the chunks.
+   ///
+   /// \retval true
+   ///   All elements are within the range, or the result set is empty.
+   ///
+   /// \retval false
+   ///   At least one element is outside the range.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   bool allWithin(
+      const std::tuple_element_t<column, value_type>& low,
+      const std::tuple_element_t<column, value_type>& high,
+      ThreadPool& threadPool ) const;
+
+   /// Checks in parallel whether a column is monotonically non-decreasing.
+   ///
+   /// \param[in] threadPool
+   ///   The thread pool to process the chunks.
+   ///
+   /// \retval true
+   ///   Every element is equal to or larger than the element in the row
+   ///   before, or the result set is empty.
+   ///
+   /// \retval false
+   ///   At least one element is smaller than the element in the row before.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   bool isMonotonic( ThreadPool& threadPool ) const;
+
+   /// Gets the rows matching a predicate.
+   ///
+   /// \param[in] predicate
+   ///   The predicate called with each row as a tuple. The predicate shall
+   ///   return true for the rows to keep.
+   ///
+   /// \returns
+   ///   A new result set with the matching rows, in the same order as in this
+   ///   result set.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class Predicate>
+   ResultSet filter( Predicate predicate ) const;
+
+   /// Gets the rows matching a predicate in parallel.
+   ///
+   /// This method works the same as the other filter method. The difference is
+   /// that the rows are split into chunks that are filtered on the thread pool
+   /// provided. The predicate must therefore be safe to call concurrently.
+   ///
+   /// \param[in] predicate
+   ///   The predicate called with each row as a tuple. The predicate shall
+   ///   return true for the rows to keep.
+   ///
+   /// \param[in] threadPool
+   ///   The thread pool to process the chunks.
+   ///
+   /// \returns
+   ///   A new result set with the matching rows, in the same order as in this
+   ///   result set.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class Predicate>
+   ResultSet filter( Predicate predicate, ThreadPool& threadPool ) const;
+
+   /// Counts the rows matching a predicate.
+   ///
+   /// \param[in] predicate
+   ///   The predicate called with each row as a tuple.
+   ///
+   /// \returns
+   ///   The number of rows for which the predicate returns true.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class Predicate>
+   std::size_t count( Predicate predicate ) const;
+
+   /// Counts the rows matching a predicate in parallel.
+   ///
+   /// The predicate must be safe to call concurrently.
+   ///
+   /// \param[in] predicate
+   ///   The predicate called with each row as a tuple.
+   ///
+   /// \param[in] threadPool
+   ///   The thread pool to process the chunks.
+   ///
+   /// \returns
+   ///   The number of rows for which the predicate returns true.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<class Predicate>
+   std::size_t count( Predicate predicate, ThreadPool& threadPool ) const;
+
+   /// Sorts the rows by a column.
+   ///
+   /// The sort is stable, so rows with equal elements in the column keep the
+   /// order they were recorded in. The column type must be less-than
+   /// comparable. The complexity is O(n log n).
+   ///
+   /// \returns
+   ///   A new result set with the rows sorted in ascending order.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column>
+   ResultSet sortBy() const;
+
+   /// Groups the rows by one or more columns and counts them.
+   ///
+   /// Each distinct combination of elements in the columns provided forms a
+   /// group. The groups are formed with a hash table, so the column types must
+   /// be hashable with std::hash and equality comparable. The complexity is
+   /// O(n) on average.
+   ///
+   /// #### Example ####
+   /// ~~~
+   /// auto groups = resultSet.groupBy<0>();
+   /// for( auto& group : groups )
+   ///    std::cout << std::get<0>( group ) << ": " << std::get<1>( group );
+   /// ~~~
+   ///
+   /// \returns
+   ///   A new result set with one row per group, in the order each group was
+   ///   first seen. Each row holds the grouped columns followed by the number
+   ///   of rows in the group.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<std::size_t column, std::size_t... columns>
+   auto groupBy() const;
+
+   /// Joins the rows with the rows of another result set on equal columns.
+   ///
+   /// Each row in this result set is combined with every row in the other
+   /// result set where the columns provided are equal. A hash table is built
+   /// over the other result set, so the column type must be hashable with
+   /// std::hash and equality comparable. The complexity is O(n + m) on average,
+   /// plus the size of the result.
+   ///
+   /// \param[in] other
+   ///   The result set to join with.
+   ///
+   /// \returns
+   ///   A new result set where each row holds the columns of this result set
+   ///   followed by the columns of the other. The rows are ordered by this
+   ///   result set first and the other result set second.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<
+      std::size_t column, std::size_t otherColumn, typename... OtherParameters>
+   auto hashJoin( const ResultSet<OtherParameters...>& other ) const;
+
+   /// Joins the rows with the rows of another result set by position.
+   ///
+   /// The first row in this result set is combined with the first row in the
+   /// other, the second with the second, and so on. This is useful to pair
+   /// calls that are expected to come in sequence, like a request and its
+   /// response to another mock. The complexity is O(n).
+   ///
+   /// \param[in] other
+   ///   The result set to join with.
+   ///
+   /// \returns
+   ///   A new result set where each row holds the columns of this result set
+   ///   followed by the columns of the other. The size is the smaller of the
+   ///   two result sets.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename... OtherParameters>
+   auto sequenceJoin( const ResultSet<OtherParameters...>& other ) const;
 
 
 private:
 
-   std::vector<std::tuple<Parameters...>> resultSet_;
+   std::vector<value_type> resultSet_;
+
+   template<std::size_t column, class Kernel>
+   void aggregate_( Kernel& kernel, std::size_t first, std::size_t last ) const;
+
+   template<std::size_t column, class Kernel>
+   void aggregate_( Kernel& kernel, ThreadPool& threadPool ) const;
 
 
 };
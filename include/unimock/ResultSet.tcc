@@ -14,8 +14,15 @@ ________________________________________________________________________________
 #pragma once
 
 #include <utility>      // std::move
+#include <algorithm>    // std::min, std::move, std::stable_sort
+#include <iterator>     // std::back_inserter
+#include <unordered_map>
+#include <type_traits>
 #include <cassert>
 
+#include "Internal/ColumnKernels.hh"
+#include "Internal/Hash.hh"
+
 
 namespace unimock
 {
@@ -34,24 +41,492 @@ auto ResultSet<Parameters...>::size() const noexcept
    return resultSet_.size();
 }
 
+template<typename... Parameters>
+bool ResultSet<Parameters...>::empty() const noexcept
+{
+   return resultSet_.empty();
+}
+
+template<typename... Parameters>
+auto ResultSet<Parameters...>::begin() const noexcept -> const_iterator
+{
+   return resultSet_.begin();
+}
+
+template<typename... Parameters>
+auto ResultSet<Parameters...>::end() const noexcept -> const_iterator
+{
+   return resultSet_.end();
+}
+
+template<typename... Parameters>
+auto ResultSet<Parameters...>::operator[]( std::size_t row ) const& noexcept
+   -> const value_type&
+{
+   assert( row < resultSet_.size() );
+
+   return resultSet_[ row ];
+}
+
+template<typename... Parameters>
+auto ResultSet<Parameters...>::operator[]( std::size_t row ) && -> value_type
+{
+   assert( row < resultSet_.size() );
+
+   return std::move( resultSet_[ row ] );
+}
+
 template<typename... Parameters>
 template<std::size_t row, std::size_t column>
-auto ResultSet<Parameters...>::get() const
+const auto& ResultSet<Parameters...>::get() const&
 {
    assert( row < resultSet_.size() );
 
    return std::get<column>( resultSet_[ row ] );
 }
 
+template<typename... Parameters>
+template<std::size_t row, std::size_t column>
+auto ResultSet<Parameters...>::get() &&
+{
+   assert( row < resultSet_.size() );
+
+   return std::get<column>( std::move( resultSet_[ row ] ) );
+}
+
 template<typename... Parameters>
 template<std::size_t row, typename ColumnT>
-auto ResultSet<Parameters...>::get() const
+const auto& ResultSet<Parameters...>::get() const&
+{
+   assert( row < resultSet_.size() );
+
+   return std::get<ColumnT>( resultSet_[ row ] );
+}
+
+template<typename... Parameters>
+template<std::size_t row, typename ColumnT>
+auto ResultSet<Parameters...>::get() &&
+{
+   assert( row < resultSet_.size() );
+
+   return std::get<ColumnT>( std::move( resultSet_[ row ] ) );
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+const auto& ResultSet<Parameters...>::get( std::size_t row ) const&
+{
+   assert( row < resultSet_.size() );
+
+   return std::get<column>( resultSet_[ row ] );
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+auto ResultSet<Parameters...>::get( std::size_t row ) &&
+{
+   assert( row < resultSet_.size() );
+
+   return std::get<column>( std::move( resultSet_[ row ] ) );
+}
+
+template<typename... Parameters>
+template<typename ColumnT>
+const ColumnT& ResultSet<Parameters...>::get( std::size_t row ) const&
 {
    assert( row < resultSet_.size() );
 
    return std::get<ColumnT>( resultSet_[ row ] );
 }
 
+template<typename... Parameters>
+template<typename ColumnT>
+ColumnT ResultSet<Parameters...>::get( std::size_t row ) &&
+{
+   assert( row < resultSet_.size() );
+
+   return std::get<ColumnT>( std::move( resultSet_[ row ] ) );
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+auto ResultSet<Parameters...>::sum() const
+{
+   SumKernel<std::tuple_element_t<column, value_type>> kernel;
+   aggregate_<column>( kernel, 0, resultSet_.size() );
+
+   return kernel.result;
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+auto ResultSet<Parameters...>::min() const
+{
+   assert( !resultSet_.empty() );
+
+   MinKernel<std::tuple_element_t<column, value_type>> kernel;
+   aggregate_<column>( kernel, 0, resultSet_.size() );
+
+   return kernel.result;
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+auto ResultSet<Parameters...>::max() const
+{
+   assert( !resultSet_.empty() );
+
+   MaxKernel<std::tuple_element_t<column, value_type>> kernel;
+   aggregate_<column>( kernel, 0, resultSet_.size() );
+
+   return kernel.result;
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+double ResultSet<Parameters...>::mean() const
+{
+   assert( !resultSet_.empty() );
+
+   return static_cast<double>( sum<column>() ) /
+      static_cast<double>( resultSet_.size() );
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+bool ResultSet<Parameters...>::allWithin(
+   const std::tuple_element_t<column, value_type>& low,
+   const std::tuple_element_t<column, value_type>& high ) const
+{
+   WithinKernel<std::tuple_element_t<column, value_type>> kernel( low, high );
+   aggregate_<column>( kernel, 0, resultSet_.size() );
+
+   return kernel.result;
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+bool ResultSet<Parameters...>::isMonotonic() const
+{
+   MonotonicKernel<std::tuple_element_t<column, value_type>> kernel;
+   aggregate_<column>( kernel, 0, resultSet_.size() );
+
+   return kernel.result;
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+auto ResultSet<Parameters...>::sum( ThreadPool& threadPool ) const
+{
+   SumKernel<std::tuple_element_t<column, value_type>> kernel;
+   aggregate_<column>( kernel, threadPool );
+
+   return kernel.result;
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+auto ResultSet<Parameters...>::min( ThreadPool& threadPool ) const
+{
+   assert( !resultSet_.empty() );
+
+   MinKernel<std::tuple_element_t<column, value_type>> kernel;
+   aggregate_<column>( kernel, threadPool );
+
+   return kernel.result;
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+auto ResultSet<Parameters...>::max( ThreadPool& threadPool ) const
+{
+   assert( !resultSet_.empty() );
+
+   MaxKernel<std::tuple_element_t<column, value_type>> kernel;
+   aggregate_<column>( kernel, threadPool );
+
+   return kernel.result;
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+double ResultSet<Parameters...>::mean( ThreadPool& threadPool ) const
+{
+   assert( !resultSet_.empty() );
+
+   return static_cast<double>( sum<column>( threadPool ) ) /
+      static_cast<double>( resultSet_.size() );
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+bool ResultSet<Parameters...>::allWithin(
+   const std::tuple_element_t<column, value_type>& low,
+   const std::tuple_element_t<column, value_type>& high,
+   ThreadPool& threadPool ) const
+{
+   WithinKernel<std::tuple_element_t<column, value_type>> kernel( low, high );
+   aggregate_<column>( kernel, threadPool );
+
+   return kernel.result;
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+bool ResultSet<Parameters...>::isMonotonic( ThreadPool& threadPool ) const
+{
+   MonotonicKernel<std::tuple_element_t<column, value_type>> kernel;
+   aggregate_<column>( kernel, threadPool );
+
+   return kernel.result;
+}
+
+template<typename... Parameters>
+template<class Predicate>
+auto ResultSet<Parameters...>::filter( Predicate predicate ) const -> ResultSet
+{
+   std::vector<value_type> resultSet;
+
+   for( auto& row : resultSet_ )
+   {
+      if( predicate( row ) )
+         resultSet.push_back( row );
+   }
+
+   return ResultSet( std::move( resultSet ) );
+}
+
+template<typename... Parameters>
+template<class Predicate>
+auto ResultSet<Parameters...>::filter(
+   Predicate predicate, ThreadPool& threadPool ) const -> ResultSet
+{
+   const std::size_t size = resultSet_.size();
+   const std::size_t chunkCount = threadPool.chunkCount( size );
+
+   // Each chunk is filtered separately and the partial results are then
+   // concatenated in chunk order to keep the row order.
+   std::vector<std::vector<value_type>> chunkResults( chunkCount );
+   threadPool.parallelFor( chunkCount, [&]( std::size_t chunk )
+   {
+      const std::size_t last = size * ( chunk + 1 ) / chunkCount;
+
+      for( std::size_t row = size * chunk / chunkCount; row < last; row++ )
+      {
+         if( predicate( resultSet_[ row ] ) )
+            chunkResults[ chunk ].push_back( resultSet_[ row ] );
+      }
+   } );
+
+   std::size_t resultSize = 0;
+   for( auto& chunkResult : chunkResults )
+      resultSize += chunkResult.size();
+
+   std::vector<value_type> resultSet;
+   resultSet.reserve( resultSize );
+   for( auto& chunkResult : chunkResults )
+   {
+      std::move(
+         chunkResult.begin(),
+         chunkResult.end(),
+         std::back_inserter( resultSet ) );
+   }
+
+   return ResultSet( std::move( resultSet ) );
+}
+
+template<typename... Parameters>
+template<class Predicate>
+std::size_t ResultSet<Parameters...>::count( Predicate predicate ) const
+{
+   std::size_t matches = 0;
+
+   for( auto& row : resultSet_ )
+   {
+      if( predicate( row ) )
+         matches++;
+   }
+
+   return matches;
+}
+
+template<typename... Parameters>
+template<class Predicate>
+std::size_t ResultSet<Parameters...>::count(
+   Predicate predicate, ThreadPool& threadPool ) const
+{
+   const std::size_t size = resultSet_.size();
+   const std::size_t chunkCount = threadPool.chunkCount( size );
+
+   std::vector<std::size_t> chunkMatches( chunkCount, 0 );
+   threadPool.parallelFor( chunkCount, [&]( std::size_t chunk )
+   {
+      const std::size_t last = size * ( chunk + 1 ) / chunkCount;
+
+      for( std::size_t row = size * chunk / chunkCount; row < last; row++ )
+      {
+         if( predicate( resultSet_[ row ] ) )
+            chunkMatches[ chunk ]++;
+      }
+   } );
+
+   std::size_t matches = 0;
+   for( auto chunkMatch : chunkMatches )
+      matches += chunkMatch;
+
+   return matches;
+}
+
+template<typename... Parameters>
+template<std::size_t column>
+auto ResultSet<Parameters...>::sortBy() const -> ResultSet
+{
+   std::vector<value_type> resultSet( resultSet_ );
+
+   std::stable_sort(
+      resultSet.begin(),
+      resultSet.end(),
+      []( const value_type& left, const value_type& right )
+      {
+         return std::get<column>( left ) < std::get<column>( right );
+      } );
+
+   return ResultSet( std::move( resultSet ) );
+}
+
+template<typename... Parameters>
+template<std::size_t column, std::size_t... columns>
+auto ResultSet<Parameters...>::groupBy() const
+{
+   using KeyT = std::tuple<
+      std::tuple_element_t<column, value_type>,
+      std::tuple_element_t<columns, value_type>...>;
+
+   // The hash table maps each key to its row in the result, which keeps the
+   // groups in the order they were first seen.
+   std::unordered_map<KeyT, std::size_t, TupleHash<KeyT>> groupRows;
+   std::vector<decltype(
+      std::tuple_cat( std::declval<KeyT>(), std::tuple<std::size_t>() ) )>
+         resultSet;
+
+   for( auto& row : resultSet_ )
+   {
+      auto group = groupRows.emplace(
+         KeyT( std::get<column>( row ), std::get<columns>( row )... ),
+         resultSet.size() );
+
+      if( group.second )
+      {
+         resultSet.emplace_back( std::tuple_cat(
+            group.first->first, std::tuple<std::size_t>( 0 ) ) );
+      }
+
+      std::get<sizeof...( columns ) + 1>( resultSet[ group.first->second ] )++;
+   }
+
+   return makeResultSet( std::move( resultSet ) );
+}
+
+template<typename... Parameters>
+template<
+   std::size_t column, std::size_t otherColumn, typename... OtherParameters>
+auto ResultSet<Parameters...>::hashJoin(
+   const ResultSet<OtherParameters...>& other ) const
+{
+   using KeyT =
+      std::tuple_element_t<otherColumn, std::tuple<OtherParameters...>>;
+
+   // Build the hash table over the other result set. Each key maps to its
+   // rows in order, so the other result set's order is kept in the result.
+   std::unordered_map<KeyT, std::vector<std::size_t>> otherRows;
+   for( std::size_t row = 0; row < other.size(); row++ )
+      otherRows[ other.template get<otherColumn>( row ) ].push_back( row );
+
+   std::vector<std::tuple<Parameters..., OtherParameters...>> resultSet;
+
+   for( auto& row : resultSet_ )
+   {
+      auto rows = otherRows.find( std::get<column>( row ) );
+      if( rows == otherRows.end() )
+         continue;
+
+      for( auto otherRow : rows->second )
+         resultSet.emplace_back( std::tuple_cat( row, other[ otherRow ] ) );
+   }
+
+   return makeResultSet( std::move( resultSet ) );
+}
+
+template<typename... Parameters>
+template<typename... OtherParameters>
+auto ResultSet<Parameters...>::sequenceJoin(
+   const ResultSet<OtherParameters...>& other ) const
+{
+   const std::size_t size = std::min( resultSet_.size(), other.size() );
+
+   std::vector<std::tuple<Parameters..., OtherParameters...>> resultSet;
+   resultSet.reserve( size );
+
+   for( std::size_t row = 0; row < size; row++ )
+   {
+      resultSet.emplace_back(
+         std::tuple_cat( resultSet_[ row ], other[ row ] ) );
+   }
+
+   return makeResultSet( std::move( resultSet ) );
+}
+
+template<typename... Parameters>
+template<std::size_t column, class Kernel>
+void ResultSet<Parameters...>::aggregate_(
+   Kernel& kernel, std::size_t first, std::size_t last ) const
+{
+   using ColumnT = std::tuple_element_t<column, value_type>;
+
+   static_assert(
+      std::is_arithmetic<ColumnT>::value,
+      "Aggregation requires a column of arithmetic type" );
+
+   // The rows are stored as tuples, so the elements of a column aren't
+   // contiguous in memory. We gather the column in blocks small enough to stay
+   // in the L1 cache and let the kernel run over each contiguous block.
+   constexpr const std::size_t BLOCK_SIZE = 256;
+   ColumnT block[ BLOCK_SIZE ];
+
+   for( std::size_t row = first; row < last; row += BLOCK_SIZE )
+   {
+      const std::size_t count = std::min( BLOCK_SIZE, last - row );
+
+      for( std::size_t i = 0; i < count; i++ )
+         block[ i ] = std::get<column>( resultSet_[ row + i ] );
+
+      kernel( block, count );
+   }
+}
+
+template<typename... Parameters>
+template<std::size_t column, class Kernel>
+void ResultSet<Parameters...>::aggregate_(
+   Kernel& kernel, ThreadPool& threadPool ) const
+{
+   const std::size_t size = resultSet_.size();
+   const std::size_t chunkCount = threadPool.chunkCount( size );
+
+   // Every chunk starts out as a copy of the initial kernel. The partial
+   // results are merged in chunk order since some kernels depend on it.
+   std::vector<Kernel> chunkKernels( chunkCount, kernel );
+   threadPool.parallelFor( chunkCount, [&]( std::size_t chunk )
+   {
+      aggregate_<column>(
+         chunkKernels[ chunk ],
+         size * chunk / chunkCount,
+         size * ( chunk + 1 ) / chunkCount );
+   } );
+
+   for( auto& chunkKernel : chunkKernels )
+      kernel.merge( chunkKernel );
+}
+
 
 template<typename... Parameters>
 auto makeResultSet( std::vector<std::tuple<Parameters...>>&& callHistory )
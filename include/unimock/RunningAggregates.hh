@@ -0,0 +1,132 @@
+/*
+
+   RunningAggregates.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+
+#include "Internal/ColumnKernels.hh"
+
+
+namespace unimock
+{
+
+/// Running count, min, max and sum of arithmetic values.
+///
+/// The running aggregates fold values one at a time in constant memory. The
+/// sum is accumulated in a wider type, see SumT, so that long sequences of
+/// small values don't overflow.
+///
+template<typename T>
+class RunningAggregates
+{
+public:
+
+   static_assert(
+      std::is_arithmetic<T>::value,
+      "Aggregates can only be kept for arithmetic values" );
+
+   /// Constructor.
+   ///
+   /// \exception No-throw.
+   ///
+   RunningAggregates() noexcept;
+
+   /// Folds a value into the aggregates.
+   ///
+   /// \param[in] value
+   ///   The value to fold.
+   ///
+   /// \exception No-throw.
+   ///
+   void add( T value ) noexcept;
+
+   /// Merges another set of aggregates into this one.
+   ///
+   /// \param[in] other
+   ///   The aggregates to merge.
+   ///
+   /// \exception No-throw.
+   ///
+   void merge( const RunningAggregates& other ) noexcept;
+
+   /// Gets the number of values folded.
+   ///
+   /// \returns
+   ///   The number of values.
+   ///
+   /// \exception No-throw.
+   ///
+   std::size_t count() const noexcept;
+
+   /// Gets the smallest value folded.
+   ///
+   /// \pre At least one value must have been folded.
+   ///
+   /// \returns
+   ///   The smallest value.
+   ///
+   /// \exception No-throw.
+   ///
+   T min() const noexcept;
+
+   /// Gets the largest value folded.
+   ///
+   /// \pre At least one value must have been folded.
+   ///
+   /// \returns
+   ///   The largest value.
+   ///
+   /// \exception No-throw.
+   ///
+   T max() const noexcept;
+
+   /// Gets the sum of the values folded.
+   ///
+   /// \returns
+   ///   The sum, zero if no value has been folded.
+   ///
+   /// \exception No-throw.
+   ///
+   SumT<T> sum() const noexcept;
+
+   /// Gets the arithmetic mean of the values folded.
+   ///
+   /// \pre At least one value must have been folded.
+   ///
+   /// \returns
+   ///   The mean.
+   ///
+   /// \exception No-throw.
+   ///
+   double mean() const noexcept;
+
+
+private:
+
+   std::size_t count_;
+
+   T min_;
+
+   T max_;
+
+   SumT<T> sum_;
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "RunningAggregates.tcc"
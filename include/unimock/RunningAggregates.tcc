@@ -0,0 +1,90 @@
+/*
+
+   RunningAggregates.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cassert>
+
+
+namespace unimock
+{
+
+template<typename T>
+RunningAggregates<T>::RunningAggregates() noexcept
+:
+   count_( 0 ),
+   min_(),
+   max_(),
+   sum_( 0 )
+{
+}
+
+template<typename T>
+void RunningAggregates<T>::add( T value ) noexcept
+{
+   min_ = count_ == 0 || value < min_ ? value : min_;
+   max_ = count_ == 0 || max_ < value ? value : max_;
+   sum_ += value;
+   count_++;
+}
+
+template<typename T>
+void RunningAggregates<T>::merge( const RunningAggregates& other ) noexcept
+{
+   if( other.count_ == 0 )
+      return;
+
+   min_ = count_ == 0 || other.min_ < min_ ? other.min_ : min_;
+   max_ = count_ == 0 || max_ < other.max_ ? other.max_ : max_;
+   sum_ += other.sum_;
+   count_ += other.count_;
+}
+
+template<typename T>
+std::size_t RunningAggregates<T>::count() const noexcept
+{
+   return count_;
+}
+
+template<typename T>
+T RunningAggregates<T>::min() const noexcept
+{
+   assert( count_ > 0 );
+
+   return min_;
+}
+
+template<typename T>
+T RunningAggregates<T>::max() const noexcept
+{
+   assert( count_ > 0 );
+
+   return max_;
+}
+
+template<typename T>
+SumT<T> RunningAggregates<T>::sum() const noexcept
+{
+   return sum_;
+}
+
+template<typename T>
+double RunningAggregates<T>::mean() const noexcept
+{
+   assert( count_ > 0 );
+
+   return static_cast<double>( sum_ ) / static_cast<double>( count_ );
+}
+
+
+} // namespace
@@ -0,0 +1,53 @@
+/*
+
+   SizeConversionPolicy.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+
+#include "Internal/BoundedConversionPolicy.hh"
+
+
+namespace unimock
+{
+
+/// Capture of sizes, used by the SizeConversionPolicy.
+///
+struct SizeCapture
+{
+   template<typename T>
+   using Applies = HasSize<T>;
+
+   template<class Container>
+   static std::size_t capture( const Container& container ) noexcept;
+
+   static std::size_t capture( const char* stringPtr ) noexcept;
+
+};
+
+/// SizeConversionPolicy to convert from one type to another.
+///
+/// This conversion policy stores only the size, i.e. the number of elements,
+/// of strings, string literals, const char*, and all types with a size method
+/// such as the standard containers, also when they are passed by pointer or
+/// std::unique_ptr. All other types are converted like in the
+/// DefaultConversionPolicy.
+///
+using SizeConversionPolicy = BoundedConversionPolicy<SizeCapture>;
+
+
+} // namespace
+
+
+// Implementation.
+#include "SizeConversionPolicy.tcc"
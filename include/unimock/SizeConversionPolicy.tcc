@@ -0,0 +1,34 @@
+/*
+
+   SizeConversionPolicy.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstring>      // std::strlen
+
+
+namespace unimock
+{
+
+template<class Container>
+std::size_t SizeCapture::capture( const Container& container ) noexcept
+{
+   return container.size();
+}
+
+inline std::size_t SizeCapture::capture( const char* stringPtr ) noexcept
+{
+   return std::strlen( stringPtr );
+}
+
+
+} // namespace
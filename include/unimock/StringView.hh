@@ -0,0 +1,132 @@
+/*
+
+   StringView.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <string>
+#include <functional>   // std::hash
+
+
+namespace unimock
+{
+
+/// View of a string owned by someone else.
+///
+/// The view refers to a sequence of characters without owning them, like the
+/// std::string_view of C++17. The ArenaConversionPolicy stores string arguments
+/// as views into an arena owned by the call recorder. A view is compared,
+/// ordered and hashed by the characters it refers to. It can be constructed
+/// implicitly from a std::string or a string literal, so it can be compared
+/// directly with those.
+///
+class StringView
+{
+public:
+
+   using value_type = char;
+
+   using const_iterator = const char*;
+
+   /// Constructor.
+   ///
+   /// This constructor constructs an empty view.
+   ///
+   /// \exception No-throw.
+   ///
+   StringView() noexcept;
+
+   /// Constructor.
+   ///
+   /// \param[in] data
+   ///   The first character to refer to.
+   ///
+   /// \param[in] size
+   ///   The number of characters to refer to.
+   ///
+   /// \exception No-throw.
+   ///
+   StringView( const char* data, std::size_t size ) noexcept;
+
+   /// Constructor.
+   ///
+   /// \param[in] string
+   ///   The string to refer to. It must outlive the view.
+   ///
+   /// \exception No-throw.
+   ///
+   StringView( const std::string& string ) noexcept;
+
+   /// Constructor.
+   ///
+   /// \param[in] stringPtr
+   ///   The null terminated string to refer to. It must outlive the view.
+   ///
+   /// \exception No-throw.
+   ///
+   StringView( const char* stringPtr ) noexcept;
+
+   const char* data() const noexcept;
+
+   std::size_t size() const noexcept;
+
+   bool empty() const noexcept;
+
+   const_iterator begin() const noexcept;
+
+   const_iterator end() const noexcept;
+
+   char operator[]( std::size_t index ) const noexcept;
+
+   /// Returns a copy of the characters as a string.
+   ///
+   /// \returns
+   ///   The string.
+   ///
+   /// \exception Exception neutral.
+   ///
+   std::string str() const;
+
+
+private:
+
+   const char* data_;
+
+   std::size_t size_;
+
+};
+
+bool operator==( const StringView& lhs, const StringView& rhs ) noexcept;
+
+bool operator!=( const StringView& lhs, const StringView& rhs ) noexcept;
+
+bool operator<( const StringView& lhs, const StringView& rhs ) noexcept;
+
+
+} // namespace
+
+
+namespace std
+{
+
+template<>
+struct hash<unimock::StringView>
+{
+   std::size_t operator()( const unimock::StringView& view ) const noexcept;
+};
+
+} // namespace
+
+
+// Implementation.
+#include "StringView.icc"
@@ -0,0 +1,159 @@
+/*
+
+   ThreadPool.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>    // std::exception_ptr
+
+
+namespace unimock
+{
+
+/// ThreadPool to process large call histories in parallel.
+///
+/// The thread pool holds a fixed set of worker threads that can be shared by
+/// call recorders and result sets. A job is split into a number of tasks that
+/// are picked up by the workers and the calling thread alike. The caller is
+/// blocked until all tasks of the job have been run, so data owned by the
+/// caller can safely be referenced from the tasks.
+///
+/// #### Example ####
+/// ~~~
+/// auto threadPool = std::make_shared<ThreadPool>( 8 );
+/// recorder->setThreadPool( threadPool );
+///
+/// auto resultSet = makeResultSet( recorder, &ISomeClass::setInt );
+/// assert( resultSet.sum<0>( *threadPool ) == 42 );
+/// ~~~
+///
+class ThreadPool final
+{
+public:
+
+   /// Constructor.
+   ///
+   /// Constructs a thread pool with the number of threads provided. Since the
+   /// calling thread participates in every job, a pool of N threads starts
+   /// N - 1 worker threads.
+   ///
+   /// \param[in] threadCount
+   ///   The number of threads processing a job, including the calling thread.
+   ///   Defaults to the number of hardware threads.
+   ///
+   /// \exception Exception neutral.
+   ///
+   explicit ThreadPool(
+      std::size_t threadCount = std::thread::hardware_concurrency() );
+
+   /// Destructor.
+   ///
+   /// Stops and joins all worker threads.
+   ///
+   /// \exception No-throw.
+   ///
+   ~ThreadPool();
+
+   ThreadPool( const ThreadPool& ) = delete;
+   ThreadPool& operator=( const ThreadPool& ) = delete;
+
+   /// Gets the number of threads processing a job.
+   ///
+   /// \returns
+   ///   The number of threads, including the calling thread.
+   ///
+   /// \exception No-throw.
+   ///
+   std::size_t size() const noexcept;
+
+   /// Gets a suitable number of chunks to split a number of elements into.
+   ///
+   /// The chunks are made large enough for the threading overhead to be
+   /// negligible, and numerous enough to balance the load between the threads.
+   ///
+   /// \param[in] elementCount
+   ///   The number of elements to split.
+   ///
+   /// \returns
+   ///   The number of chunks, at least one.
+   ///
+   /// \exception No-throw.
+   ///
+   std::size_t chunkCount( std::size_t elementCount ) const noexcept;
+
+   /// Runs a number of tasks in parallel.
+   ///
+   /// This method calls the task with every index from zero up to the task
+   /// count, distributed over the threads in the pool. The method returns when
+   /// all tasks are done. If any task throws, the first exception is rethrown
+   /// once all tasks are done. Only one job runs at a time; concurrent callers
+   /// are serialized.
+   ///
+   /// \param[in] taskCount
+   ///   The number of tasks to run.
+   ///
+   /// \param[in] task
+   ///   The task to run, called with the index of the task.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void parallelFor(
+      std::size_t taskCount, const std::function<void(std::size_t)>& task );
+
+
+private:
+
+   std::vector<std::thread> workers_;
+
+   std::mutex jobMutex_;
+
+   std::mutex mutex_;
+
+   std::condition_variable wakeUp_;
+
+   std::condition_variable done_;
+
+   bool stop_;
+
+   std::size_t generation_;
+
+   const std::function<void(std::size_t)>* job_;
+
+   std::size_t taskCount_;
+
+   std::atomic<std::size_t> nextTask_;
+
+   std::size_t completedTasks_;
+
+   std::size_t activeWorkers_;
+
+   std::exception_ptr exception_;
+
+   void work_();
+
+   void runTasks_( const std::function<void(std::size_t)>& task );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "ThreadPool.icc"
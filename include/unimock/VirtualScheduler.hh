@@ -0,0 +1,239 @@
+/*
+
+   VirtualScheduler.hh
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>       // std::shared_ptr
+#include <mutex>
+#include <type_traits>
+#include <utility>      // std::pair
+#include <vector>
+
+
+namespace unimock
+{
+
+/// VirtualScheduler running tasks at points in simulated time.
+///
+/// Mocks of dependencies that return futures or take completion callbacks
+/// often need to complete them after a latency. Sleeping for real makes the
+/// tests slow and timing dependent. The scheduler instead keeps a virtual
+/// clock that only moves when the test advances it. Tasks are scheduled at the
+/// virtual time now plus a delay, and advancing the clock runs the due tasks in
+/// time order, instantly. Tasks due at the same time run in the order they
+/// were scheduled, so a test runs the same way every time.
+///
+/// The tasks are run by the thread advancing the clock, without holding any
+/// lock, so they may schedule further tasks. Tasks may be scheduled from any
+/// thread.
+///
+/// #### Example ####
+/// ~~~
+/// auto scheduler = std::make_shared<VirtualScheduler>();
+///
+/// StoreMock mock( std::make_shared<StoreStub>() );
+/// mock.setVirtualLatency(
+///    &IStore::fetch, scheduler, std::chrono::milliseconds( 20 ) );
+/// mock.override( &IStore::fetchAsync, [&]( int key, Callback callback )
+/// {
+///    scheduler->schedule(
+///       std::chrono::milliseconds( 20 ), [=]{ callback( key * 2 ); } );
+/// } );
+///
+/// auto value = mock.fetch( 1 );
+/// scheduler->advance( std::chrono::milliseconds( 20 ) );
+/// assert( value.wait_for( std::chrono::seconds( 0 ) ) ==
+///    std::future_status::ready );
+/// ~~~
+///
+class VirtualScheduler
+{
+public:
+
+   /// Constructor.
+   ///
+   /// Constructs a scheduler without tasks at virtual time zero.
+   ///
+   /// \exception Exception neutral.
+   ///
+   VirtualScheduler();
+
+   VirtualScheduler( const VirtualScheduler& ) = delete;
+   VirtualScheduler& operator=( const VirtualScheduler& ) = delete;
+
+   /// Gets the virtual time.
+   ///
+   /// \returns
+   ///   The virtual time since the scheduler was constructed.
+   ///
+   /// \exception Exception neutral.
+   ///
+   std::chrono::nanoseconds now() const;
+
+   /// Schedules a task.
+   ///
+   /// \param[in] delay
+   ///   The virtual time from now until the task is run.
+   ///
+   /// \param[in] task
+   ///   The task to run.
+   ///
+   /// \exception Exception neutral.
+   ///
+   void schedule( std::chrono::nanoseconds delay, std::function<void()> task );
+
+   /// Defers a function to complete a future after a latency.
+   ///
+   /// The function is called when the virtual time has advanced by the
+   /// latency, and its result, or what it throws, becomes the result of the
+   /// future.
+   ///
+   /// \param[in] latency
+   ///   The virtual time from now until the function is called.
+   ///
+   /// \param[in] function
+   ///   The function to call.
+   ///
+   /// \returns
+   ///   The future result of the function.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename F>
+   std::future<std::result_of_t<F()>> deferred(
+      std::chrono::nanoseconds latency,
+      F function );
+
+   /// Defers the result of a future until after a latency.
+   ///
+   /// The result of the future is taken when the virtual time has advanced by
+   /// the latency, or later, once the future is ready. A future that isn't
+   /// ready by then is awaited without blocking the tasks, so it may be
+   /// completed by a task scheduled later, like the future of another mock
+   /// with a virtual latency. It's checked after every task run and at the
+   /// end of an advance, and waited for by run once no tasks remain. A
+   /// deferred future is run when the latency has passed.
+   ///
+   /// \param[in] latency
+   ///   The virtual time from now until the result is available.
+   ///
+   /// \param[in] future
+   ///   The future to take the result from.
+   ///
+   /// \returns
+   ///   A future with the same result, ready after the latency.
+   ///
+   /// \exception Exception neutral.
+   ///
+   template<typename T>
+   std::future<T> deferred(
+      std::chrono::nanoseconds latency,
+      std::future<T> future );
+
+   /// Advances the virtual time.
+   ///
+   /// The tasks due until the new time are run in time order, with the
+   /// virtual time set to the time of each task as it runs.
+   ///
+   /// \param[in] duration
+   ///   The virtual time to advance.
+   ///
+   /// \returns
+   ///   The number of tasks run.
+   ///
+   /// \exception Exception neutral. A task that throws leaves the virtual time
+   ///   at the time of the task.
+   ///
+   std::size_t advance( std::chrono::nanoseconds duration );
+
+   /// Runs all tasks.
+   ///
+   /// The virtual time advances to each task as it runs, including the tasks
+   /// scheduled by the tasks run, until no task remains.
+   ///
+   /// \returns
+   ///   The number of tasks run.
+   ///
+   /// \exception Exception neutral.
+   ///
+   std::size_t run();
+
+   /// Gets the number of tasks scheduled but not yet run.
+   ///
+   /// \returns
+   ///   The number of pending tasks, including the deferred futures awaiting
+   ///   their sources.
+   ///
+   /// \exception Exception neutral.
+   ///
+   std::size_t size() const;
+
+
+private:
+
+   // Tasks ordered by time and then by the order they were scheduled.
+   using Tasks_ = std::map<
+      std::pair<std::chrono::nanoseconds, std::uint64_t>,
+      std::function<void()>>;
+
+   mutable std::mutex mutex_;
+
+   std::chrono::nanoseconds now_;
+
+   std::uint64_t sequence_;
+
+   Tasks_ tasks_;
+
+   // Completes a deferred future if its source is ready, or in any case if
+   // told to wait. Returns true if the future is completed.
+   using Awaiter_ = std::function<bool( bool wait )>;
+
+   // Deferred futures whose latency has passed, awaiting their sources.
+   std::vector<Awaiter_> awaiting_;
+
+   // Runs the next task if it is due at the time given.
+   bool runNext_( const std::chrono::nanoseconds* until );
+
+   template<typename T>
+   static bool complete_(
+      std::future<T>& source,
+      std::promise<T>& target,
+      bool wait );
+
+   template<typename T>
+   static void forward_( std::future<T>& source, std::promise<T>& target );
+
+   static void forward_(
+      std::future<void>& source,
+      std::promise<void>& target );
+
+   void await_( Awaiter_ awaiter );
+
+   // Completes the deferred futures whose sources are ready, or all of them
+   // if told to wait.
+   void completeAwaiting_( bool wait );
+
+};
+
+
+} // namespace
+
+
+// Implementation.
+#include "VirtualScheduler.tcc"
@@ -0,0 +1,224 @@
+/*
+
+   VirtualScheduler.tcc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <cassert>
+#include <exception>    // std::current_exception
+#include <iterator>     // std::make_move_iterator
+#include <memory>       // std::shared_ptr
+#include <utility>      // std::move
+
+
+namespace unimock
+{
+
+inline VirtualScheduler::VirtualScheduler()
+:
+   mutex_(),
+   now_( 0 ),
+   sequence_( 0 ),
+   tasks_(),
+   awaiting_()
+{
+}
+
+inline std::chrono::nanoseconds VirtualScheduler::now() const
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+   return now_;
+}
+
+inline void VirtualScheduler::schedule(
+   std::chrono::nanoseconds delay,
+   std::function<void()> task )
+{
+   assert( delay >= std::chrono::nanoseconds::zero() );
+
+   std::lock_guard<std::mutex> lock( mutex_ );
+   tasks_.emplace(
+      std::make_pair( now_ + delay, sequence_++ ), std::move( task ) );
+}
+
+template<typename F>
+std::future<std::result_of_t<F()>> VirtualScheduler::deferred(
+   std::chrono::nanoseconds latency,
+   F function )
+{
+   // The packaged task is shared since std::function needs a copyable target.
+   auto task = std::make_shared<std::packaged_task<std::result_of_t<F()>()>>(
+      std::move( function ) );
+   auto future = task->get_future();
+   schedule( latency, [task]{ ( *task )(); } );
+
+   return future;
+}
+
+template<typename T>
+std::future<T> VirtualScheduler::deferred(
+   std::chrono::nanoseconds latency,
+   std::future<T> future )
+{
+   auto source = std::make_shared<std::future<T>>( std::move( future ) );
+   auto target = std::make_shared<std::promise<T>>();
+   auto result = target->get_future();
+   schedule( latency, [this, source, target]
+   {
+      await_( [source, target]( bool wait )
+      {
+         return complete_( *source, *target, wait );
+      } );
+   } );
+
+   return result;
+}
+
+inline std::size_t VirtualScheduler::advance(
+   std::chrono::nanoseconds duration )
+{
+   assert( duration >= std::chrono::nanoseconds::zero() );
+
+   const auto until = now() + duration;
+
+   std::size_t count = 0;
+   while( runNext_( &until ) )
+      ++count;
+
+   {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      if( now_ < until )
+         now_ = until;
+   }
+
+   // Sources may also be completed outside the scheduler.
+   completeAwaiting_( false );
+
+   return count;
+}
+
+inline std::size_t VirtualScheduler::run()
+{
+   std::size_t count = 0;
+   while( runNext_( nullptr ) )
+      ++count;
+
+   // No task is left to complete the sources still awaited.
+   completeAwaiting_( true );
+
+   return count;
+}
+
+inline std::size_t VirtualScheduler::size() const
+{
+   std::lock_guard<std::mutex> lock( mutex_ );
+   return tasks_.size() + awaiting_.size();
+}
+
+template<typename T>
+bool VirtualScheduler::complete_(
+   std::future<T>& source,
+   std::promise<T>& target,
+   bool wait )
+{
+   // Deferred sources are run rather than awaited.
+   if( !wait && source.wait_for( std::chrono::seconds( 0 ) ) ==
+      std::future_status::timeout )
+   {
+      return false;
+   }
+
+   try
+   {
+      forward_( source, target );
+   }
+   catch( ... )
+   {
+      target.set_exception( std::current_exception() );
+   }
+
+   return true;
+}
+
+template<typename T>
+void VirtualScheduler::forward_(
+   std::future<T>& source,
+   std::promise<T>& target )
+{
+   target.set_value( source.get() );
+}
+
+inline void VirtualScheduler::forward_(
+   std::future<void>& source,
+   std::promise<void>& target )
+{
+   source.get();
+   target.set_value();
+}
+
+inline void VirtualScheduler::await_( Awaiter_ awaiter )
+{
+   if( awaiter( false ) )
+      return;
+
+   std::lock_guard<std::mutex> lock( mutex_ );
+   awaiting_.push_back( std::move( awaiter ) );
+}
+
+inline void VirtualScheduler::completeAwaiting_( bool wait )
+{
+   std::vector<Awaiter_> awaiting;
+   {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      if( awaiting_.empty() )
+         return;
+
+      awaiting.swap( awaiting_ );
+   }
+
+   std::vector<Awaiter_> remaining;
+   for( auto& awaiter : awaiting )
+   {
+      if( !awaiter( wait ) )
+         remaining.push_back( std::move( awaiter ) );
+   }
+
+   std::lock_guard<std::mutex> lock( mutex_ );
+   remaining.insert(
+      remaining.end(),
+      std::make_move_iterator( awaiting_.begin() ),
+      std::make_move_iterator( awaiting_.end() ) );
+   awaiting_.swap( remaining );
+}
+
+inline bool VirtualScheduler::runNext_( const std::chrono::nanoseconds* until )
+{
+   std::function<void()> task;
+   {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      auto next = tasks_.begin();
+      if( next == tasks_.end() || ( until && next->first.first > *until ) )
+         return false;
+
+      now_ = next->first.first;
+      task = std::move( next->second );
+      tasks_.erase( next );
+   }
+
+   task();
+
+   // The task may have completed the sources of deferred futures.
+   completeAwaiting_( false );
+
+   return true;
+}
+
+
+} // namespace
@@ -0,0 +1,129 @@
+/*
+
+   ArenaConversionPolicyTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>    // std::unique_ptr
+#include <functional>
+#include <type_traits>
+
+#include "Test.hh"
+
+#include "unimock/ArenaConversionPolicy.hh"
+#include "unimock/CallRecorder.hh"
+#include "unimock/ResultSet.hh"
+#include "unimock/FiniteID.hh"
+
+
+namespace
+{
+
+void setName( const std::string& name ) {}
+void setSamples( const std::vector<double>& samples, int i ) {}
+void setFlags( std::vector<bool> flags ) {}
+
+class ISomeClass
+{
+public:
+   virtual ~ISomeClass() {}
+   virtual void setIntStr( int i, const char* s ) = 0;
+};
+
+} // unnamed namespace
+
+
+void testArenaConversionPolicy()
+{
+   using namespace unimock;
+
+   test( "Convert strings and arrays to views into the arena" );
+   {
+      ArenaConversionPolicy policy;
+      int i = 3;
+      std::string s = "one";
+      std::array<short, 3> a = { { 1, 2, 3 } };
+
+      auto view1 = policy.convert( "one" );
+      auto view2 = policy.convert( s );
+      auto view3 = policy.convert( &s );
+      auto view4 = policy.convert( std::vector<int>{ 4, 5 } );
+      auto view5 = policy.convert( a );
+
+      static_assert(
+         std::is_same<decltype( view1 ), StringView>::value,
+         "String literals shall be stored as views" );
+      static_assert(
+         std::is_same<decltype( view4 ), ArrayView<int>>::value,
+         "Vectors shall be stored as views" );
+      static_assert(
+         std::is_same<decltype( policy.convert( &i ) ), int>::value,
+         "Other types shall be copied" );
+      static_assert(
+         std::is_same<
+            decltype( policy.convert( std::vector<bool>() ) ),
+            std::vector<bool>>::value,
+         "Vectors of bool shall be copied" );
+
+      s = "two";
+      ensure( view2 == "one" );
+      ensure( view2.data() != s.data() );
+      ensure( view1 == view2 );
+      ensure( view3 == view2 );
+      ensure( view1 < StringView( "onf" ) );
+      ensure( view1.str() == "one" );
+      ensure( std::hash<StringView>()( view1 ) ==
+         std::hash<StringView>()( std::string( "one" ) ) );
+      ensure( view4 == std::vector<int>( { 4, 5 } ) );
+      ensure( view5.size() == 3 && view5[ 2 ] == 3 );
+      ensure( policy.convert( &i ) == 3 );
+      ensure( policy.convert( std::unique_ptr<int>( new int( 4 ) ) ) == 4 );
+      ensure( policy.convert(
+         std::unique_ptr<std::string>( new std::string( "up" ) ) ) == "up" );
+      ensure( policy.arenaSize() ==
+         3 + 3 + 3 + 2 * sizeof( int ) + 3 * sizeof( short ) + 2 );
+   }
+
+   test( "Keep recorded views valid while the recorder is alive" );
+   {
+      CallRecorder<ArenaConversionPolicy> recorder;
+      FiniteID id = FiniteID::generate();
+
+      for( int i = 0; i < 1000; i++ )
+      {
+         std::string name = "name" + std::to_string( i );
+         recorder.record( setName, name );
+         recorder.record( setSamples, std::vector<double>( 100, i ), i );
+         recorder.record( id, &ISomeClass::setIntStr, i, name.c_str() );
+      }
+
+      auto resultSet = makeResultSet( recorder.find( setName ) );
+      ensure( resultSet.size() == 1000 );
+      ensure( resultSet.get<0, 0>() == "name0" );
+      ensure( resultSet.get<999, 0>() == "name999" );
+
+      auto resultSet2 = makeResultSet( recorder.find( setSamples ) );
+      ensure( resultSet2.get<500, 0>().size() == 100 );
+      ensure( resultSet2.get<500, 0>()[ 99 ] == 500.0 );
+      ensure( resultSet2.get<500, 1>() == 500 );
+
+      auto resultSet3 =
+         makeResultSet( recorder.find( id, &ISomeClass::setIntStr ) );
+      ensure( resultSet3.get<7, 1>() == "name7" );
+      ensure( recorder.arenaSize() > 1000 * 100 * sizeof( double ) );
+
+      recorder.record( setFlags, std::vector<bool>( 2, true ) );
+      auto resultSet4 = makeResultSet( recorder.find( setFlags ) );
+      ensure( resultSet4.get<0, 0>().size() == 2 );
+   }
+}
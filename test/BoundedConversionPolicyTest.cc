@@ -0,0 +1,109 @@
+/*
+
+   BoundedConversionPolicyTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>    // std::unique_ptr
+#include <type_traits>
+
+#include "Test.hh"
+
+#include "unimock/DigestConversionPolicy.hh"
+#include "unimock/PrefixConversionPolicy.hh"
+#include "unimock/SizeConversionPolicy.hh"
+#include "unimock/CallRecorder.hh"
+#include "unimock/ResultSet.hh"
+
+
+namespace
+{
+
+void write( int fd, const std::vector<char>& buffer, int flags ) {}
+void setName( const char* name ) {}
+void setValues( const std::list<int>* values ) {}
+
+} // unnamed namespace
+
+
+void testBoundedConversionPolicy()
+{
+   using namespace unimock;
+
+   test( "Capture digests of large arguments" );
+   {
+      CallRecorder<DigestConversionPolicy> recorder;
+      std::vector<char> buffer1( 1000000, 'a' );
+      std::vector<char> buffer2( buffer1 );
+      buffer2[ 999999 ] = 'b';
+
+      recorder.record( write, 3, buffer1, 0 );
+      recorder.record( write, 3, buffer2, 1 );
+      recorder.record( setName, "name" );
+
+      auto resultSet = makeResultSet( recorder.find( write ) );
+      static_assert(
+         std::is_same<
+            decltype( resultSet.get<0, 1>() ), const Digest&>::value,
+         "Buffers shall be stored as digests" );
+      ensure( resultSet.get<0, 0>() == 3 );
+      ensure( resultSet.get<0, 1>() == makeDigest( buffer1 ) );
+      ensure( resultSet.get<1, 1>() == makeDigest( buffer2 ) );
+      ensure( resultSet.get<0, 1>() != resultSet.get<1, 1>() );
+      ensure( resultSet.get<0, 1>().size == 1000000 );
+      auto resultSet2 = makeResultSet( recorder.find( setName ) );
+      ensure( resultSet2.get<0, 0>() == makeDigest( std::string( "name" ) ) );
+      ensure( resultSet2.get<0, 0>() == makeDigest( "name" ) );
+   }
+
+   test( "Capture prefixes of large arguments" );
+   {
+      CallRecorder<PrefixConversionPolicy<4>> recorder;
+      std::vector<char> buffer( { 'G', 'I', 'F', '8', '9', 'a' } );
+
+      recorder.record( write, 3, buffer, 0 );
+      recorder.record( setName, "ab" );
+
+      auto resultSet = makeResultSet( recorder.find( write ) );
+      auto& prefix = resultSet.get<0, 1>();
+      ensure( prefix.size == 6 );
+      ensure( prefix.length == 4 );
+      ensure( prefix.bytes[ 3 ] == '8' );
+      ensure( prefix == makePrefix<4>( std::string( "GIF89a" ) ) );
+      ensure( prefix != makePrefix<4>( std::string( "GIE89a" ) ) );
+      auto resultSet2 = makeResultSet( recorder.find( setName ) );
+      ensure( resultSet2.get<0, 0>().length == 2 );
+      ensure( resultSet2.get<0, 0>() == makePrefix<4>( "ab" ) );
+   }
+
+   test( "Capture sizes of large arguments" );
+   {
+      CallRecorder<SizeConversionPolicy> recorder;
+      std::vector<char> buffer( 4096 );
+      std::list<int> values( { 1, 2, 3 } );
+      const std::unique_ptr<int> ip( new int( 5 ) );
+
+      recorder.record( write, 3, buffer, 0 );
+      recorder.record( setName, "name" );
+      recorder.record( setValues, &values );
+
+      ensure( SizeConversionPolicy::convert( ip ) == 5 );
+      auto resultSet = makeResultSet( recorder.find( write ) );
+      ensure( resultSet.get<0, 1>() == 4096 );
+      ensure( resultSet.get<0, 2>() == 0 );
+      auto resultSet2 = makeResultSet( recorder.find( setName ) );
+      ensure( resultSet2.get<0, 0>() == 4 );
+      auto resultSet3 = makeResultSet( recorder.find( setValues ) );
+      ensure( resultSet3.get<0, 0>() == 3 );
+   }
+}
@@ -12,12 +12,20 @@ ________________________________________________________________________________
 */
 
 #include <memory>    // std::unique_ptr, std::shared_ptr
+#include <cmath>     // std::abs
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <stdexcept>
 
 #include "Test.hh"
 
 #include "unimock/CallRecorder.hh"
 #include "unimock/ResultSet.hh"
 #include "unimock/FiniteID.hh"
+#include "unimock/ExpectationViolation.hh"
 
 
 namespace
@@ -43,6 +51,28 @@ public:
    virtual void setSPtr( std::shared_ptr<int> sip ) = 0;
 };
 
+// An argument type that counts how many times it's constructed from an int.
+class Counted
+{
+public:
+   Counted( int value ) : value_( value ) { constructed++; }
+   static int constructed;
+private:
+   int value_;
+};
+
+int Counted::constructed = 0;
+
+void setIntCounted( int i, Counted c ) {}
+
+void setIntCStr( int i, const char* s ) {}
+
+class IntegerClass
+{
+public:
+   void setOffset( int offset, char c, std::uint64_t u ) {}
+};
+
 class SomeClass : public ISomeClass
 {
 public:
@@ -251,5 +281,555 @@ void testCallRecorder()
       ensure( resultSet.get<0, std::string>() == "three" );
    }
 
-}
+   test( "Find recorded calls in parallel" );
+   {
+      CallRecorder<> recorder;
+      FiniteID id1 = FiniteID::generate();
+      FiniteID id2 = FiniteID::generate();
+
+      for( int i = 0; i < 100000; i++ )
+      {
+         recorder.record( id1, &ISomeClass::setIntStr, i, "one" );
+         recorder.record( id2, &ISomeClass::setIntStr, -i, "two" );
+         recorder.record( static_cast<void(*)(int)>( setVal ), i );
+      }
+
+      recorder.setThreadPool( std::make_shared<ThreadPool>( 4 ) );
+
+      auto resultSet =
+         makeResultSet( recorder.find( id2, &ISomeClass::setIntStr ) );
+      ensure( resultSet.size() == 100000 );
+      for( std::size_t row = 0; row < resultSet.size(); row++ )
+         ensure( resultSet.get<0>( row ) == -static_cast<int>( row ) );
+      auto resultSet2 =
+         makeResultSet( recorder.find( &ISomeClass::setIntStr ) );
+      ensure( resultSet2.size() == 200000 );
+      ensure( resultSet2.get<0>( 199998 ) == 99999 );
+   }
+
+   test( "Track distinct arguments and quantiles per method" );
+   {
+      CallRecorder<> recorder;
+      SomeClass someObject;
+      FiniteID id1 = FiniteID::generate();
+      FiniteID id2 = FiniteID::generate();
+
+      auto distinct = recorder.trackDistinct<1>( &ISomeClass::setIntStr );
+      auto quantiles = recorder.trackQuantiles<0>( &ISomeClass::setIntStr );
+      auto constDistinct =
+         recorder.trackDistinct<0>( &ISomeClass::setIntStrConst );
+      auto functionQuantiles =
+         recorder.trackQuantiles<0>( static_cast<void(*)(double)>( setVal ) );
+
+      for( int i = 1; i <= 1000; i++ )
+      {
+         recorder.record( id1, &ISomeClass::setIntStr, i, "one" );
+         recorder.record( id2, &ISomeClass::setIntStr, i, "two" );
+      }
+      recorder.record( id1, &ISomeClass::setIntStrConst, 1, "three" );
+      recorder.record( static_cast<void(*)(int)>( setVal ), 3 );
+      recorder.record( static_cast<void(*)(double)>( setVal ), 2.5 );
+
+      ensure( std::abs( distinct->estimate() - 2.0 ) < 0.5 );
+      ensure( quantiles->size() == 2000 );
+      ensure( quantiles->min() == 1.0 );
+      ensure( quantiles->max() == 1000.0 );
+      ensure( std::abs( quantiles->quantile( 0.5 ) - 500.0 ) < 20.0 );
+      ensure( std::abs( constDistinct->estimate() - 1.0 ) < 0.5 );
+      ensure( functionQuantiles->size() == 1 );
+      ensure( functionQuantiles->quantile( 0.5 ) == 2.5 );
+      ensure( recorder.find( &ISomeClass::setIntStr ).size() == 2000 );
+   }
+
+   test( "Count calls and fold them into aggregates only" );
+   {
+      CallRecorder<> recorder;
+      FiniteID id1 = FiniteID::generate();
+      FiniteID id2 = FiniteID::generate();
+
+      auto aggregates = recorder.trackAggregates<0>( &ISomeClass::setIntStr );
+      auto functionAggregates =
+         recorder.trackAggregates<0>( static_cast<void(*)(double)>( setVal ) );
+
+      recorder.record( id1, &ISomeClass::setIntStr, 5, "one" );
+      recorder.setAggregateOnly( true );
+      for( int i = 1; i <= 1000; i++ )
+      {
+         recorder.record( id1, &ISomeClass::setIntStr, i, "one" );
+         recorder.record( id2, &ISomeClass::setIntStr, -i, "two" );
+         recorder.record( id1, &ISomeClass::setIntStrConst, i, "three" );
+      }
+      recorder.record( static_cast<void(*)(double)>( setVal ), 2.5 );
+      recorder.setAggregateOnly( false );
+      recorder.record( static_cast<void(*)(double)>( setVal ), 0.5 );
+
+      ensure( aggregates->count() == 2001 );
+      ensure( aggregates->min() == -1000 );
+      ensure( aggregates->max() == 1000 );
+      ensure( aggregates->sum() == 5 );
+      ensure( functionAggregates->count() == 2 );
+      ensure( functionAggregates->sum() == 3.0 );
+      ensure( recorder.count( &ISomeClass::setIntStr ) == 2001 );
+      ensure( recorder.count( &ISomeClass::setIntStrConst ) == 1000 );
+      ensure( recorder.count( static_cast<void(*)(double)>( setVal ) ) == 2 );
+      ensure( recorder.count( static_cast<void(*)(int)>( setVal ) ) == 0 );
+      ensure( recorder.find( &ISomeClass::setIntStr ).size() == 1 );
+      ensure( recorder.find( &ISomeClass::setIntStrConst ).empty() );
+   }
+
+   test( "Compress the call history of integer calls" );
+   {
+      CallRecorder<> recorder;
+      FiniteID id1 = FiniteID::generate();
+      FiniteID id2 = FiniteID::generate();
+      FiniteID id3 = FiniteID::generate();
+
+      recorder.compressHistory( &IntegerClass::setOffset );
+      recorder.compressHistory( static_cast<void(*)(int)>( setVal ) );
+
+      const std::uint64_t large = 0xfedcba9876543210;
+      for( int i = 0; i < 10000; i++ )
+      {
+         recorder.record( id1, &IntegerClass::setOffset, i * 512, 'a', large );
+         recorder.record( id2, &IntegerClass::setOffset, -i, 'b', i % 3 );
+         recorder.record( static_cast<void(*)(int)>( setVal ), 7 );
+         recorder.record( id1, &ISomeClass::setDouble, i );
+      }
+
+      auto resultSet1 =
+         makeResultSet( recorder.find( id1, &IntegerClass::setOffset ) );
+      ensure( resultSet1.size() == 10000 );
+      ensure( resultSet1.get<0>( 9999 ) == 9999 * 512 );
+      ensure( resultSet1.get<1>( 5000 ) == 'a' );
+      ensure( resultSet1.get<2>( 1234 ) == large );
+      auto resultSet2 =
+         makeResultSet( recorder.find( id2, &IntegerClass::setOffset ) );
+      ensure( resultSet2.size() == 10000 );
+      ensure( resultSet2.get<0>( 4097 ) == -4097 );
+      ensure( resultSet2.get<2>( 4097 ) == 4097 % 3 );
+      auto resultSet3 =
+         makeResultSet( recorder.find( &IntegerClass::setOffset ) );
+      ensure( resultSet3.size() == 20000 );
+      ensure( resultSet3.get<1>( 19999 ) == 'b' );
+      ensure( recorder.find( id3, &IntegerClass::setOffset ).empty() );
+      ensure( recorder.find( static_cast<void(*)(int)>( setVal ) ).size() ==
+         10000 );
+      ensure( recorder.count( &IntegerClass::setOffset ) == 20000 );
+      ensure( recorder.find( id1, &ISomeClass::setDouble ).size() == 10000 );
+   }
+
+   test( "Select the calls to record" );
+   {
+      CallRecorder<> recorder;
+      FiniteID id = FiniteID::generate();
+
+      recorder.setRecorded( &ISomeClass::setDouble, false );
+      recorder.setFilter(
+         &ISomeClass::setIntStr,
+         []( int i, const std::string& s ){ return i % 2 == 0 && s != "no"; } );
+      recorder.setFilter(
+         static_cast<void(*)(int)>( setVal ), []( int i ){ return i > 1; } );
+
+      for( int i = 0; i < 4; i++ )
+      {
+         recorder.record( id, &ISomeClass::setIntStr, i, "yes" );
+         recorder.record( id, &ISomeClass::setIntStr, i, "no" );
+         recorder.record( id, &ISomeClass::setDouble, 1.0 );
+         recorder.record( static_cast<void(*)(int)>( setVal ), i );
+         recorder.record( id, &ISomeClass::setAnotherDouble, 2.0 );
+      }
+
+      auto resultSet =
+         makeResultSet( recorder.find( &ISomeClass::setIntStr ) );
+      ensure( resultSet.size() == 2 );
+      ensure( resultSet.get<0>( 1 ) == 2 );
+      ensure( recorder.find( &ISomeClass::setDouble ).empty() );
+      ensure(
+         recorder.find( static_cast<void(*)(int)>( setVal ) ).size() == 2 );
+      ensure( recorder.find( &ISomeClass::setAnotherDouble ).size() == 4 );
+
+      recorder.setRecordedByDefault( false );
+      recorder.setRecorded( &ISomeClass::setDouble, true );
+      recorder.record( id, &ISomeClass::setDouble, 1.0 );
+      recorder.record( id, &ISomeClass::setAnotherDouble, 2.0 );
+      recorder.record( static_cast<void(*)(int)>( setVal ), 3 );
+
+      ensure( recorder.find( &ISomeClass::setDouble ).size() == 1 );
+      ensure( recorder.find( &ISomeClass::setAnotherDouble ).size() == 4 );
+      ensure(
+         recorder.find( static_cast<void(*)(int)>( setVal ) ).size() == 2 );
+   }
+
+   test( "Keep only the projected arguments of a call" );
+   {
+      CallRecorder<> recorder;
+      FiniteID id1 = FiniteID::generate();
+      FiniteID id2 = FiniteID::generate();
+      const auto value = std::make_unique<int>( 5 );
+
+      recorder.record( id1, &ISomeClass::setIntStr, 1, "one" );
+      recorder.project<1>( &ISomeClass::setIntStr );
+      recorder.project<0>( &ISomeClass::setIntStrConst );
+      recorder.project<0, 0>( &ISomeClass::setConstRefUPtr );
+      recorder.project<1, 0>( setIntStr );
+      auto distinct = recorder.trackDistinct<0>( &ISomeClass::setIntStr );
+
+      recorder.record( id1, &ISomeClass::setIntStr, 2, "two" );
+      recorder.record( id2, &ISomeClass::setIntStr, 3, std::string( "three" ) );
+      recorder.record( id1, &ISomeClass::setIntStrConst, 4, "four" );
+      recorder.record( id2, &ISomeClass::setConstRefUPtr, value );
+      recorder.record( setIntStr, 6, "six" );
+
+      auto resultSet = makeResultSet( recorder.find( &ISomeClass::setIntStr ) );
+      ensure( resultSet.size() == 1 );
+      ensure( resultSet.get<0, 0>() == 1 );
+      auto resultSet2 =
+         makeResultSet( recorder.find<1>( &ISomeClass::setIntStr ) );
+      ensure( resultSet2.size() == 2 );
+      ensure( resultSet2.get<0>( 0 ) == "two" );
+      ensure( resultSet2.get<0>( 1 ) == "three" );
+      auto resultSet3 =
+         makeResultSet( recorder.find<1>( id2, &ISomeClass::setIntStr ) );
+      ensure( resultSet3.size() == 1 );
+      ensure( resultSet3.get<0, 0>() == "three" );
+      auto resultSet4 =
+         makeResultSet( recorder.find<0>( &ISomeClass::setIntStrConst ) );
+      ensure( resultSet4.get<0, 0>() == 4 );
+      auto resultSet5 =
+         makeResultSet( recorder.find<0, 0>( &ISomeClass::setConstRefUPtr ) );
+      ensure( resultSet5.get<0, 0>() == 5 );
+      ensure( resultSet5.get<0, 1>() == 5 );
+      auto resultSet6 = makeResultSet( recorder.find<1, 0>( setIntStr ) );
+      ensure( resultSet6.get<0, 0>() == "six" );
+      ensure( resultSet6.get<0, 1>() == 6 );
+      ensure( recorder.find<0>( &ISomeClass::setIntStr ).empty() );
+      ensure( recorder.count( &ISomeClass::setIntStr ) == 3 );
+      ensure( std::abs( distinct->estimate() - 2.0 ) < 0.5 );
+   }
+
+   test( "Convert only the projected arguments of a call" );
+   {
+      CallRecorder<> recorder;
+
+      recorder.project<0>( setIntCounted );
+      Counted::constructed = 0;
+      recorder.record( setIntCounted, 1, 2 );
+      recorder.record( setIntCounted, 3, 4 );
+
+      ensure( Counted::constructed == 0 );
+      ensure( recorder.find<0>( setIntCounted ).size() == 2 );
+      ensure( recorder.find( setIntCounted ).empty() );
+      ensure( recorder.count( setIntCounted ) == 2 );
+   }
+
+   test( "Project literal arguments to pointer parameters" );
+   {
+      CallRecorder<> recorder;
+
+      recorder.project<1>( setIntCStr );
+      recorder.record( setIntCStr, 3, "three" );
+      const char* four = "four";
+      recorder.record( setIntCStr, 4, four );
+
+      auto resultSet = makeResultSet( recorder.find<1>( setIntCStr ) );
+      ensure( resultSet.size() == 2 );
+      ensure( resultSet.get<0>( 0 ) == "three" );
+      ensure( resultSet.get<0>( 1 ) == "four" );
+   }
+
+
+   test( "Record calls asynchronously from several threads" );
+   {
+      CallRecorder<> recorder;
+      FiniteID id = FiniteID::generate();
+      recorder.setAsynchronous( true );
+
+      std::vector<std::thread> threads;
+      for( int thread = 0; thread < 4; thread++ )
+      {
+         threads.emplace_back( [&recorder, &id, thread]()
+         {
+            for( int i = 0; i < 10000; i++ )
+               recorder.record( id, &ISomeClass::setIntStr, thread, "" );
+         } );
+      }
+
+      for( auto& thread : threads )
+         thread.join();
+
+      recorder.record( setIntStr, 1, "one" );
+      ensure( recorder.count( setIntStr ) == 1 );
+
+      auto resultSet = makeResultSet( recorder.find( &ISomeClass::setIntStr ) );
+      ensure( resultSet.size() == 40000 );
+      std::size_t counts[ 4 ] = { 0, 0, 0, 0 };
+      for( std::size_t row = 0; row < resultSet.size(); row++ )
+         counts[ resultSet.get<0>( row ) ]++;
+      ensure( counts[ 0 ] == 10000 && counts[ 3 ] == 10000 );
+
+      recorder.record( setIntStr, 2, "two" );
+      recorder.setAsynchronous( false );
+      recorder.record( setIntStr, 3, "three" );
+      auto resultSet2 = makeResultSet( recorder.find( setIntStr ) );
+      ensure( resultSet2.size() == 3 );
+      ensure( resultSet2.get<1>( 1 ) == "two" );
+      ensure( resultSet2.get<1>( 2 ) == "three" );
+   }
 
+   test( "Record calls with hooks from several threads in either mode" );
+   {
+      for( bool asynchronous : { false, true } )
+      {
+         CallRecorder<> recorder;
+         FiniteID id = FiniteID::generate();
+         auto aggregates =
+            recorder.trackAggregates<0>( &ISomeClass::setDouble );
+         recorder.setAsynchronous( asynchronous );
+
+         std::vector<std::thread> threads;
+         for( int thread = 0; thread < 4; thread++ )
+         {
+            threads.emplace_back( [&recorder, &id]()
+            {
+               for( int i = 0; i < 1000; i++ )
+               {
+                  recorder.record( id, &ISomeClass::setDouble, 1.0 );
+                  recorder.record( setIntStr, i, "" );
+               }
+            } );
+         }
+
+         for( auto& thread : threads )
+            thread.join();
+
+         ensure( recorder.count( &ISomeClass::setDouble ) == 4000 );
+         ensure( recorder.count( setIntStr ) == 4000 );
+         ensure( aggregates->count() == 4000 );
+      }
+   }
+
+   test( "Observe recorded calls inline and queued" );
+   {
+      CallRecorder<> recorder;
+      FiniteID id = FiniteID::generate();
+      int sum = 0;
+      std::string last;
+      std::atomic<int> queuedSum( 0 );
+      std::size_t allCount = 0;
+      std::atomic<int> queuedAllCount( 0 );
+
+      recorder.observe( &ISomeClass::setIntStr, [&]( int i, std::string s )
+      {
+         sum += i;
+         last = s;
+      } );
+      recorder.observe(
+         &ISomeClass::setIntStr,
+         [&]( int i, const std::string& s ) { queuedSum += i; },
+         ObserverDelivery::QUEUED );
+      recorder.observe( &ISomeClass::setDouble, []( double d )
+      {
+         if( d < 0.0 )
+            throw std::runtime_error( "Negative" );
+      } );
+      recorder.observeAllWithoutArguments(
+         [&]( const std::type_index& typeIndex, const FiniteID& objectID )
+         {
+            allCount++;
+         } );
+      recorder.observeAllWithoutArguments(
+         [&]( const std::type_index& typeIndex, const FiniteID& objectID )
+         {
+            queuedAllCount++;
+         },
+         ObserverDelivery::QUEUED );
+      recorder.setFilter(
+         &ISomeClass::setIntStr,
+         []( int i, const std::string& s ) { return i != 100; } );
+
+      recorder.record( id, &ISomeClass::setIntStr, 1, "one" );
+      recorder.record( id, &ISomeClass::setIntStr, 2, "two" );
+      recorder.record( id, &ISomeClass::setIntStr, 100, "hundred" );
+      recorder.record( setIntStr, 3, "three" );
+      recorder.record( id, &ISomeClass::setDouble, 4.0 );
+
+      bool aborted = false;
+      try
+      {
+         recorder.record( id, &ISomeClass::setDouble, -1.0 );
+      }
+      catch( const std::runtime_error& )
+      {
+         aborted = true;
+      }
+
+      ensure( sum == 3 );
+      ensure( last == "two" );
+      ensure( aborted );
+      ensure( recorder.count( &ISomeClass::setDouble ) == 2 );
+      ensure( allCount == 5 );
+
+      recorder.flushObservers();
+      ensure( queuedSum == 3 );
+      ensure( queuedAllCount == 5 );
+   }
+
+   test( "Report the exceptions thrown by queued observers" );
+   {
+      CallRecorder<> recorder;
+      FiniteID id = FiniteID::generate();
+      std::atomic<int> delivered( 0 );
+
+      recorder.observe(
+         &ISomeClass::setDouble,
+         [&]( double d )
+         {
+            if( d < 0.0 )
+               throw std::runtime_error( "Negative" );
+
+            delivered++;
+         },
+         ObserverDelivery::QUEUED );
+
+      recorder.record( id, &ISomeClass::setDouble, -1.0 );
+      recorder.record( id, &ISomeClass::setDouble, 1.0 );
+
+      bool rethrown = false;
+      try
+      {
+         recorder.flushObservers();
+      }
+      catch( const std::runtime_error& )
+      {
+         rethrown = true;
+      }
+
+      ensure( rethrown );
+      ensure( delivered == 1 );
+      recorder.flushObservers();
+
+      std::atomic<int> errors( 0 );
+      recorder.setObserverErrorHandler( [&]( std::exception_ptr )
+      {
+         errors++;
+      } );
+      recorder.record( id, &ISomeClass::setDouble, -2.0 );
+      recorder.record( id, &ISomeClass::setDouble, -3.0 );
+      recorder.flushObservers();
+      ensure( errors == 2 );
+      ensure( recorder.count( &ISomeClass::setDouble ) == 4 );
+   }
+
+   test( "Deliver to queued observers recording calls themselves" );
+   {
+      CallRecorder<> recorder;
+      FiniteID id = FiniteID::generate();
+      std::atomic<int> delivered( 0 );
+
+      // The observer fills the ring of the background thread, which is the
+      // only thread emptying it.
+      recorder.observe(
+         &ISomeClass::setDouble,
+         [&]( double d )
+         {
+            for( int i = 0; i < 5000; i++ )
+               recorder.record( id, &ISomeClass::setIntStr, i, "" );
+         },
+         ObserverDelivery::QUEUED );
+      recorder.observe(
+         &ISomeClass::setIntStr,
+         [&]( int i, const std::string& s ) { delivered++; },
+         ObserverDelivery::QUEUED );
+
+      recorder.record( id, &ISomeClass::setDouble, 1.0 );
+      recorder.flushObservers();
+      recorder.flushObservers();
+
+      ensure( delivered == 5000 );
+      ensure( recorder.count( &ISomeClass::setIntStr ) == 5000 );
+   }
+
+   test( "Find calls by interned keys among many objects" );
+   {
+      CallRecorder<> recorder;
+      std::vector<FiniteID> ids;
+      for( int i = 0; i < 100; i++ )
+         ids.push_back( FiniteID::generate() );
+
+      for( int i = 0; i < 1000; i++ )
+      {
+         recorder.record( ids[ i % 100 ], &ISomeClass::setIntStr, i, "" );
+         recorder.record( ids[ i % 100 ], &ISomeClass::setIntStrConst, i, "" );
+      }
+
+      ensure( recorder.find( &ISomeClass::setIntStr ).size() == 1000 );
+      auto resultSet =
+         makeResultSet( recorder.find( ids[ 7 ], &ISomeClass::setIntStr ) );
+      ensure( resultSet.size() == 10 );
+      ensure( resultSet.get<0>( 9 ) == 907 );
+      ensure( recorder.find( FiniteID(), &ISomeClass::setIntStrConst ).size() ==
+         1000 );
+      ensure( recorder.count( &ISomeClass::setIntStrConst ) == 1000 );
+      ensure( std::hash<FiniteID>()( ids[ 0 ] ) !=
+         std::hash<FiniteID>()( ids[ 1 ] ) );
+   }
+
+   test( "Check expectations as calls are recorded" );
+   {
+      CallRecorder<> recorder;
+      FiniteID id = FiniteID::generate();
+      std::vector<std::string> violations;
+
+      recorder.expectCalls( setIntStr, 2 );
+      recorder.expectCalls( &ISomeClass::setDouble, 1 );
+      recorder.expectOrder( &ISomeClass::setIntStrConst, &ISomeClass::setUPtr );
+      recorder.expectAtMostBetween(
+         &ISomeClass::setAnotherDouble, 2, &ISomeClass::setIntStr );
+      recorder.expectNever(
+         &ISomeClass::setIntStr,
+         []( int i, const std::string& s ) { return i < 0; } );
+      recorder.setViolationHandler( [&]( const std::string& violation )
+      {
+         violations.push_back( violation );
+      } );
+      recorder.setAggregateOnly( true );
+
+      recorder.record( setIntStr, 1, "one" );
+      recorder.record( id, &ISomeClass::setAnotherDouble, 1.0 );
+      recorder.record( id, &ISomeClass::setAnotherDouble, 2.0 );
+      recorder.record( id, &ISomeClass::setIntStr, 3, "three" );
+      recorder.record( id, &ISomeClass::setAnotherDouble, 3.0 );
+      recorder.record( id, &ISomeClass::setAnotherDouble, 4.0 );
+      recorder.record( id, &ISomeClass::setIntStrConst, 5, "five" );
+      recorder.record(
+         id, &ISomeClass::setUPtr, std::unique_ptr<int>( new int( 6 ) ) );
+      ensure( violations.empty() );
+      ensure( recorder.find( setIntStr ).empty() );
+
+      recorder.record( id, &ISomeClass::setAnotherDouble, 5.0 );
+      ensure( violations.size() == 1 );
+      ensure( violations[ 0 ] ==
+         "Expectation 3 violated: more than 2 calls between markers" );
+      recorder.record( id, &ISomeClass::setIntStr, -1, "minus one" );
+      ensure( violations.size() == 2 );
+
+      recorder.verifyExpectations();
+      ensure( violations.size() == 4 );
+      ensure( violations[ 2 ] ==
+         "Expectation 0 violated: 1 calls where 2 were expected" );
+
+      CallRecorder<> recorder2;
+      recorder2.expectOrder( setIntStr, &ISomeClass::setIntStr );
+      bool thrown = false;
+      try
+      {
+         recorder2.record( id, &ISomeClass::setIntStr, 1, "one" );
+      }
+      catch( const ExpectationViolation& )
+      {
+         thrown = true;
+      }
+      ensure( thrown );
+      ensure( recorder2.find( &ISomeClass::setIntStr ).size() == 1 );
+   }
+}
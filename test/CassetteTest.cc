@@ -0,0 +1,133 @@
+/*
+
+   CassetteTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <cstdio>       // std::remove
+#include <memory>       // std::shared_ptr, std::unique_ptr
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+
+#include "Test.hh"
+
+#include "unimock/Mock.hh"
+#include "unimock/Cassette.hh"
+
+
+namespace
+{
+
+class IStore
+{
+public:
+   virtual ~IStore() {}
+   virtual int get( int key ) const = 0;
+   virtual std::string name( const std::string& prefix, int id ) = 0;
+   virtual void fill( int key, std::vector<int>& values ) = 0;
+   virtual std::unique_ptr<int> make() = 0;
+};
+
+class StoreMock : public unimock::Mock<IStore>
+{
+public:
+   using unimock::Mock<IStore>::Mock;
+
+   int get( int key ) const override { return call( &IStore::get, key ); }
+   std::string name( const std::string& prefix, int id ) override
+      { return call( &IStore::name, prefix, id ); }
+   void fill( int key, std::vector<int>& values ) override
+      { call( &IStore::fill, key, values ); }
+   std::unique_ptr<int> make() override { return call( &IStore::make ); }
+};
+
+class SlowStore : public IStore
+{
+public:
+   SlowStore() : callCount( 0 ) {}
+   int get( int key ) const override { ++callCount; return key * 10; }
+   std::string name( const std::string& prefix, int id ) override
+      { ++callCount; return prefix + std::to_string( id ); }
+   void fill( int key, std::vector<int>& values ) override
+      { ++callCount; values.assign( key, key ); }
+   std::unique_ptr<int> make() override
+      { ++callCount; return std::unique_ptr<int>( new int( 5 ) ); }
+   mutable int callCount;
+};
+
+const char* const CASSETTE_PATH = "CassetteTest.cassette";
+
+} // unnamed namespace
+
+
+void testCassette()
+{
+   using namespace unimock;
+
+   test( "Record stub responses on a cassette and replay them" );
+   {
+      auto store = std::make_shared<SlowStore>();
+      {
+         StoreMock mock( store );
+         mock.setCassette( std::make_shared<Cassette>(
+            CASSETTE_PATH, Cassette::Mode::RECORD ) );
+
+         std::vector<int> values;
+         ensure( mock.get( 1 ) == 10 );
+         ensure( mock.get( 2 ) == 20 );
+         ensure( mock.name( "id", 7 ) == "id7" );
+         mock.fill( 3, values );
+         ensure( values == std::vector<int>( { 3, 3, 3 } ) );
+         ensure( *mock.make() == 5 );
+         ensure( store->callCount == 5 );
+      }
+
+      auto cassette =
+         std::make_shared<Cassette>( CASSETTE_PATH, Cassette::Mode::REPLAY );
+      StoreMock mock;
+      mock.setCassette( cassette );
+
+      std::vector<int> values;
+      ensure( cassette->size() == 4 );
+      ensure( mock.get( 2 ) == 20 );
+      ensure( mock.get( 1 ) == 10 );
+      ensure( mock.get( 3 ) == 0 );
+      ensure( mock.name( "id", 7 ) == "id7" );
+      ensure( mock.name( "id", 8 ).empty() );
+      mock.fill( 3, values );
+      ensure( values == std::vector<int>( { 3, 3, 3 } ) );
+      ensure( !mock.make() );
+      ensure( mock.find( &IStore::get ).size() == 3 );
+   }
+
+   test( "Refuse to replay a file that isn't a cassette" );
+   {
+      {
+         std::ofstream file( CASSETTE_PATH );
+         file << "Not a cassette";
+      }
+
+      bool thrown = false;
+      try
+      {
+         Cassette cassette( CASSETTE_PATH, Cassette::Mode::REPLAY );
+      }
+      catch( const std::runtime_error& )
+      {
+         thrown = true;
+      }
+
+      ensure( thrown );
+      std::remove( CASSETTE_PATH );
+   }
+
+}
@@ -0,0 +1,137 @@
+/*
+
+   CostModelTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Test.hh"
+
+#include "unimock/CostModel.hh"
+
+
+namespace
+{
+
+class IRefrigerator
+{
+public:
+   virtual ~IRefrigerator() {}
+   virtual void open() = 0;
+   virtual int getTemperature() const = 0;
+};
+
+} // unnamed namespace
+
+
+void testCostModel()
+{
+   using namespace unimock;
+   using std::chrono::milliseconds;
+
+   test( "Charge the costs of calls made by one thread" );
+   {
+      CostModel model;
+      model.setCost(
+         &IRefrigerator::open, CostModel::fixed( milliseconds( 5 ) ) );
+      int draws = 0;
+      model.setCost( &IRefrigerator::getTemperature, [&]
+      {
+         return milliseconds( ++draws );
+      } );
+
+      model.charge( &IRefrigerator::open );
+      model.charge( &IRefrigerator::getTemperature );
+      model.charge( &IRefrigerator::getTemperature );
+      model.charge( CostModel::fixed( milliseconds( 10 ) ) );
+
+      auto report = model.getReport();
+      ensure( report.calls == 4 );
+      ensure( report.threads == 1 );
+      ensure( report.serialLatency == milliseconds( 18 ) );
+      ensure( report.criticalPath == milliseconds( 18 ) );
+
+      model.setCost( &IRefrigerator::open, CostModel::Cost() );
+      model.charge( &IRefrigerator::open );
+      ensure( model.getReport().calls == 4 );
+
+      model.reset();
+      ensure( model.getReport().calls == 0 );
+      ensure( model.getReport().serialLatency == milliseconds( 0 ) );
+   }
+
+   test( "Find the critical path of calls made by several threads" );
+   {
+      CostModel model;
+      model.setCost(
+         &IRefrigerator::open, CostModel::fixed( milliseconds( 5 ) ) );
+
+      // The first call of each thread is in progress until both are made.
+      std::mutex mutex;
+      std::condition_variable made;
+      int calls = 0;
+      auto overlap = [&]
+      {
+         CostModel::Charge charge( &model, &IRefrigerator::open );
+         std::unique_lock<std::mutex> lock( mutex );
+         ++calls;
+         made.notify_all();
+         made.wait( lock, [&]{ return calls == 2; } );
+      };
+
+      std::thread first( [&]
+      {
+         overlap();
+         model.charge( &IRefrigerator::open );
+      } );
+      std::thread second( overlap );
+      first.join();
+      second.join();
+      model.charge( &IRefrigerator::open );
+
+      auto report = model.getReport();
+      ensure( report.calls == 4 );
+      ensure( report.threads == 3 );
+      ensure( report.serialLatency == milliseconds( 20 ) );
+      ensure( report.criticalPath == milliseconds( 15 ) );
+
+      // Threads run one after another follow each other, whatever their ids.
+      model.reset();
+      for( int i = 0; i < 3; ++i )
+      {
+         std::thread( [&]{ model.charge( &IRefrigerator::open ); } ).join();
+      }
+      ensure( model.getReport().criticalPath == milliseconds( 15 ) );
+   }
+
+   test( "Charge calls in progress until they return" );
+   {
+      CostModel model;
+      model.setCost(
+         &IRefrigerator::open, CostModel::fixed( milliseconds( 5 ) ) );
+
+      CostModel::Charge outer( &model, &IRefrigerator::open );
+      {
+         CostModel::Charge inner( &model, &IRefrigerator::open );
+         CostModel::Charge none( nullptr, &IRefrigerator::open );
+         CostModel::Charge free( &model, &IRefrigerator::getTemperature );
+      }
+      ensure( model.getReport().calls == 2 );
+      ensure( model.getReport().criticalPath == milliseconds( 10 ) );
+
+      model.reset();
+      ensure( model.getReport().calls == 0 );
+   }
+
+}
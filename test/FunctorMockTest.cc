@@ -12,10 +12,17 @@ ________________________________________________________________________________
 */
 
 #include <functional>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <vector>
 
 #include "Test.hh"
 
 #include "unimock/FunctorMock.hh"
+#include "unimock/CapacityExceeded.hh"
 #include "unimock/CallRecorder.hh"
 #include "unimock/ResultSetFactory.hh"
 
@@ -29,6 +36,37 @@ void setUPtr( std::unique_ptr<int> uip ) {}
 void setFunction( std::function<void(int, std::string)> f )
    { f( 45, "fortyfive" ); }
 
+// Holds the calls that enter it until it's opened.
+class Gate
+{
+public:
+   Gate() : mutex_(), changed_(), entered_( 0 ), open_( false ) {}
+   int pass( int i )
+   {
+      std::unique_lock<std::mutex> lock( mutex_ );
+      ++entered_;
+      changed_.notify_all();
+      changed_.wait( lock, [this]{ return open_; } );
+      return i;
+   }
+   void awaitEntered( int entered )
+   {
+      std::unique_lock<std::mutex> lock( mutex_ );
+      changed_.wait( lock, [&]{ return entered_ >= entered; } );
+   }
+   void open()
+   {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      open_ = true;
+      changed_.notify_all();
+   }
+private:
+   std::mutex mutex_;
+   std::condition_variable changed_;
+   int entered_;
+   bool open_;
+};
+
 } // unnamed namespace
 
 
@@ -135,5 +173,169 @@ void testFunctorMock()
       ensure( resultSet2.get<0, 1>() == "fortyfive" );
    }
 
-}
+   test( "Respond to mock functor calls from a table and a sequence" );
+   {
+      FunctorMock<int(int, std::string)> mock(
+         []( int i, std::string ) { return i; } );
+      mock.setResponse( std::make_tuple( 1, "one" ), 100 );
+      std::function<int(int, std::string)> copy = mock;
+
+      ensure( copy( 1, "one" ) == 100 );
+      ensure( mock( 1, "two" ) == 1 );
+
+      mock.setResponseSequence( { 5, 6, 7 } );
+      ensure( mock( 2, "two" ) == 5 );
+      ensure( mock( 1, "one" ) == 100 );
+      ensure( mock( 2, "two" ) == 7 );
+      ensure( mock( 2, "two" ) == 2 );
+      ensure( makeResultSet( mock ).size() == 6 );
+   }
+
+   test( "Respond to mock functor calls with C strings by their characters" );
+   {
+      FunctorMock<int(const char*)> mock( []( const char* ) { return 0; } );
+      mock.setResponse( std::make_tuple( "one" ), 1 );
+      mock.setResponse( std::make_tuple( std::string( "two" ).c_str() ), 2 );
+
+      char one[] = "one";
+      const std::string two = "two";
+      ensure( mock( one ) == 1 );
+      ensure( mock( two.c_str() ) == 2 );
+      ensure( mock( "three" ) == 0 );
+   }
+
+   test( "Reject, time out and queue calls to a mock functor with a capacity" );
+   {
+      Gate gate;
+      auto stub = [&]( int i ) { return gate.pass( i ); };
+      FunctorMock<int(int)> rejecting( stub );
+      FunctorMock<int(int)> timingOut( stub );
+      FunctorMock<int(int)> queueing( stub );
+
+      Capacity capacity;
+      capacity.queueDepth = 0;
+      rejecting.setCapacity( capacity );
+      capacity.queueDepth = 1;
+      capacity.timeout = std::chrono::milliseconds( 1 );
+      timingOut.setCapacity( capacity );
+      queueing.setCapacity( Capacity() );
+
+      std::thread rejectingThread( [&]{ rejecting( 1 ); } );
+      std::thread timingOutThread( [&]{ timingOut( 2 ); } );
+      std::thread queueingThread( [&]{ queueing( 3 ); } );
+      gate.awaitEntered( 3 );
+      std::thread queuedThread( [&]{ queueing( 4 ); } );
+
+      auto exceeds =
+         []( FunctorMock<int(int)>& mock, CapacityExceeded::Reason reason )
+      {
+         try
+         {
+            mock( 0 );
+         }
+         catch( const CapacityExceeded& e )
+         {
+            return e.getReason() == reason;
+         }
+         return false;
+      };
+      ensure( exceeds( rejecting, CapacityExceeded::Reason::REJECTED ) );
+      ensure( exceeds( timingOut, CapacityExceeded::Reason::TIMED_OUT ) );
+
+      gate.open();
+      for( auto thread : { &rejectingThread, &timingOutThread,
+         &queueingThread, &queuedThread } )
+      {
+         thread->join();
+      }
+
+      auto statistics = rejecting.getCapacityStatistics();
+      ensure( statistics.served == 1 );
+      ensure( statistics.rejected == 1 );
+      ensure( statistics.queueingDelays.size() == 2 );
+      ensure( statistics.queueingDelays[ 1 ] ==
+         std::chrono::nanoseconds::min() );
+      statistics = timingOut.getCapacityStatistics();
+      ensure( statistics.served == 1 );
+      ensure( statistics.timedOut == 1 );
+      statistics = queueing.getCapacityStatistics();
+      ensure( statistics.served == 2 );
+      ensure( statistics.queueingDelay.size() == 2 );
+      ensure( statistics.queueingDelays.size() == 2 );
+      ensure( makeResultSet( queueing ).size() == 2 );
+   }
+
+   test( "Serve the queued calls to a mock functor in the order they arrive" );
+   {
+      Gate gate;
+      std::mutex mutex;
+      std::vector<int> served;
+      FunctorMock<int(int)> mock( [&]( int i )
+      {
+         {
+            std::lock_guard<std::mutex> lock( mutex );
+            served.push_back( i );
+         }
+         return gate.pass( i );
+      } );
+      mock.setCapacity( Capacity() );
+
+      std::vector<std::thread> threads;
+      threads.emplace_back( [&]{ mock( 0 ); } );
+      gate.awaitEntered( 1 );
+      for( int i = 1; i < 4; ++i )
+      {
+         threads.emplace_back( [&, i]{ mock( i ); } );
+         std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+      }
+      gate.open();
+      for( auto& thread : threads )
+         thread.join();
+
+      auto delays = mock.getCapacityStatistics().queueingDelays;
+      ensure( served == std::vector<int>( { 0, 1, 2, 3 } ) );
+      ensure( delays.size() == 4 );
+      ensure( delays[ 1 ] > delays[ 2 ] );
+      ensure( delays[ 2 ] > delays[ 3 ] );
+   }
+
+   test( "Defer the futures of a stubbed mock functor in virtual time" );
+   {
+      auto scheduler = std::make_shared<VirtualScheduler>();
+      FunctorMock<std::future<int>(int)> mock( []( int i )
+      {
+         return std::async( std::launch::deferred, [=]{ return i * 2; } );
+      } );
+      mock.setVirtualLatency( scheduler, std::chrono::milliseconds( 10 ) );
+
+      auto first = mock( 1 );
+      scheduler->advance( std::chrono::milliseconds( 5 ) );
+      auto second = mock( 2 );
+      scheduler->advance( std::chrono::milliseconds( 5 ) );
+      ensure( first.wait_for( std::chrono::seconds( 0 ) ) ==
+         std::future_status::ready );
+      ensure( second.wait_for( std::chrono::seconds( 0 ) ) ==
+         std::future_status::timeout );
+
+      scheduler->run();
+      ensure( scheduler->now() == std::chrono::milliseconds( 15 ) );
+      ensure( first.get() == 2 );
+      ensure( second.get() == 4 );
+   }
 
+   test( "Charge the cost of mock functor calls to a cost model" );
+   {
+      auto model = std::make_shared<CostModel>();
+      FunctorMock<void(int, std::string)> mock;
+      mock.setCostModel(
+         model, CostModel::fixed( std::chrono::milliseconds( 2 ) ) );
+
+      mock( 1, "one" );
+      mock( 2, "two" );
+
+      ensure( model->getReport().calls == 2 );
+      ensure( model->getReport().criticalPath ==
+         std::chrono::milliseconds( 4 ) );
+   }
+
+}
@@ -0,0 +1,72 @@
+/*
+
+   HyperLogLogTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <string>
+#include <cmath>     // std::abs
+
+#include "Test.hh"
+
+#include "unimock/HyperLogLog.hh"
+
+
+void testHyperLogLog()
+{
+   using namespace unimock;
+
+   test( "Estimate zero distinct values in an empty sketch" );
+   {
+      HyperLogLog sketch;
+
+      ensure( sketch.estimate() == 0.0 );
+   }
+
+   test( "Estimate a small number of distinct values exactly" );
+   {
+      HyperLogLog sketch;
+
+      for( int i = 0; i < 100; i++ )
+      {
+         sketch.add( i % 10 );
+      }
+
+      ensure( std::abs( sketch.estimate() - 10.0 ) < 0.5 );
+   }
+
+   test( "Estimate a large number of distinct values" );
+   {
+      HyperLogLog sketch;
+
+      for( int i = 0; i < 100000; i++ )
+      {
+         sketch.add( std::to_string( i ) );
+         sketch.add( std::to_string( i ) );
+      }
+
+      ensure( std::abs( sketch.estimate() - 100000.0 ) < 5000.0 );
+   }
+
+   test( "Merge sketches with overlapping values" );
+   {
+      HyperLogLog sketch1;
+      HyperLogLog sketch2;
+
+      for( int i = 0; i < 20000; i++ )
+      {
+         sketch1.add( i );
+         sketch2.add( i + 10000 );
+      }
+
+      sketch1.merge( sketch2 );
+      ensure( std::abs( sketch1.estimate() - 30000.0 ) < 1500.0 );
+   }
+}
@@ -0,0 +1,156 @@
+/*
+
+   InterningConversionPolicyTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <string>
+#include <memory>    // std::unique_ptr
+#include <functional>
+#include <type_traits>
+
+#include "Test.hh"
+
+#include "unimock/InterningConversionPolicy.hh"
+#include "unimock/CallRecorder.hh"
+#include "unimock/ResultSet.hh"
+#include "unimock/FiniteID.hh"
+
+
+namespace
+{
+
+struct Payload
+{
+   int values[ 16 ];
+};
+
+bool operator==( const Payload& lhs, const Payload& rhs )
+{
+   return lhs.values[ 0 ] == rhs.values[ 0 ];
+}
+
+void setName( std::string name ) {}
+void setPayload( Payload payload, int i ) {}
+
+class ISomeClass
+{
+public:
+   virtual ~ISomeClass() {}
+   virtual void setIntStr( int i, const std::string& s ) = 0;
+};
+
+} // unnamed namespace
+
+
+namespace std
+{
+
+template<>
+struct hash<Payload>
+{
+   std::size_t operator()( const Payload& payload ) const
+   {
+      return std::hash<int>()( payload.values[ 0 ] );
+   }
+};
+
+} // namespace
+
+
+namespace unimock
+{
+
+template<>
+struct IsInterned<Payload> : std::true_type {};
+
+} // namespace
+
+
+void testInterningConversionPolicy()
+{
+   using namespace unimock;
+
+   test( "Intern strings and pass other types unchanged" );
+   {
+      InterningConversionPolicy policy;
+      int i = 3;
+      std::string s = "one";
+
+      auto interned1 = policy.convert( "one" );
+      auto interned2 = policy.convert( s );
+      auto interned3 = policy.convert( std::string( "two" ) );
+      auto interned4 = policy.convert( &s );
+      auto interned5 = policy.convert( "two" );
+      auto interned6 = policy.convert( "one" );
+
+      static_assert(
+         std::is_same<decltype( interned1 ), Interned<std::string>>::value,
+         "String literals shall be interned as std::string" );
+      static_assert(
+         std::is_same<decltype( policy.convert( &i ) ), int>::value,
+         "Types that aren't interned shall be copied" );
+
+      ensure( &interned1.get() == &interned2.get() );
+      ensure( &interned1.get() == &interned4.get() );
+      ensure( &interned3.get() == &interned5.get() );
+      ensure( &interned1.get() == &interned6.get() );
+      ensure( interned1 == interned2 );
+      ensure( interned1 != interned3 );
+      ensure( interned3 == "two" );
+      ensure( interned1 < interned3 );
+      ensure( interned1->size() == 3 );
+      ensure( policy.convert( &i ) == 3 );
+      ensure( policy.convert( std::unique_ptr<int>( new int( 4 ) ) ) == 4 );
+      ensure( policy.internedCount() == 2 );
+   }
+
+   test( "Store recorded values once" );
+   {
+      CallRecorder<InterningConversionPolicy> recorder;
+      FiniteID id = FiniteID::generate();
+
+      for( int i = 0; i < 1000; i++ )
+      {
+         recorder.record( setName, i % 2 ? "odd" : "even" );
+         recorder.record( id, &ISomeClass::setIntStr, i, "some string" );
+      }
+
+      auto resultSet = makeResultSet( recorder.find( setName ) );
+      ensure( resultSet.size() == 1000 );
+      ensure( resultSet.get<0>( 0 ) == "even" );
+      ensure( resultSet.get<0>( 1 ) == "odd" );
+      ensure( &resultSet.get<0>( 1 ).get() == &resultSet.get<0>( 3 ).get() );
+      ensure( std::string( resultSet.get<0>( 2 ) ) == "even" );
+
+      auto resultSet2 =
+         makeResultSet( recorder.find( id, &ISomeClass::setIntStr ) );
+      ensure( resultSet2.get<1>( 999 ) == "some string" );
+      ensure( recorder.internedCount() == 3 );
+   }
+
+   test( "Intern user defined types" );
+   {
+      CallRecorder<InterningConversionPolicy> recorder;
+      Payload payload1 = { { 1 } };
+      Payload payload2 = { { 2 } };
+
+      recorder.record( setPayload, payload1, 1 );
+      recorder.record( setPayload, payload2, 2 );
+      recorder.record( setPayload, payload1, 3 );
+
+      auto resultSet = makeResultSet( recorder.find( setPayload ) );
+      ensure( resultSet.size() == 3 );
+      ensure( resultSet.get<0>( 0 ) == resultSet.get<0>( 2 ) );
+      ensure( resultSet.get<0>( 1 )->values[ 0 ] == 2 );
+      ensure( resultSet.get<1>( 2 ) == 3 );
+      ensure( recorder.internedCount() == 2 );
+   }
+}
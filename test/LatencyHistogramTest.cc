@@ -0,0 +1,84 @@
+/*
+
+   LatencyHistogramTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <cstdint>   // std::uint64_t
+
+#include "Test.hh"
+
+#include "unimock/LatencyHistogram.hh"
+
+
+namespace
+{
+
+bool isClose( std::uint64_t estimate, std::uint64_t value, double error )
+{
+   const double difference =
+      static_cast<double>( estimate ) - static_cast<double>( value );
+   return difference <= error * value && -difference <= error * value;
+}
+
+} // unnamed namespace
+
+
+void testLatencyHistogram()
+{
+   using namespace unimock;
+
+   test( "Track size, min, max and mean of the latencies added" );
+   {
+      LatencyHistogram histogram;
+
+      histogram.add( 500 );
+      histogram.add( 20 );
+      histogram.add( 1000000 );
+
+      ensure( histogram.size() == 3 );
+      ensure( histogram.min() == 20 );
+      ensure( histogram.max() == 1000000 );
+      ensure( histogram.mean() == 1000520.0 / 3 );
+      ensure( histogram.quantile( 0.0 ) == 20 );
+      ensure( histogram.quantile( 1.0 ) == 1000000 );
+   }
+
+   test( "Estimate latency percentiles within the relative error" );
+   {
+      LatencyHistogram histogram;
+
+      for( std::uint64_t i = 1; i <= 1000000; i++ )
+         histogram.add( ( i * 7919 ) % 1000000 + 1 );
+
+      ensure( isClose( histogram.quantile( 0.5 ), 500000, 0.008 ) );
+      ensure( isClose( histogram.quantile( 0.99 ), 990000, 0.008 ) );
+      ensure( isClose( histogram.quantile( 0.999 ), 999000, 0.008 ) );
+      ensure( isClose( histogram.quantile( 0.0001 ), 100, 0.008 ) );
+   }
+
+   test( "Merge latency histograms" );
+   {
+      LatencyHistogram histogram1( 10 );
+      LatencyHistogram histogram2( 10 );
+
+      for( std::uint64_t i = 0; i < 50000; i++ )
+      {
+         histogram1.add( i );
+         histogram2.add( i + 50000 );
+      }
+
+      histogram1.merge( histogram2 );
+      ensure( histogram1.size() == 100000 );
+      ensure( histogram1.min() == 0 );
+      ensure( histogram1.max() == 99999 );
+      ensure( isClose( histogram1.quantile( 0.75 ), 75000, 0.001 ) );
+   }
+}
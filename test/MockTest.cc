@@ -11,8 +11,16 @@
 ________________________________________________________________________________
 */
 
+#include <cstdint>      // std::uint64_t
 #include <memory>       // std::unique_ptr, std::shared_ptr
 #include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <vector>
+#include <chrono>
+#include <stdexcept>    // std::runtime_error
 
 #include "Test.hh"
 
@@ -32,6 +40,8 @@ public:
    virtual void setAnotherInt( int i ) = 0;
    virtual void setIntConst( int i ) const = 0;
    virtual int getInt() const = 0;
+   virtual int getIntFor( int i ) = 0;
+   virtual std::future<int> getFutureIntFor( int i ) = 0;
    virtual void getIntByRef( int& ir ) = 0;
    virtual void setIntPtr( int* ip ) = 0;
    virtual void setClass( ISomeClass* scp ) = 0;
@@ -58,6 +68,10 @@ public:
    void setIntConst( int i ) const override
       { call( &ISomeClass::setIntConst, i ); }
    int getInt() const override { return call( &ISomeClass::getInt ); }
+   int getIntFor( int i ) override
+      { return call( &ISomeClass::getIntFor, i ); }
+   std::future<int> getFutureIntFor( int i ) override
+      { return call( &ISomeClass::getFutureIntFor, i ); }
    void getIntByRef( int& ir ) override
       { call( &ISomeClass::getIntByRef, ir ); }
    void setIntPtr( int* ip ) override { call( &ISomeClass::setIntPtr, ip ); }
@@ -86,6 +100,9 @@ public:
    void setAnotherInt( int i ) override {}
    void setIntConst( int i ) const override {}
    int getInt() const override { return 42; }
+   int getIntFor( int i ) override { return i; }
+   std::future<int> getFutureIntFor( int i ) override
+      { return std::async( std::launch::deferred, [=]{ return i; } ); }
    void getIntByRef( int& ir ) override { ir = 45; }
    void setIntPtr( int* ip ) override {}
    void setClass( ISomeClass* scp ) override {}
@@ -99,6 +116,77 @@ public:
    std::string getStr() const override { return "const"; }
 };
 
+class CountingSomeClassStub : public SomeClassStub
+{
+public:
+   CountingSomeClassStub() : callCount( 0 ) {}
+   int getIntFor( int i ) override { ++callCount; return i * 2; }
+   int callCount;
+};
+
+// Writes its own value through pointers and keeps the strings it's given.
+class WritingSomeClassStub : public SomeClassStub
+{
+public:
+   explicit WritingSomeClassStub( int value ) : str(), value_( value ) {}
+   void setIntPtr( int* ip ) override { *ip = value_; }
+   void setStrPtr( const char* ccp ) override { str = ccp; }
+   std::string str;
+private:
+   const int value_;
+};
+
+// Holds the calls to getIntFor( n ) until n of them are in flight.
+class GatedSomeClassStub : public SomeClassStub
+{
+public:
+   GatedSomeClassStub() : mutex_(), arrived_(), callCount_( 0 ) {}
+   int getIntFor( int i ) override
+   {
+      std::unique_lock<std::mutex> lock( mutex_ );
+      ++callCount_;
+      arrived_.notify_all();
+      arrived_.wait( lock, [&]{ return callCount_ >= i; } );
+      return i;
+   }
+private:
+   std::mutex mutex_;
+   std::condition_variable arrived_;
+   int callCount_;
+};
+
+// Holds the call to getIntFor( 1 ) until released, so later calls can return
+// before it, and throws from getIntFor for negative numbers.
+class HoldingSomeClassStub : public SomeClassStub
+{
+public:
+   HoldingSomeClassStub() : entered(), release() {}
+   int getIntFor( int i ) override
+   {
+      if( i < 0 )
+         throw std::runtime_error( "negative" );
+      if( i == 1 )
+      {
+         entered.set_value();
+         release.get_future().wait();
+      }
+      return i;
+   }
+   std::promise<void> entered;
+   std::promise<void> release;
+};
+
+// Returns the futures of another object from getFutureIntFor.
+class ForwardingSomeClassStub : public SomeClassStub
+{
+public:
+   explicit ForwardingSomeClassStub( ISomeClass& next ) : next_( next ) {}
+   std::future<int> getFutureIntFor( int i ) override
+      { return next_.getFutureIntFor( i ); }
+private:
+   ISomeClass& next_;
+};
+
 struct SomeConversionPolicy
 {
    template<typename T>
@@ -344,5 +432,416 @@ void testMock()
       ensure( iValue2 == 52 );
    }
 
-}
+   test( "Select the mock method calls to record" );
+   {
+      auto stub = std::shared_ptr<ISomeClass>( new SomeClassStub );
+      auto recorder = std::make_shared<CallRecorder<>>();
+      SomeClassMock mock1( recorder, stub );
+      SomeClassMock mock2( recorder, stub );
+
+      mock1.setRecorded( &ISomeClass::getInt, false );
+      mock1.setFilter( &ISomeClass::setInt, []( int i ){ return i > 5; } );
+      mock1.setFilter(
+         &ISomeClass::setConstRefUPtr,
+         []( const std::unique_ptr<int>& uip ){ return *uip == 7; } );
+
+      auto iValue = mock1.getInt();
+      mock2.getInt();
+      for( int i = 0; i < 10; i++ )
+      {
+         mock1.setInt( i );
+         mock2.setInt( i );
+      }
+      mock1.setConstRefUPtr( std::make_unique<int>( 6 ) );
+      mock1.setConstRefUPtr( std::make_unique<int>( 7 ) );
+
+      ensure( iValue == 42 );
+      ensure( mock1.find( &ISomeClass::getInt ).empty() );
+      ensure( mock2.find( &ISomeClass::getInt ).size() == 1 );
+      auto resultSet = makeResultSet( mock1, &ISomeClass::setInt );
+      ensure( resultSet.size() == 4 );
+      ensure( resultSet.get<0, 0>() == 6 );
+      ensure( mock2.find( &ISomeClass::setInt ).size() == 10 );
+      auto resultSet2 = makeResultSet( mock1, &ISomeClass::setConstRefUPtr );
+      ensure( resultSet2.size() == 1 );
+      ensure( resultSet2.get<0, 0>() == 7 );
+
+      mock1.setRecorded( &ISomeClass::getInt, true );
+      mock1.getInt();
+      ensure( mock1.find( &ISomeClass::getInt ).size() == 1 );
+
+      // Turning recording off and on again keeps the filter.
+      mock1.setRecorded( &ISomeClass::setInt, false );
+      mock1.setInt( 8 );
+      ensure( mock1.find( &ISomeClass::setInt ).size() == 4 );
+      mock1.setRecorded( &ISomeClass::setInt, true );
+      mock1.setInt( 3 );
+      mock1.setInt( 9 );
+      ensure( mock1.find( &ISomeClass::setInt ).size() == 5 );
+   }
 
+   test( "Keep only the projected arguments of a mock method call" );
+   {
+      auto recorder = std::make_shared<CallRecorder<>>();
+      SomeClassMock mock1( recorder );
+      SomeClassMock mock2( recorder );
+
+      mock1.project<0>( &ISomeClass::setIntConst );
+      mock1.project<0>( &ISomeClass::setConstRefUPtr );
+
+      mock1.setIntConst( 3 );
+      mock2.setIntConst( 4 );
+      mock1.setConstRefUPtr( std::make_unique<int>( 5 ) );
+
+      auto resultSet =
+         makeResultSet( mock1.find<0>( &ISomeClass::setIntConst ) );
+      ensure( resultSet.size() == 1 );
+      ensure( resultSet.get<0, 0>() == 3 );
+      ensure( mock2.find<0>( &ISomeClass::setIntConst ).size() == 1 );
+      ensure( mock1.find( &ISomeClass::setIntConst ).empty() );
+      auto resultSet2 =
+         makeResultSet( mock1.find<0>( &ISomeClass::setConstRefUPtr ) );
+      ensure( resultSet2.get<0, 0>() == 5 );
+   }
+
+   test( "Respond to mock method calls from a table and a sequence" );
+   {
+      SomeClassMock mock;
+      mock.setResponse( &ISomeClass::getIntFor, std::make_tuple( 1 ), 10 );
+      mock.setResponse( &ISomeClass::getIntFor, std::make_tuple( 2 ), 20 );
+      mock.setResponseSequence( &ISomeClass::getInt, { 7, 8 } );
+      mock.override( &ISomeClass::getIntFor, []( int i ) { return -i; } );
+
+      ensure( mock.getIntFor( 2 ) == 20 );
+      ensure( mock.getIntFor( 1 ) == 10 );
+      ensure( mock.getIntFor( 3 ) == -3 );
+      ensure( mock.getInt() == 7 );
+      ensure( mock.getInt() == 8 );
+      ensure( mock.getInt() == 0 );
+      ensure( mock.find( &ISomeClass::getIntFor ).size() == 3 );
+   }
+
+   test( "Memoize the results of a stubbed mock method" );
+   {
+      auto stub = std::make_shared<CountingSomeClassStub>();
+      SomeClassMock mock( stub );
+      mock.memoize( &ISomeClass::getIntFor, 2 );
+
+      ensure( mock.getIntFor( 1 ) == 2 );
+      ensure( mock.getIntFor( 1 ) == 2 );
+      ensure( mock.getIntFor( 2 ) == 4 );
+      ensure( mock.getIntFor( 1 ) == 2 );
+      ensure( stub->callCount == 2 );
+
+      // The least recently used result is evicted.
+      ensure( mock.getIntFor( 3 ) == 6 );
+      ensure( mock.getIntFor( 1 ) == 2 );
+      ensure( mock.getIntFor( 2 ) == 4 );
+      ensure( stub->callCount == 4 );
+
+      auto statistics = mock.getMemoStatistics( &ISomeClass::getIntFor );
+      ensure( statistics.hits == 3 );
+      ensure( statistics.misses == 4 );
+      ensure( statistics.size == 2 );
+      ensure( mock.find( &ISomeClass::getIntFor ).size() == 7 );
+      ensure( mock.getMemoStatistics( &ISomeClass::getInt ).misses == 0 );
+   }
+
+   test( "Mirror stub calls to a candidate and compare the results" );
+   {
+      for( auto execution :
+         { CandidateExecution::INLINE, CandidateExecution::ASYNCHRONOUS } )
+      {
+         auto candidate = std::make_shared<CountingSomeClassStub>();
+         SomeClassMock mock( std::make_shared<SomeClassStub>() );
+         mock.setCandidate( candidate, execution );
+
+         ensure( mock.getIntFor( 0 ) == 0 );
+         ensure( mock.getIntFor( 1 ) == 1 );
+         ensure( mock.getInt() == 42 );
+         mock.setInt( 3 );
+         mock.flushCandidate();
+
+         auto report = mock.getDifferentialReport( &ISomeClass::getIntFor );
+         ensure( candidate->callCount == 2 );
+         ensure( report.calls == 2 );
+         ensure( report.mismatches == 1 );
+         ensure( report.primaryLatency.size() == 2 );
+         ensure( report.candidateLatency.size() == 2 );
+         ensure( mock.getDifferentialReport( &ISomeClass::getInt ).calls == 1 );
+         ensure(
+            mock.getDifferentialReport( &ISomeClass::setInt ).mismatches == 0 );
+         ensure(
+            mock.getDifferentialReport( &ISomeClass::setIntPtr ).calls == 0 );
+
+         int i = 0;
+         mock.getIntByRef( i );
+         mock.flushCandidate();
+         auto byRef = mock.getDifferentialReport( &ISomeClass::getIntByRef );
+         ensure( i == 45 );
+         ensure( byRef.calls == 1 );
+         ensure( byRef.mismatches == 0 );
+         ensure( byRef.notCompared == 1 );
+         ensure( report.notCompared == 0 );
+      }
+   }
+
+   test( "Keep the caller's values out of reach of a candidate" );
+   {
+      for( auto execution :
+         { CandidateExecution::INLINE, CandidateExecution::ASYNCHRONOUS } )
+      {
+         auto candidate = std::make_shared<WritingSomeClassStub>( 6 );
+         SomeClassMock mock( std::make_shared<WritingSomeClassStub>( 5 ) );
+         mock.setCandidate( candidate, execution );
+
+         int i = 0;
+         mock.setIntPtr( &i );
+         char str[] = "first";
+         mock.setStrPtr( str );
+         str[ 0 ] = 'F';
+         mock.flushCandidate();
+
+         ensure( i == 5 );
+         ensure(
+            mock.getDifferentialReport( &ISomeClass::setIntPtr ).calls == 0 );
+         ensure(
+            mock.getDifferentialReport( &ISomeClass::setStrPtr ).calls == 1 );
+         ensure( candidate->str == "first" );
+      }
+   }
+
+   test( "Time the calls of a stubbed mock method" );
+   {
+      auto stub = std::make_shared<CountingSomeClassStub>();
+      SomeClassMock mock( stub );
+      mock.setTimed( &ISomeClass::getIntFor, true );
+      mock.setFilter( &ISomeClass::getIntFor, []( int i ){ return i > 0; } );
+
+      ensure( mock.getIntFor( 1 ) == 2 );
+      ensure( mock.getIntFor( 0 ) == 0 );
+      ensure( mock.getIntFor( 2 ) == 4 );
+      ensure( mock.getInt() == 42 );
+
+      auto histogram = mock.getLatencyHistogram( &ISomeClass::getIntFor );
+      auto latencies = mock.findLatencies( &ISomeClass::getIntFor );
+      ensure( histogram.size() == 3 );
+      ensure( latencies.size() == 2 );
+      ensure( latencies.size() == mock.find( &ISomeClass::getIntFor ).size() );
+      ensure( histogram.min() <= std::uint64_t( latencies[ 0 ].count() ) );
+      ensure( histogram.max() >= std::uint64_t( latencies[ 1 ].count() ) );
+      ensure( mock.getLatencyHistogram( &ISomeClass::getInt ).size() == 0 );
+
+      mock.setTimed( &ISomeClass::getIntFor, false );
+      ensure( mock.getIntFor( 3 ) == 6 );
+      ensure( mock.findLatencies( &ISomeClass::getIntFor ).empty() );
+   }
+
+   test( "Line up the latencies with the recorded calls" );
+   {
+      using std::chrono::nanoseconds;
+      using std::chrono::milliseconds;
+
+      auto stub = std::make_shared<HoldingSomeClassStub>();
+      SomeClassMock mock( stub );
+      mock.setTimed( &ISomeClass::getIntFor, true );
+      mock.setResponse( &ISomeClass::getIntFor, std::make_tuple( 3 ), 30 );
+
+      std::thread holder( [&]{ mock.getIntFor( 1 ); } );
+      stub->entered.get_future().wait();
+      ensure( mock.getIntFor( 2 ) == 2 );
+      std::this_thread::sleep_for( milliseconds( 5 ) );
+      stub->release.set_value();
+      holder.join();
+
+      ensure( mock.getIntFor( 3 ) == 30 );
+      bool threw = false;
+      try
+      {
+         mock.getIntFor( -1 );
+      }
+      catch( const std::runtime_error& )
+      {
+         threw = true;
+      }
+
+      auto latencies = mock.findLatencies( &ISomeClass::getIntFor );
+      ensure( threw );
+      ensure( mock.find( &ISomeClass::getIntFor ).size() == 4 );
+      ensure( latencies.size() == 4 );
+      ensure( latencies[ 0 ] >= milliseconds( 5 ) );
+      ensure( latencies[ 1 ] >= nanoseconds( 0 ) );
+      ensure( latencies[ 1 ] < latencies[ 0 ] );
+      ensure( latencies[ 2 ] == nanoseconds::min() );
+      ensure( latencies[ 3 ] == nanoseconds::min() );
+      ensure( mock.getLatencyHistogram( &ISomeClass::getIntFor ).size() == 2 );
+
+      // A call violating an expectation is recorded before the violation is
+      // thrown, and keeps its slot.
+      auto recorder = std::make_shared<CallRecorder<>>();
+      SomeClassMock expectingMock( recorder );
+      recorder->expectCalls( &ISomeClass::getIntFor, 1 );
+      expectingMock.setTimed( &ISomeClass::getIntFor, true );
+      int violations = 0;
+      for( int i = 0; i < 3; ++i )
+      {
+         try
+         {
+            expectingMock.getIntFor( i );
+         }
+         catch( const std::logic_error& )
+         {
+            ++violations;
+         }
+      }
+
+      ensure( violations == 1 );
+      ensure( expectingMock.find( &ISomeClass::getIntFor ).size() == 3 );
+      auto expectedLatencies =
+         expectingMock.findLatencies( &ISomeClass::getIntFor );
+      ensure( expectedLatencies.size() == 3 );
+      ensure( expectedLatencies[ 0 ] >= nanoseconds( 0 ) );
+      ensure( expectedLatencies[ 1 ] == nanoseconds::min() );
+      ensure( expectedLatencies[ 2 ] >= nanoseconds( 0 ) );
+   }
+
+   test( "Track the calls in flight to a stubbed mock method" );
+   {
+      SomeClassMock mock( std::make_shared<GatedSomeClassStub>() );
+      mock.setConcurrencyTracked( &ISomeClass::getIntFor, true );
+      mock.setConcurrencyTracked( &ISomeClass::setInt, true );
+
+      std::vector<std::thread> threads;
+      for( int i = 0; i < 3; ++i )
+         threads.emplace_back( [&]{ mock.getIntFor( 3 ); } );
+      for( auto& thread : threads )
+         thread.join();
+      mock.setInt( 1 );
+      mock.getInt();
+
+      auto profile = mock.getConcurrencyProfile( &ISomeClass::getIntFor );
+      ensure( profile.calls == 3 );
+      ensure( profile.maxInFlight == 3 );
+      ensure( profile.samples.size() == 6 );
+      ensure( profile.samples.back().inFlight == 0 );
+      ensure( mock.getConcurrencyProfile( &ISomeClass::setInt ).calls == 1 );
+      ensure( mock.getConcurrencyProfile( &ISomeClass::getInt ).calls == 0 );
+
+      auto objectProfile = mock.getConcurrencyProfile();
+      ensure( objectProfile.calls == 4 );
+      ensure( objectProfile.maxInFlight == 3 );
+
+      mock.setConcurrencyTracked( &ISomeClass::getIntFor, false );
+      mock.setConcurrencyTracked( &ISomeClass::setInt, false );
+      ensure( mock.getConcurrencyProfile().calls == 0 );
+   }
+
+   test( "Serve the calls of a stubbed mock method with a capacity" );
+   {
+      SomeClassMock mock( std::make_shared<CountingSomeClassStub>() );
+      Capacity capacity;
+      capacity.servers = 2;
+      capacity.serviceTime = []{ return std::chrono::milliseconds( 1 ); };
+      mock.setCapacity( &ISomeClass::getIntFor, capacity );
+      mock.setTimed( &ISomeClass::getIntFor, true );
+
+      ensure( mock.getIntFor( 1 ) == 2 );
+      ensure( mock.getIntFor( 2 ) == 4 );
+      ensure( mock.getInt() == 42 );
+
+      auto statistics = mock.getCapacityStatistics( &ISomeClass::getIntFor );
+      ensure( statistics.served == 2 );
+      ensure( statistics.rejected == 0 );
+      ensure( statistics.queueingDelays.size() == 2 );
+      ensure( mock.getLatencyHistogram( &ISomeClass::getIntFor ).min() >=
+         1000000 );
+      ensure( mock.getCapacityStatistics( &ISomeClass::getInt ).served == 0 );
+
+      capacity.servers = 1;
+      mock.setCapacity( &ISomeClass::getIntFor, capacity );
+      mock.setConcurrencyTracked( &ISomeClass::getIntFor, true );
+
+      std::vector<std::thread> threads;
+      for( int i = 0; i < 3; ++i )
+         threads.emplace_back( [&, i]{ mock.getIntFor( i ); } );
+      for( auto& thread : threads )
+         thread.join();
+
+      auto profile = mock.getConcurrencyProfile( &ISomeClass::getIntFor );
+      ensure( profile.calls == 3 );
+      ensure( profile.maxInFlight == 1 );
+   }
+
+   test( "Defer the futures of a stubbed mock method in virtual time" );
+   {
+      auto scheduler = std::make_shared<VirtualScheduler>();
+      SomeClassMock mock( std::make_shared<SomeClassStub>() );
+      mock.setVirtualLatency(
+         &ISomeClass::getFutureIntFor, scheduler, std::chrono::hours( 1 ) );
+
+      auto future = mock.getFutureIntFor( 7 );
+      ensure( scheduler->size() == 1 );
+      ensure( future.wait_for( std::chrono::seconds( 0 ) ) ==
+         std::future_status::timeout );
+
+      scheduler->advance( std::chrono::hours( 1 ) );
+      ensure( future.wait_for( std::chrono::seconds( 0 ) ) ==
+         std::future_status::ready );
+      ensure( future.get() == 7 );
+
+      mock.setVirtualLatency(
+         &ISomeClass::getFutureIntFor, nullptr, std::chrono::hours( 1 ) );
+      ensure( mock.getFutureIntFor( 8 ).get() == 8 );
+      ensure( scheduler->size() == 0 );
+      ensure( mock.find( &ISomeClass::getFutureIntFor ).size() == 2 );
+   }
+
+   test( "Defer the futures of chained mock methods in virtual time" );
+   {
+      using std::chrono::milliseconds;
+
+      auto scheduler = std::make_shared<VirtualScheduler>();
+      SomeClassMock inner( std::make_shared<SomeClassStub>() );
+      SomeClassMock outer( std::make_shared<ForwardingSomeClassStub>( inner ) );
+      inner.setVirtualLatency(
+         &ISomeClass::getFutureIntFor, scheduler, milliseconds( 10 ) );
+      outer.setVirtualLatency(
+         &ISomeClass::getFutureIntFor, scheduler, milliseconds( 5 ) );
+
+      auto future = outer.getFutureIntFor( 7 );
+      ensure( scheduler->advance( milliseconds( 5 ) ) == 1 );
+      ensure( future.wait_for( std::chrono::seconds( 0 ) ) ==
+         std::future_status::timeout );
+
+      scheduler->advance( milliseconds( 5 ) );
+      ensure( future.wait_for( std::chrono::seconds( 0 ) ) ==
+         std::future_status::ready );
+      ensure( future.get() == 7 );
+      ensure( scheduler->size() == 0 );
+      ensure( scheduler->now() == milliseconds( 10 ) );
+   }
+
+   test( "Charge the costs of mock method calls to a cost model" );
+   {
+      auto model = std::make_shared<CostModel>();
+      model->setCost(
+         &ISomeClass::getIntFor,
+         CostModel::fixed( std::chrono::milliseconds( 3 ) ) );
+      model->setCost(
+         &ISomeClass::getInt,
+         CostModel::fixed( std::chrono::milliseconds( 1 ) ) );
+      SomeClassMock mock( std::make_shared<SomeClassStub>() );
+      mock.setCostModel( model );
+      mock.setResponse( &ISomeClass::getIntFor, std::make_tuple( 9 ), 90 );
+
+      mock.getIntFor( 1 );
+      ensure( mock.getIntFor( 9 ) == 90 );
+      mock.getInt();
+      mock.setInt( 1 );
+
+      auto report = model->getReport();
+      ensure( report.calls == 3 );
+      ensure( report.criticalPath == std::chrono::milliseconds( 7 ) );
+   }
+
+}
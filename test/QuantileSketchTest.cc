@@ -0,0 +1,71 @@
+/*
+
+   QuantileSketchTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <cmath>     // std::abs
+
+#include "Test.hh"
+
+#include "unimock/QuantileSketch.hh"
+
+
+void testQuantileSketch()
+{
+   using namespace unimock;
+
+   test( "Track size, min and max of the values added" );
+   {
+      QuantileSketch sketch;
+
+      sketch.add( 5.0 );
+      sketch.add( -2.0 );
+      sketch.add( 7.5 );
+
+      ensure( sketch.size() == 3 );
+      ensure( sketch.min() == -2.0 );
+      ensure( sketch.max() == 7.5 );
+      ensure( sketch.quantile( 0.0 ) == -2.0 );
+      ensure( sketch.quantile( 1.0 ) == 7.5 );
+   }
+
+   test( "Estimate quantiles of a uniform distribution" );
+   {
+      QuantileSketch sketch;
+
+      for( int i = 0; i <= 100000; i++ )
+      {
+         sketch.add( static_cast<double>( ( i * 7919 ) % 100001 ) );
+      }
+
+      ensure( std::abs( sketch.quantile( 0.5 ) - 50000.0 ) < 1000.0 );
+      ensure( std::abs( sketch.quantile( 0.99 ) - 99000.0 ) < 200.0 );
+      ensure( std::abs( sketch.quantile( 0.001 ) - 100.0 ) < 100.0 );
+   }
+
+   test( "Merge sketches" );
+   {
+      QuantileSketch sketch1;
+      QuantileSketch sketch2;
+
+      for( int i = 0; i < 50000; i++ )
+      {
+         sketch1.add( static_cast<double>( i ) );
+         sketch2.add( static_cast<double>( i + 50000 ) );
+      }
+
+      sketch1.merge( sketch2 );
+      ensure( sketch1.size() == 100000 );
+      ensure( sketch1.min() == 0.0 );
+      ensure( sketch1.max() == 99999.0 );
+      ensure( std::abs( sketch1.quantile( 0.75 ) - 75000.0 ) < 1000.0 );
+   }
+}
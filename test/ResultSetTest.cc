@@ -0,0 +1,252 @@
+/*
+
+   ResultSetTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <string>
+#include <vector>
+#include <tuple>
+
+#include "Test.hh"
+
+#include "unimock/CallRecorder.hh"
+#include "unimock/ResultSet.hh"
+
+
+namespace
+{
+
+void setIntStr( int i, std::string s ) {}
+void setSizeLevel( std::size_t size, double level ) {}
+
+} // unnamed namespace
+
+
+void testResultSet()
+{
+   using namespace unimock;
+
+   test( "Get elements with a run-time row index" );
+   {
+      CallRecorder<> recorder;
+
+      for( int i = 0; i < 100; i++ )
+         recorder.record( setIntStr, i, std::to_string( i ) );
+
+      auto resultSet = makeResultSet( recorder.find( setIntStr ) );
+      ensure( resultSet.size() == 100 );
+      for( std::size_t row = 0; row < resultSet.size(); row++ )
+      {
+         ensure( resultSet.get<0>( row ) == static_cast<int>( row ) );
+         ensure( resultSet.get<std::string>( row ) == std::to_string( row ) );
+      }
+   }
+
+   test( "Get elements by const reference" );
+   {
+      CallRecorder<> recorder;
+
+      recorder.record( setIntStr, 3, "three" );
+
+      auto resultSet = makeResultSet( recorder.find( setIntStr ) );
+      const std::string& s1 = resultSet.get<0, 1>();
+      const std::string& s2 = resultSet.get<1>( 0 );
+      const std::string& s3 = std::get<1>( resultSet[ 0 ] );
+      ensure( &s1 == &s2 );
+      ensure( &s2 == &s3 );
+      ensure( s1 == "three" );
+   }
+
+   test( "Get elements by value from a temporary result set" );
+   {
+      CallRecorder<> recorder;
+
+      recorder.record( setIntStr, 3, "three" );
+
+      const std::string s1 = makeResultSet( recorder.find( setIntStr ) )
+         .get<0, 1>();
+      const std::string s2 = makeResultSet( recorder.find( setIntStr ) )
+         .get<std::string>( 0 );
+      const auto row = makeResultSet( recorder.find( setIntStr ) )[ 0 ];
+      ensure( s1 == "three" );
+      ensure( s2 == "three" );
+      ensure( std::get<0>( row ) == 3 );
+   }
+
+   test( "Iterate over a result set" );
+   {
+      CallRecorder<> recorder;
+
+      recorder.record( setIntStr, 1, "one" );
+      recorder.record( setIntStr, 2, "two" );
+      recorder.record( setIntStr, 3, "three" );
+
+      auto resultSet = makeResultSet( recorder.find( setIntStr ) );
+      int sum = 0;
+      for( auto& call : resultSet )
+         sum += std::get<0>( call );
+      ensure( sum == 6 );
+      ensure( resultSet.end() - resultSet.begin() == 3 );
+      ensure( std::get<1>( *( resultSet.begin() + 2 ) ) == "three" );
+   }
+
+   test( "Check an empty result set" );
+   {
+      CallRecorder<> recorder;
+
+      auto resultSet = makeResultSet( recorder.find( setIntStr ) );
+      ensure( resultSet.empty() );
+      ensure( resultSet.begin() == resultSet.end() );
+   }
+
+   test( "Aggregate numeric columns" );
+   {
+      CallRecorder<> recorder;
+
+      for( std::size_t i = 1; i <= 1000; i++ )
+         recorder.record( setSizeLevel, i, 0.5 * i );
+
+      auto resultSet = makeResultSet( recorder.find( setSizeLevel ) );
+      ensure( resultSet.sum<0>() == 500500 );
+      ensure( resultSet.min<0>() == 1 );
+      ensure( resultSet.max<0>() == 1000 );
+      ensure( resultSet.mean<0>() == 500.5 );
+      ensure( resultSet.sum<1>() == 250250.0 );
+      ensure( resultSet.min<1>() == 0.5 );
+      ensure( resultSet.max<1>() == 500.0 );
+   }
+
+   test( "Check ranges and monotonicity of a column" );
+   {
+      CallRecorder<> recorder;
+
+      for( int i = 0; i < 512; i++ )
+         recorder.record( setIntStr, i / 3, "" );
+
+      auto resultSet = makeResultSet( recorder.find( setIntStr ) );
+      ensure( resultSet.allWithin<0>( 0, 170 ) );
+      ensure( !resultSet.allWithin<0>( 0, 169 ) );
+      ensure( !resultSet.allWithin<0>( 1, 170 ) );
+      ensure( resultSet.isMonotonic<0>() );
+
+      // Break the order on the boundary between two gathered blocks.
+      recorder.record( setIntStr, 169, "" );
+
+      auto resultSet2 = makeResultSet( recorder.find( setIntStr ) );
+      ensure( !resultSet2.isMonotonic<0>() );
+   }
+
+   test( "Aggregate an empty result set" );
+   {
+      CallRecorder<> recorder;
+
+      auto resultSet = makeResultSet( recorder.find( setSizeLevel ) );
+      ensure( resultSet.sum<0>() == 0 );
+      ensure( resultSet.allWithin<1>( 0.0, 1.0 ) );
+      ensure( resultSet.isMonotonic<1>() );
+   }
+
+   test( "Aggregate and filter a large result set in parallel" );
+   {
+      CallRecorder<> recorder;
+      ThreadPool threadPool( 4 );
+
+      for( std::size_t i = 0; i < 100000; i++ )
+         recorder.record( setSizeLevel, i, 1.0 );
+
+      auto resultSet = makeResultSet( recorder.find( setSizeLevel ) );
+      ensure( resultSet.sum<0>( threadPool ) == resultSet.sum<0>() );
+      ensure( resultSet.min<0>( threadPool ) == 0 );
+      ensure( resultSet.max<0>( threadPool ) == 99999 );
+      ensure( resultSet.mean<1>( threadPool ) == 1.0 );
+      ensure( resultSet.allWithin<0>( 0, 99999, threadPool ) );
+      ensure( resultSet.isMonotonic<0>( threadPool ) );
+
+      auto isEven = []( auto& row ) { return std::get<0>( row ) % 2 == 0; };
+      auto evenSet = resultSet.filter( isEven, threadPool );
+      ensure( evenSet.size() == 50000 );
+      ensure( evenSet.isMonotonic<0>() );
+      ensure( evenSet.get<0>( 49999 ) == 99998 );
+      ensure( resultSet.count( isEven, threadPool ) == 50000 );
+      ensure( resultSet.count( isEven ) == 50000 );
+      ensure( resultSet.filter( isEven ).size() == 50000 );
+   }
+
+   test( "Sort a result set by a column" );
+   {
+      CallRecorder<> recorder;
+
+      recorder.record( setIntStr, 3, "first three" );
+      recorder.record( setIntStr, 1, "one" );
+      recorder.record( setIntStr, 3, "second three" );
+      recorder.record( setIntStr, 2, "two" );
+
+      auto resultSet =
+         makeResultSet( recorder.find( setIntStr ) ).sortBy<0>();
+      ensure( resultSet.get<0>( 0 ) == 1 );
+      ensure( resultSet.get<0>( 1 ) == 2 );
+      ensure( resultSet.get<1>( 2 ) == "first three" );
+      ensure( resultSet.get<1>( 3 ) == "second three" );
+   }
+
+   test( "Group a result set by columns" );
+   {
+      CallRecorder<> recorder;
+
+      recorder.record( setIntStr, 3, "three" );
+      recorder.record( setIntStr, 1, "one" );
+      recorder.record( setIntStr, 3, "three" );
+      recorder.record( setIntStr, 3, "tre" );
+
+      auto resultSet = makeResultSet( recorder.find( setIntStr ) );
+      auto groups = resultSet.groupBy<0>();
+      ensure( groups.size() == 2 );
+      ensure( groups.get<0>( 0 ) == 3 );
+      ensure( groups.get<1>( 0 ) == 3 );
+      ensure( groups.get<0>( 1 ) == 1 );
+      ensure( groups.get<1>( 1 ) == 1 );
+      auto groups2 = resultSet.groupBy<0, 1>();
+      ensure( groups2.size() == 3 );
+      ensure( groups2.get<1>( 0 ) == "three" );
+      ensure( groups2.get<2>( 0 ) == 2 );
+   }
+
+   test( "Join two result sets" );
+   {
+      CallRecorder<> recorder;
+
+      recorder.record( setIntStr, 1, "one" );
+      recorder.record( setIntStr, 2, "two" );
+      recorder.record( setIntStr, 3, "three" );
+      recorder.record( setSizeLevel, 3, 0.3 );
+      recorder.record( setSizeLevel, 1, 0.1 );
+      recorder.record( setSizeLevel, 1, 0.11 );
+
+      auto resultSet = makeResultSet( recorder.find( setIntStr ) );
+      auto resultSet2 = makeResultSet( recorder.find( setSizeLevel ) );
+      auto joined = resultSet.hashJoin<0, 0>( resultSet2 );
+      ensure( joined.size() == 3 );
+      ensure( joined.get<1>( 0 ) == "one" );
+      ensure( joined.get<3>( 0 ) == 0.1 );
+      ensure( joined.get<3>( 1 ) == 0.11 );
+      ensure( joined.get<1>( 2 ) == "three" );
+      ensure( joined.get<3>( 2 ) == 0.3 );
+
+      auto paired = resultSet.sequenceJoin( resultSet2 );
+      ensure( paired.size() == 3 );
+      ensure( paired.get<0>( 0 ) == 1 );
+      ensure( paired.get<2>( 0 ) == 3 );
+      ensure( paired.count( []( auto& row ) {
+         return static_cast<std::size_t>( std::get<0>( row ) ) ==
+            std::get<2>( row ); } ) == 0 );
+   }
+
+}
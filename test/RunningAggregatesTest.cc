@@ -0,0 +1,73 @@
+/*
+
+   RunningAggregatesTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <cstdint>
+
+#include "Test.hh"
+
+#include "unimock/RunningAggregates.hh"
+
+
+void testRunningAggregates()
+{
+   using namespace unimock;
+
+   test( "Keep count, min, max and sum of added values" );
+   {
+      RunningAggregates<int> aggregates;
+
+      ensure( aggregates.count() == 0 );
+      ensure( aggregates.sum() == 0 );
+
+      aggregates.add( 3 );
+      aggregates.add( -7 );
+      aggregates.add( 10 );
+
+      ensure( aggregates.count() == 3 );
+      ensure( aggregates.min() == -7 );
+      ensure( aggregates.max() == 10 );
+      ensure( aggregates.sum() == 6 );
+      ensure( aggregates.mean() == 2.0 );
+   }
+
+   test( "Sum values in a wider type" );
+   {
+      RunningAggregates<std::int32_t> aggregates;
+
+      for( int i = 0; i < 4; i++ )
+         aggregates.add( 2000000000 );
+
+      ensure( aggregates.sum() == 8000000000 );
+   }
+
+   test( "Merge aggregates" );
+   {
+      RunningAggregates<double> aggregates1;
+      RunningAggregates<double> aggregates2;
+      RunningAggregates<double> empty;
+
+      aggregates1.add( 1.5 );
+      aggregates2.add( -2.5 );
+      aggregates2.add( 4.0 );
+      aggregates1.merge( aggregates2 );
+      aggregates1.merge( empty );
+      empty.merge( aggregates1 );
+
+      ensure( aggregates1.count() == 3 );
+      ensure( aggregates1.min() == -2.5 );
+      ensure( aggregates1.max() == 4.0 );
+      ensure( aggregates1.sum() == 3.0 );
+      ensure( empty.count() == 3 );
+      ensure( empty.min() == -2.5 );
+   }
+}
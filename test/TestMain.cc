@@ -11,20 +11,44 @@
 ________________________________________________________________________________
 */
 
+void testArenaConversionPolicy();
+void testBoundedConversionPolicy();
 void testCallRecorder();
+void testCassette();
+void testCostModel();
 void testFunctionMock();
 void testFunctorMock();
+void testHyperLogLog();
+void testInterningConversionPolicy();
+void testLatencyHistogram();
 void testMock();
+void testQuantileSketch();
+void testResultSet();
 void testResultSetFactory();
+void testRunningAggregates();
+void testThreadPool();
+void testVirtualScheduler();
 
 
 int main()
 {
+   testArenaConversionPolicy();
+   testBoundedConversionPolicy();
    testCallRecorder();
+   testCassette();
+   testCostModel();
    testFunctionMock();
    testFunctorMock();
+   testHyperLogLog();
+   testInterningConversionPolicy();
+   testLatencyHistogram();
    testMock();
+   testQuantileSketch();
+   testResultSet();
    testResultSetFactory();
+   testRunningAggregates();
+   testThreadPool();
+   testVirtualScheduler();
 
    return 0;
 }
@@ -0,0 +1,83 @@
+/*
+
+   ThreadPoolTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+#include "Test.hh"
+
+#include "unimock/ThreadPool.hh"
+
+
+void testThreadPool()
+{
+   using namespace unimock;
+
+   test( "Run all tasks in a thread pool" );
+   {
+      ThreadPool threadPool( 4 );
+      std::vector<int> results( 1000, 0 );
+
+      threadPool.parallelFor( results.size(), [&]( std::size_t i )
+      {
+         results[ i ] = static_cast<int>( i ) * 2;
+      } );
+
+      ensure( threadPool.size() == 4 );
+      for( std::size_t i = 0; i < results.size(); i++ )
+         ensure( results[ i ] == static_cast<int>( i ) * 2 );
+   }
+
+   test( "Run several jobs in the same thread pool" );
+   {
+      ThreadPool threadPool( 3 );
+      std::atomic<int> sum( 0 );
+
+      for( int job = 0; job < 100; job++ )
+         threadPool.parallelFor( 10, [&]( std::size_t i ) { sum += 1; } );
+
+      ensure( sum == 1000 );
+   }
+
+   test( "Rethrow an exception from a task" );
+   {
+      ThreadPool threadPool( 4 );
+      bool thrown = false;
+
+      try
+      {
+         threadPool.parallelFor( 100, []( std::size_t i )
+         {
+            if( i == 42 )
+               throw std::runtime_error( "task failed" );
+         } );
+      }
+      catch( const std::runtime_error& )
+      {
+         thrown = true;
+      }
+
+      ensure( thrown );
+   }
+
+   test( "Split elements into chunks" );
+   {
+      ThreadPool threadPool( 2 );
+
+      ensure( threadPool.chunkCount( 0 ) == 1 );
+      ensure( threadPool.chunkCount( 10 ) == 1 );
+      ensure( threadPool.chunkCount( 100000000 ) == 8 );
+   }
+
+}
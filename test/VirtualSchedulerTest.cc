@@ -0,0 +1,131 @@
+/*
+
+   VirtualSchedulerTest.cc
+
+   Copyright (c) 2015 Daniel Markus
+
+   This file is part of the Unimock library that is distributed under the
+   University of Illinois/NCSA Open Source License (NCSA). See accompanying
+   file LICENSE.TXT for details.
+
+________________________________________________________________________________
+*/
+
+#include <chrono>
+#include <future>
+#include <stdexcept>    // std::runtime_error
+#include <vector>
+
+#include "Test.hh"
+
+#include "unimock/VirtualScheduler.hh"
+
+
+namespace
+{
+
+bool isReady( const std::future<int>& future )
+{
+   return future.wait_for( std::chrono::seconds( 0 ) ) ==
+      std::future_status::ready;
+}
+
+} // unnamed namespace
+
+
+void testVirtualScheduler()
+{
+   using namespace unimock;
+   using std::chrono::milliseconds;
+
+   test( "Run scheduled tasks in virtual time order" );
+   {
+      VirtualScheduler scheduler;
+      std::vector<int> order;
+
+      scheduler.schedule( milliseconds( 20 ), [&]{ order.push_back( 3 ); } );
+      scheduler.schedule( milliseconds( 10 ), [&]{ order.push_back( 1 ); } );
+      scheduler.schedule( milliseconds( 10 ), [&]
+      {
+         order.push_back( 2 );
+         scheduler.schedule( milliseconds( 0 ), [&]{ order.push_back( 4 ); } );
+      } );
+      ensure( scheduler.size() == 3 );
+
+      ensure( scheduler.advance( milliseconds( 5 ) ) == 0 );
+      ensure( scheduler.now() == milliseconds( 5 ) );
+      ensure( scheduler.advance( milliseconds( 5 ) ) == 3 );
+      ensure( scheduler.now() == milliseconds( 10 ) );
+      ensure( ( order == std::vector<int>{ 1, 2, 4 } ) );
+
+      ensure( scheduler.run() == 1 );
+      ensure( scheduler.now() == milliseconds( 20 ) );
+      ensure( ( order == std::vector<int>{ 1, 2, 4, 3 } ) );
+      ensure( scheduler.size() == 0 );
+   }
+
+   test( "Complete deferred futures after their virtual latency" );
+   {
+      VirtualScheduler scheduler;
+      int calls = 0;
+
+      auto computed = scheduler.deferred(
+         milliseconds( 30 ), [&]{ return ++calls; } );
+      auto forwarded = scheduler.deferred( milliseconds( 10 ),
+         std::async( std::launch::deferred, []{ return 42; } ) );
+      auto failed = scheduler.deferred( milliseconds( 10 ),
+         []() -> int { throw std::runtime_error( "failed" ); } );
+
+      scheduler.advance( milliseconds( 10 ) );
+      ensure( isReady( forwarded ) );
+      ensure( isReady( failed ) );
+      ensure( !isReady( computed ) );
+      ensure( calls == 0 );
+      ensure( forwarded.get() == 42 );
+
+      bool thrown = false;
+      try
+      {
+         failed.get();
+      }
+      catch( const std::runtime_error& )
+      {
+         thrown = true;
+      }
+      ensure( thrown );
+
+      scheduler.advance( milliseconds( 20 ) );
+      ensure( computed.get() == 1 );
+   }
+
+   test( "Complete deferred futures once tasks scheduled later complete them" );
+   {
+      VirtualScheduler scheduler;
+      std::promise<int> source;
+      std::promise<int> failing;
+
+      auto forwarded =
+         scheduler.deferred( milliseconds( 10 ), source.get_future() );
+      auto failed =
+         scheduler.deferred( milliseconds( 10 ), failing.get_future() );
+      scheduler.schedule( milliseconds( 30 ), [&]{ source.set_value( 7 ); } );
+      scheduler.schedule( milliseconds( 20 ), [&]
+      {
+         failing.set_exception(
+            std::make_exception_ptr( std::runtime_error( "failed" ) ) );
+      } );
+
+      scheduler.advance( milliseconds( 10 ) );
+      ensure( !isReady( forwarded ) );
+      ensure( !isReady( failed ) );
+
+      scheduler.advance( milliseconds( 10 ) );
+      ensure( !isReady( forwarded ) );
+      ensure( isReady( failed ) );
+
+      ensure( scheduler.run() > 0 );
+      ensure( scheduler.now() == milliseconds( 30 ) );
+      ensure( forwarded.get() == 7 );
+   }
+
+}